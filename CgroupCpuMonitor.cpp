@@ -0,0 +1,170 @@
+// -----------------------------------------------------------------------------
+// CgroupCpuMonitor.cpp
+//
+// Periodic per-cgroup CPU accounting of the foreground groups that the
+// EFFICIENT_POWER hint confines to the contained CPUs.
+// -----------------------------------------------------------------------------
+
+#include "CgroupCpuMonitor.h"
+#include "ThreadPlacement.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+const char* const kGroups[] = {"top-app", "foreground", "foreground_window", "camera-daemon"};
+// cgroup v2 only: /dev/cpuctl is the v1 cpu controller, which has no usage
+// counter, and v1 cpuacct (/acct) is per uid/pid rather than per group.
+constexpr char kV2Root[] = "/sys/fs/cgroup";
+} // namespace
+
+CgroupCpuMonitor::CgroupCpuMonitor(const std::string& name, const std::string& containedCpus,
+                                   unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks) {
+    cpu_set_t set;
+    if (ThreadPlacement::parseCpuList(containedCpus, &set)) {
+        containedCpuCount_ = CPU_COUNT(&set);
+    }
+    if (containedCpuCount_ <= 0) {
+        CGCPULOGE("CgroupCpuMonitor: Invalid contained CPU list '%s', using all online CPUs", containedCpus.c_str());
+        containedCpuCount_ = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    }
+    CGCPULOGD("CgroupCpuMonitor: Initializing '%s' for %d contained CPU(s) every %u tick(s)",
+              name.c_str(), containedCpuCount_, periodTicks);
+}
+
+CgroupCpuMonitor::~CgroupCpuMonitor() {
+    closeNodes();
+}
+
+bool CgroupCpuMonitor::readStatField(int fd, const char* key, unsigned long long& value_out) {
+    if (fd < 0) return false;
+    char buffer[512];
+    ssize_t bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (bytes_read <= 0) {
+        CGCPULOGE("CgroupCpuMonitor: pread failed: %s", std::strerror(errno));
+        return false;
+    }
+    buffer[bytes_read] = '\0';
+
+    size_t keyLen = strlen(key);
+    for (char* line = buffer; line && *line; ) {
+        if (!strncmp(line, key, keyLen) && line[keyLen] == ' ') {
+            char* endptr = nullptr;
+            value_out = std::strtoull(line + keyLen + 1, &endptr, 10);
+            return endptr != line + keyLen + 1;
+        }
+        line = strchr(line, '\n');
+        if (line) ++line;
+    }
+    return false;
+}
+
+bool CgroupCpuMonitor::openGroup(Group& group) {
+    unsigned long long value = 0;
+    std::string path = std::string(kV2Root) + "/" + group.name + "/cpu.stat";
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    if (!readStatField(fd, "usage_usec", value)) {
+        close(fd);
+        return false;
+    }
+    group.statFd = fd;
+    CGCPULOGD("CgroupCpuMonitor: Using '%s'", path.c_str());
+    return true;
+}
+
+int CgroupCpuMonitor::init() {
+    closeNodes();
+    for (const char* name : kGroups) {
+        Group group;
+        group.name = name;
+        group.usage.group = name;
+        if (openGroup(group)) {
+            groups_.push_back(std::move(group));
+        } else {
+            CGCPULOGI("CgroupCpuMonitor: No CPU accounting for cgroup '%s'", name);
+        }
+    }
+    if (groups_.empty() || groups_.front().name != kGroups[0]) {
+        CGCPULOGE("CgroupCpuMonitor: top-app CPU accounting not available (cgroup v2 cpu controller required)");
+        closeNodes();
+        return -1;
+    }
+    return 0;
+}
+
+void CgroupCpuMonitor::closeNodes() {
+    for (auto& group : groups_) {
+        if (group.statFd >= 0) close(group.statFd);
+    }
+    groups_.clear();
+}
+
+bool CgroupCpuMonitor::readGroup(const Group& group, unsigned long long& usageUs,
+                                 unsigned long long& throttledUs, bool& haveThrottled) const {
+    if (!readStatField(group.statFd, "usage_usec", usageUs)) return false;
+    haveThrottled = readStatField(group.statFd, "throttled_usec", throttledUs);
+    return true;
+}
+
+void CgroupCpuMonitor::sampleOnce() {
+    bool reset = consumeReset();
+    auto now = std::chrono::steady_clock::now();
+    double elapsedUs = std::chrono::duration<double, std::micro>(now - lastSampleTs_).count();
+    lastSampleTs_ = now;
+
+    for (auto& group : groups_) {
+        if (reset) group.haveLast = false;
+
+        unsigned long long usageUs = 0, throttledUs = 0;
+        bool haveThrottled = false;
+        if (!readGroup(group, usageUs, throttledUs, haveThrottled)) continue;
+
+        if (group.haveLast && usageUs >= group.lastUsageUs && elapsedUs > 0.0) {
+            GroupUsage usage;
+            usage.group = group.name;
+            usage.cpuPercent = static_cast<double>(usageUs - group.lastUsageUs) * 100.0 /
+                               (elapsedUs * containedCpuCount_);
+            usage.throttledPercent = haveThrottled && throttledUs >= group.lastThrottledUs
+                                             ? static_cast<double>(throttledUs - group.lastThrottledUs) * 100.0 / elapsedUs
+                                             : -1.0;
+            std::lock_guard<std::mutex> lock(usageMutex_);
+            group.usage = usage;
+        }
+        group.lastUsageUs = usageUs;
+        group.lastThrottledUs = throttledUs;
+        group.haveLast = true;
+    }
+    if (reset) {
+        // Re-arm the edge: the daemon only samples us while contained.
+        saturated_ = 0;
+        return;
+    }
+
+    double topApp;
+    {
+        std::lock_guard<std::mutex> lock(usageMutex_);
+        topApp = groups_.front().usage.cpuPercent;
+    }
+    topAppPercent_ = topApp;
+    CGCPULOGD("CgroupCpuMonitor: top-app=%.1f%% of %d contained CPU(s)", topApp, containedCpuCount_);
+
+    int saturated = topApp >= kTopAppSaturatedPercent ? 1 : 0;
+    if (saturated != saturated_) {
+        CGCPULOGI("CgroupCpuMonitor: top-app saturation %d -> %d (%.1f%% of contained CPUs)",
+                  saturated_, saturated, topApp);
+        saturated_ = saturated;
+        onValueChanged(static_cast<int>(topApp), saturated);
+    }
+}
+
+std::vector<CgroupCpuMonitor::GroupUsage> CgroupCpuMonitor::getUsage() const {
+    std::lock_guard<std::mutex> lock(usageMutex_);
+    std::vector<GroupUsage> usage;
+    for (const auto& group : groups_) usage.push_back(group.usage);
+    return usage;
+}
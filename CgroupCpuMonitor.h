@@ -0,0 +1,94 @@
+#ifndef CGROUPCPUMONITOR_H
+#define CGROUPCPUMONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <android/log.h>
+
+#include "PeriodicMonitor.h"
+
+// Default sampler period is 3 base ticks, coalesced with SysLoadMonitor.
+static constexpr unsigned g_cgroupSamplerPeriodTicksDefault = 3;
+
+// CPU set the EFFICIENT_POWER hint confines the foreground groups to (powerhint_404.json).
+inline constexpr char kDefaultContainedCpus[] = "4-7";
+
+// Logging macros for CgroupCpuMonitor
+#define CGROUP_CPU_LOG_TAG "SocDaemon_CgroupCpuMonitor"
+#define CGCPULOGD(...) __android_log_print(ANDROID_LOG_DEBUG, CGROUP_CPU_LOG_TAG, __VA_ARGS__)
+#define CGCPULOGI(...) __android_log_print(ANDROID_LOG_INFO, CGROUP_CPU_LOG_TAG, __VA_ARGS__)
+#define CGCPULOGE(...) __android_log_print(ANDROID_LOG_ERROR, CGROUP_CPU_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Per-cgroup CPU accounting for the groups the EFFICIENT_POWER hint moves.
+ *
+ * For each of top-app, foreground, foreground_window and camera-daemon the
+ * monitor keeps a persistent descriptor on /sys/fs/cgroup/<group>/cpu.stat
+ * (usage_usec, throttled_usec) and turns the deltas into utilization of the
+ * contained CPUs on the common tick. Only the cgroup v2 cpu controller is
+ * supported: on v1 /dev/cpuctl has no usage counter and cpuacct is accounted
+ * per uid/pid under /acct, so init() fails and the monitor is not used.
+ *
+ * The alert is raised only on edges of "top-app saturates the contained cores"
+ * and carries (top-app utilization %, saturated). That lets the daemon leave
+ * containment because the foreground app needs more CPUs, independently of
+ * whatever background or system work shows up in /proc/stat.
+ */
+class CgroupCpuMonitor : public PeriodicMonitor {
+public:
+    /**
+     * @param name Monitor name used for alerts.
+     * @param containedCpus CPU list the groups are confined to in containment, e.g. "4-7".
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    CgroupCpuMonitor(const std::string& name, const std::string& containedCpus = kDefaultContainedCpus,
+                     unsigned periodTicks = g_cgroupSamplerPeriodTicksDefault);
+
+    ~CgroupCpuMonitor() override;
+
+    // Opens the accounting nodes of every group found. Returns -1 if top-app has none.
+    int init() override;
+
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
+
+    struct GroupUsage {
+        std::string group;
+        double cpuPercent = 0.0;       // of the contained CPUs
+        double throttledPercent = 0.0; // of wall time, -1 when not available
+    };
+
+    // Latest per-group utilization (copy).
+    std::vector<GroupUsage> getUsage() const;
+    double getTopAppPercent() const { return topAppPercent_.load(); }
+
+private:
+    struct Group {
+        std::string name;
+        int statFd = -1;   // cpu.stat
+        unsigned long long lastUsageUs = 0;
+        unsigned long long lastThrottledUs = 0;
+        bool haveLast = false;
+        GroupUsage usage;
+    };
+
+    bool openGroup(Group& group);
+    bool readGroup(const Group& group, unsigned long long& usageUs, unsigned long long& throttledUs,
+                   bool& haveThrottled) const;
+    static bool readStatField(int fd, const char* key, unsigned long long& value_out);
+    void closeNodes();
+
+    int containedCpuCount_ = 0;
+    std::vector<Group> groups_;
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    int saturated_ = 0;
+
+    mutable std::mutex usageMutex_; // guards Group::usage for readers off the clock thread
+    std::atomic<double> topAppPercent_{0.0};
+
+    static constexpr double kTopAppSaturatedPercent = 75.0; // of the contained CPUs
+};
+#endif // CGROUPCPUMONITOR_H
@@ -0,0 +1,266 @@
+// -----------------------------------------------------------------------------
+// ControlServer.cpp
+//
+// Unix domain control/metrics socket. See ControlServer.h for the protocol.
+// -----------------------------------------------------------------------------
+
+#include "ControlServer.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+ControlServer::ControlServer(const std::string& socketPath, RequestHandler handler)
+    : socketPath_(socketPath), handler_(std::move(handler)) {}
+
+ControlServer::~ControlServer() {
+    stop();
+    for (auto& client : clients_) {
+        closeClient(client);
+    }
+    if (listenFd_ >= 0) close(listenFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+}
+
+int ControlServer::init() {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(addr.sun_path)) {
+        CTLLOGE("ControlServer: Socket path too long: %s", socketPath_.c_str());
+        return -1;
+    }
+    strncpy(addr.sun_path, socketPath_.c_str(), sizeof(addr.sun_path) - 1);
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listenFd_ < 0) {
+        CTLLOGE("ControlServer: socket() failed: %s", std::strerror(errno));
+        return -1;
+    }
+    unlink(socketPath_.c_str());
+    if (bind(listenFd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        chmod(socketPath_.c_str(), 0660) != 0 || listen(listenFd_, 4) != 0) {
+        CTLLOGE("ControlServer: Failed to listen on %s: %s", socketPath_.c_str(), std::strerror(errno));
+        close(listenFd_);
+        listenFd_ = -1;
+        return -1;
+    }
+
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd_ < 0) {
+        CTLLOGE("ControlServer: eventfd() failed: %s", std::strerror(errno));
+        close(listenFd_);
+        listenFd_ = -1;
+        return -1;
+    }
+
+    running_ = true;
+    CTLLOGI("ControlServer: Listening on %s", socketPath_.c_str());
+    return 0;
+}
+
+void ControlServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    signalWake();
+}
+
+void ControlServer::signalWake() {
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        (void)!write(wakeFd_, &one, sizeof(one));
+    }
+}
+
+void ControlServer::publish(const std::string& topic, const std::string& text) {
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& client : clients_) {
+            if (client.fd < 0) continue;
+            if (std::find(client.topics.begin(), client.topics.end(), topic) == client.topics.end()) continue;
+            if (client.out.size() + text.size() > kMaxPendingOutput) {
+                CTLLOGE("ControlServer: Dropping slow subscriber fd=%d", client.fd);
+                shutdown(client.fd, SHUT_RDWR); // reaped by run()
+                continue;
+            }
+            client.out += text;
+            queued = true;
+        }
+    }
+    if (queued) signalWake();
+}
+
+bool ControlServer::hasSubscribers(const std::string& topic) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& client : clients_) {
+        if (client.fd >= 0 &&
+            std::find(client.topics.begin(), client.topics.end(), topic) != client.topics.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ControlServer::acceptClient() {
+    int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            CTLLOGE("ControlServer: accept4() failed: %s", std::strerror(errno));
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (clients_.size() >= kMaxClients) {
+        CTLLOGE("ControlServer: Too many clients, rejecting fd=%d", fd);
+        close(fd);
+        return;
+    }
+    Client client;
+    client.fd = fd;
+    clients_.push_back(std::move(client));
+}
+
+void ControlServer::closeClient(Client& client) {
+    if (client.fd >= 0) {
+        close(client.fd);
+        client.fd = -1;
+    }
+}
+
+bool ControlServer::readClient(Client& client) {
+    char buf[512];
+    while (true) {
+        ssize_t n = recv(client.fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n == 0) return false;
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.in.append(buf, n);
+        size_t pos;
+        while ((pos = client.in.find('\n')) != std::string::npos) {
+            std::string line = client.in.substr(0, pos);
+            client.in.erase(0, pos + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            handleLine(client, line);
+        }
+        if (client.in.size() > kMaxLineLength) {
+            CTLLOGE("ControlServer: Request line too long, closing fd=%d", client.fd);
+            return false;
+        }
+    }
+}
+
+void ControlServer::handleLine(Client& client, const std::string& line) {
+    size_t space = line.find(' ');
+    std::string command = line.substr(0, space);
+    std::string args = (space == std::string::npos) ? std::string() : line.substr(space + 1);
+    std::transform(command.begin(), command.end(), command.begin(), ::toupper);
+    if (command.empty()) return;
+
+    std::string response;
+    if (command == "SUBSCRIBE" || command == "UNSUBSCRIBE") {
+        if (args != "events" && args != "metrics") {
+            response = "ERR unknown topic (use events or metrics)\n";
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find(client.topics.begin(), client.topics.end(), args);
+            if (command == "SUBSCRIBE" && it == client.topics.end()) client.topics.push_back(args);
+            if (command == "UNSUBSCRIBE" && it != client.topics.end()) client.topics.erase(it);
+            response = "OK " + command + " " + args + "\n";
+        }
+        if (command == "SUBSCRIBE" && handler_ && response.compare(0, 3, "ERR") != 0) {
+            response += handler_(command, args);
+        }
+    } else {
+        // Handler runs without our lock: it may publish().
+        response = handler_ ? handler_(command, args) : std::string("ERR no handler\n");
+    }
+    if (!response.empty() && response.back() != '\n') response += '\n';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    client.out += response;
+    client.out += ".\n";
+}
+
+bool ControlServer::flushClient(Client& client) {
+    while (!client.out.empty()) {
+        ssize_t n = send(client.fd, client.out.data(), client.out.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.out.erase(0, n);
+    }
+    return true;
+}
+
+void ControlServer::run() {
+    if (listenFd_ < 0) return;
+
+    std::vector<struct pollfd> pfds;
+    while (true) {
+        pfds.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) break;
+            pfds.push_back({listenFd_, POLLIN, 0});
+            pfds.push_back({wakeFd_, POLLIN, 0});
+            for (const auto& client : clients_) {
+                short events = POLLIN;
+                if (!client.out.empty()) events |= POLLOUT;
+                pfds.push_back({client.fd, events, 0});
+            }
+        }
+
+        if (poll(pfds.data(), pfds.size(), -1) < 0) {
+            if (errno != EINTR) {
+                CTLLOGE("ControlServer: poll() failed: %s", std::strerror(errno));
+            }
+            continue;
+        }
+
+        if (pfds[1].revents & POLLIN) {
+            uint64_t value;
+            (void)!read(wakeFd_, &value, sizeof(value));
+        }
+
+        // Only this thread adds or removes clients, so indices stay stable
+        // until the reap below; publish() only appends to Client::out.
+        for (size_t i = 2; i < pfds.size(); ++i) {
+            Client& client = clients_[i - 2];
+            bool alive = true;
+            if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                alive = readClient(client);
+            }
+            if (alive) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                alive = flushClient(client);
+            }
+            if (!alive) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closeClient(client);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                          [](const Client& c) { return c.fd < 0; }),
+                           clients_.end());
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            acceptClient();
+        }
+    }
+    CTLLOGI("ControlServer: Thread exiting");
+}
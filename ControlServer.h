@@ -0,0 +1,87 @@
+#pragma once
+
+// ControlServer.h
+// -----------------------------------------------------------------------------
+// Local control/metrics socket (Unix domain, SOCK_STREAM).
+//
+// Protocol: one request per line, "<COMMAND> [args]\n". Every response is a
+// block of lines terminated by a line containing a single ".":
+//
+//   > STATE
+//   < cc_state=CoreContainment
+//   < wlt=1
+//   < .
+//
+// Failures answer "ERR <reason>" followed by ".". Command dispatch is done by
+// the owner through the RequestHandler; the server itself only implements
+// SUBSCRIBE <topic> / UNSUBSCRIBE <topic> (the handler is still called after a
+// successful SUBSCRIBE so it can append an initial snapshot). Subscribed
+// clients receive pushed data through publish(): "events" carries
+// "EVENT key=value ..." lines, "metrics" carries full OpenMetrics dumps
+// terminated by "# EOF".
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define CTL_LOG_TAG "SocDaemon_Control"
+#define CTLLOGI(...) __android_log_print(ANDROID_LOG_INFO, CTL_LOG_TAG, __VA_ARGS__)
+#define CTLLOGE(...) __android_log_print(ANDROID_LOG_ERROR, CTL_LOG_TAG, __VA_ARGS__)
+
+inline constexpr char kDefaultControlSocket[] = "/data/vendor/socdaemon/ctl";
+
+class ControlServer {
+public:
+    // Returns the response body (without the terminating "."), or "ERR ..." text.
+    using RequestHandler = std::function<std::string(const std::string& command, const std::string& args)>;
+
+    ControlServer(const std::string& socketPath, RequestHandler handler);
+    ~ControlServer();
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    // Creates, binds and listens on the socket. Returns -1 on failure.
+    int init();
+
+    // Serves clients until stop(). Intended to be run in a dedicated thread.
+    void run();
+    void stop();
+
+    // Queue text for every client subscribed to `topic`. Safe from any thread.
+    void publish(const std::string& topic, const std::string& text);
+
+    // True when at least one client subscribes to `topic` (skip building payloads otherwise).
+    bool hasSubscribers(const std::string& topic) const;
+
+private:
+    struct Client {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        std::vector<std::string> topics;
+    };
+
+    void acceptClient();
+    bool readClient(Client& client);
+    void handleLine(Client& client, const std::string& line);
+    bool flushClient(Client& client);
+    void closeClient(Client& client);
+    void signalWake();
+
+    static constexpr size_t kMaxClients = 8;
+    static constexpr size_t kMaxLineLength = 256;
+    static constexpr size_t kMaxPendingOutput = 256 * 1024; // slow subscribers are dropped
+
+    std::string socketPath_;
+    RequestHandler handler_;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    bool running_ = false;
+
+    mutable std::mutex mutex_; // guards clients_ and running_
+    std::vector<Client> clients_;
+};
@@ -0,0 +1,224 @@
+// -----------------------------------------------------------------------------
+// CpuIdleMonitor.cpp
+//
+// Per-cluster deep C-state residency, used to check that containment lets the
+// parked cores sleep.
+// -----------------------------------------------------------------------------
+
+#include "CpuIdleMonitor.h"
+#include "ThreadPlacement.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr char kCpuRoot[] = "/sys/devices/system/cpu";
+constexpr int kMaxCpus = 256;
+constexpr int kMaxIdleStates = 16;
+} // namespace
+
+CpuIdleMonitor::CpuIdleMonitor(const std::string& name, const std::string& containedCpus,
+                               unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks), containedCpus_(containedCpus) {
+    CPUIDLELOGD("CpuIdleMonitor: Initializing '%s' (contained %s) every %u tick(s)",
+                name.c_str(), containedCpus_.c_str(), periodTicks);
+}
+
+CpuIdleMonitor::~CpuIdleMonitor() {
+    closeNodes();
+}
+
+bool CpuIdleMonitor::readNode(int fd, unsigned long long& value_out) {
+    if (fd < 0) return false;
+    char buffer[32];
+    ssize_t bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (bytes_read <= 0) {
+        return false;
+    }
+    buffer[bytes_read] = '\0';
+    char* endptr = nullptr;
+    value_out = std::strtoull(buffer, &endptr, 10);
+    return endptr != buffer;
+}
+
+bool CpuIdleMonitor::openCpu(CpuNodes& nodes) {
+    std::string base = std::string(kCpuRoot) + "/cpu" + std::to_string(nodes.cpu) + "/cpuidle";
+    int deepest = -1;
+    int deepestTimeFd = -1;
+    for (int state = 0; state < kMaxIdleStates; ++state) {
+        std::string dir = base + "/state" + std::to_string(state);
+        int timeFd = open((dir + "/time").c_str(), O_RDONLY | O_CLOEXEC);
+        if (timeFd < 0) break;
+        int usageFd = open((dir + "/usage").c_str(), O_RDONLY | O_CLOEXEC);
+        if (usageFd >= 0) nodes.usageFds.push_back(usageFd);
+
+        unsigned long long targetUs = 0;
+        int targetFd = open((dir + "/target_residency").c_str(), O_RDONLY | O_CLOEXEC);
+        readNode(targetFd, targetUs);
+        if (targetFd >= 0) close(targetFd);
+
+        if (targetUs >= kDeepTargetResidencyUs) {
+            nodes.deepTimeFds.push_back(timeFd);
+        } else {
+            if (deepestTimeFd >= 0) close(deepestTimeFd);
+            deepestTimeFd = timeFd;
+        }
+        deepest = state;
+    }
+    if (nodes.deepTimeFds.empty() && deepestTimeFd >= 0 && deepest > 0) {
+        // No state meets the deep threshold: the deepest one is the best we have.
+        nodes.deepTimeFds.push_back(deepestTimeFd);
+    } else if (deepestTimeFd >= 0) {
+        close(deepestTimeFd);
+    }
+    return !nodes.deepTimeFds.empty();
+}
+
+int CpuIdleMonitor::init() {
+    closeNodes();
+    cpu_set_t contained;
+    if (!ThreadPlacement::parseCpuList(containedCpus_, &contained)) {
+        CPUIDLELOGE("CpuIdleMonitor: Invalid contained CPU list '%s'", containedCpus_.c_str());
+        return -1;
+    }
+
+    int counts[kClusterCount] = {0, 0};
+    for (int cpu = 0; cpu < kMaxCpus; ++cpu) {
+        std::string online = std::string(kCpuRoot) + "/cpu" + std::to_string(cpu);
+        if (access(online.c_str(), F_OK) != 0) break;
+
+        CpuNodes nodes;
+        nodes.cpu = cpu;
+        nodes.cluster = CPU_ISSET(cpu, &contained) ? kContained : kParked;
+        if (!openCpu(nodes)) {
+            CPUIDLELOGI("CpuIdleMonitor: cpu%d has no usable cpuidle states", cpu);
+            for (int fd : nodes.usageFds) close(fd);
+            continue;
+        }
+        ++counts[nodes.cluster];
+        cpus_.push_back(std::move(nodes));
+    }
+
+    if (counts[kParked] == 0) {
+        CPUIDLELOGE("CpuIdleMonitor: No parked CPU exposes cpuidle residency");
+        closeNodes();
+        return -1;
+    }
+    for (int c = 0; c < kClusterCount; ++c) clusters_[c].cpus = counts[c];
+    CPUIDLELOGI("CpuIdleMonitor: Tracking %d parked and %d contained CPU(s)", counts[kParked], counts[kContained]);
+    return 0;
+}
+
+void CpuIdleMonitor::closeNodes() {
+    for (auto& nodes : cpus_) {
+        for (int fd : nodes.deepTimeFds) close(fd);
+        for (int fd : nodes.usageFds) close(fd);
+    }
+    cpus_.clear();
+}
+
+bool CpuIdleMonitor::readCpu(const CpuNodes& nodes, unsigned long long& deepUs,
+                             unsigned long long& usage) const {
+    deepUs = 0;
+    usage = 0;
+    for (int fd : nodes.deepTimeFds) {
+        unsigned long long v = 0;
+        if (!readNode(fd, v)) return false;
+        deepUs += v;
+    }
+    for (int fd : nodes.usageFds) {
+        unsigned long long v = 0;
+        if (readNode(fd, v)) usage += v;
+    }
+    return true;
+}
+
+bool CpuIdleMonitor::isSampling() const {
+    if (!PeriodicMonitor::isSampling()) return false;
+    return contained_.load() || std::chrono::steady_clock::now().time_since_epoch().count() < windowUntil_.load();
+}
+
+void CpuIdleMonitor::setContained(bool contained) {
+    if (contained_.exchange(contained) != contained) {
+        if (!contained) sampleFor(kAfterWindow);
+        requestReset();
+    }
+}
+
+void CpuIdleMonitor::sampleFor(std::chrono::milliseconds window) {
+    // A window opened after a gap must not measure an interval spanning it.
+    if (!isSampling()) requestReset();
+    auto until = (std::chrono::steady_clock::now() + window).time_since_epoch().count();
+    auto current = windowUntil_.load();
+    while (current < until && !windowUntil_.compare_exchange_weak(current, until)) {
+    }
+}
+
+void CpuIdleMonitor::sampleOnce() {
+    if (consumeReset()) {
+        // The interval straddles a cpuset rewrite; start a fresh one.
+        haveLast_ = false;
+        lowSamples_ = 0;
+        notSleeping_ = 0;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsedUs = std::chrono::duration<double, std::micro>(now - lastSampleTs_).count();
+    double deepUs[kClusterCount] = {0.0, 0.0};
+    double entries[kClusterCount] = {0.0, 0.0};
+    bool valid = haveLast_ && elapsedUs > 0.0;
+
+    for (auto& nodes : cpus_) {
+        unsigned long long deep = 0, usage = 0;
+        if (!readCpu(nodes, deep, usage)) {
+            valid = false;
+            continue;
+        }
+        if (deep < nodes.lastDeepUs || usage < nodes.lastUsage) valid = false; // hotplug/reset
+        deepUs[nodes.cluster] += static_cast<double>(deep - nodes.lastDeepUs);
+        entries[nodes.cluster] += static_cast<double>(usage - nodes.lastUsage);
+        nodes.lastDeepUs = deep;
+        nodes.lastUsage = usage;
+    }
+    lastSampleTs_ = now;
+    haveLast_ = true;
+    if (!valid) return;
+
+    bool contained = contained_.load();
+    double parkedDeep;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        for (int c = 0; c < kClusterCount; ++c) {
+            ClusterIdle& cluster = clusters_[c];
+            if (cluster.cpus == 0) continue;
+            double deepPercent = deepUs[c] * 100.0 / (elapsedUs * cluster.cpus);
+            cluster.deepPercent = deepPercent > 100.0 ? 100.0 : deepPercent;
+            cluster.wakeupsPerSec = entries[c] * 1e6 / (elapsedUs * cluster.cpus);
+            double& avg = contained ? cluster.deepContainedAvg : cluster.deepOpenAvg;
+            avg = avg < 0.0 ? cluster.deepPercent : avg + kAvgAlpha * (cluster.deepPercent - avg);
+        }
+        parkedDeep = clusters_[kParked].deepPercent;
+        CPUIDLELOGD("CpuIdleMonitor: parked deep=%.1f%% wakeups=%.0f/s contained deep=%.1f%% (cc=%d)",
+                    parkedDeep, clusters_[kParked].wakeupsPerSec, clusters_[kContained].deepPercent, contained);
+    }
+
+    if (!contained) return;
+
+    lowSamples_ = parkedDeep < kMinParkedDeepPercent ? lowSamples_ + 1 : 0;
+    int previous = notSleeping_.load();
+    int notSleeping = lowSamples_ >= kNotSleepingSamples ? 1 : (lowSamples_ == 0 ? 0 : previous);
+    if (notSleeping != previous) {
+        CPUIDLELOGI("CpuIdleMonitor: Parked cores not sleeping %d -> %d (deep residency %.1f%%)",
+                    previous, notSleeping, parkedDeep);
+        notSleeping_ = notSleeping;
+        onValueChanged(static_cast<int>(parkedDeep), notSleeping);
+    }
+}
+
+CpuIdleMonitor::ClusterIdle CpuIdleMonitor::getCluster(Cluster cluster) const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return clusters_[cluster];
+}
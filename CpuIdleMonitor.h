@@ -0,0 +1,116 @@
+#ifndef CPUIDLEMONITOR_H
+#define CPUIDLEMONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <android/log.h>
+
+#include "PeriodicMonitor.h"
+
+// Default sampler period is 3 base ticks, coalesced with SysLoadMonitor.
+static constexpr unsigned g_cpuIdleSamplerPeriodTicksDefault = 3;
+
+// Logging macros for CpuIdleMonitor
+#define CPU_IDLE_LOG_TAG "SocDaemon_CpuIdleMonitor"
+#define CPUIDLELOGD(...) __android_log_print(ANDROID_LOG_DEBUG, CPU_IDLE_LOG_TAG, __VA_ARGS__)
+#define CPUIDLELOGI(...) __android_log_print(ANDROID_LOG_INFO, CPU_IDLE_LOG_TAG, __VA_ARGS__)
+#define CPUIDLELOGE(...) __android_log_print(ANDROID_LOG_ERROR, CPU_IDLE_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Verifies that the cores parked by EFFICIENT_POWER actually reach deep C-states.
+ *
+ * Every period the monitor reads, per CPU, /sys/devices/system/cpu/cpuN/cpuidle/
+ * state*\/time of the deep states (target_residency >= kDeepTargetResidencyUs,
+ * or the deepest state if none qualifies) and state*\/usage of all states, and
+ * aggregates them per cluster:
+ *  - parked:    online CPUs outside the contained set (0-3 with the default 4-7)
+ *  - contained: the contained set
+ * into deep-idle residency (% of wall time) and idle entries per CPU per second.
+ * A moving average is kept separately for Open and CoreContainment so the gain
+ * of containment can be read back.
+ *
+ * The monitor only samples while contained and inside a window around each
+ * transition (sampleFor() before an expected entry, kAfterWindow after an
+ * exit), so the Open average describes the time just around containment and
+ * the clock is left idle otherwise.
+ *
+ * While contained, the alert is raised on edges of "parked cores are not
+ * sleeping" (deep residency of the parked cluster below kMinParkedDeepPercent
+ * for kNotSleepingSamples samples in a row) and carries (deep %, notSleeping).
+ */
+class CpuIdleMonitor : public PeriodicMonitor {
+public:
+    enum Cluster : int { kParked = 0, kContained = 1, kClusterCount };
+
+    struct ClusterIdle {
+        int cpus = 0;
+        double deepPercent = 0.0;     // last interval
+        double wakeupsPerSec = 0.0;   // idle entries per CPU per second, last interval
+        double deepOpenAvg = -1.0;    // moving average while Open, -1 until known
+        double deepContainedAvg = -1.0; // moving average while contained, -1 until known
+    };
+
+    /**
+     * @param name Monitor name used for alerts.
+     * @param containedCpus CPU list that stays active in containment, e.g. "4-7".
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    CpuIdleMonitor(const std::string& name, const std::string& containedCpus,
+                   unsigned periodTicks = g_cpuIdleSamplerPeriodTicksDefault);
+
+    ~CpuIdleMonitor() override;
+
+    // Opens cpuidle nodes for every CPU. Returns -1 if no parked CPU exposes cpuidle.
+    int init() override;
+
+    // SamplingClock interface; only sampled while contained or inside a window.
+    bool isSampling() const override;
+    void sampleOnce() override;
+
+    // Containment state changes restart the interval and the averages they feed.
+    void setContained(bool contained);
+    // Keep sampling while Open for `window`, e.g. ahead of an expected entry.
+    void sampleFor(std::chrono::milliseconds window);
+    // Parked cores failed to reach deep idle in the current containment.
+    bool parkedNotSleeping() const { return contained_.load() && notSleeping_.load(); }
+
+    ClusterIdle getCluster(Cluster cluster) const;
+
+private:
+    struct CpuNodes {
+        int cpu = -1;
+        Cluster cluster = kParked;
+        std::vector<int> deepTimeFds; // state*/time (us) of deep states
+        std::vector<int> usageFds;    // state*/usage of all states
+        unsigned long long lastDeepUs = 0;
+        unsigned long long lastUsage = 0;
+    };
+
+    bool openCpu(CpuNodes& nodes);
+    static bool readNode(int fd, unsigned long long& value_out);
+    bool readCpu(const CpuNodes& nodes, unsigned long long& deepUs, unsigned long long& usage) const;
+    void closeNodes();
+
+    std::string containedCpus_;
+    std::vector<CpuNodes> cpus_;
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    bool haveLast_ = false;
+    int lowSamples_ = 0;
+    std::atomic<int> notSleeping_{0};
+
+    std::atomic<bool> contained_{false};
+    std::atomic<std::chrono::steady_clock::rep> windowUntil_{0}; // steady_clock ticks
+
+    mutable std::mutex statsMutex_;
+    ClusterIdle clusters_[kClusterCount];
+
+    static constexpr unsigned long long kDeepTargetResidencyUs = 300; // C6 and deeper on Intel
+    static constexpr double kMinParkedDeepPercent = 50.0;
+    static constexpr int kNotSleepingSamples = 3;
+    static constexpr double kAvgAlpha = 0.2;
+    static constexpr std::chrono::seconds kAfterWindow{15}; // Open samples after an exit
+};
+#endif // CPUIDLEMONITOR_H
@@ -0,0 +1,157 @@
+// -----------------------------------------------------------------------------
+// FusionEngine.cpp
+//
+// Weighted multi-signal containment score with hysteresis. See FusionEngine.h.
+// -----------------------------------------------------------------------------
+
+#include "FusionEngine.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+constexpr const char* kSignalNames[] = {"wlt", "swlt", "hfi", "load", "slope", "gpu"};
+static_assert(sizeof(kSignalNames) / sizeof(kSignalNames[0]) == static_cast<size_t>(FusionSignal::Count));
+
+double clamp01(double v) {
+    return std::min(1.0, std::max(0.0, v));
+}
+} // namespace
+
+bool FusionConfig::parseWeights(const std::string& text, FusionConfig& config) {
+    FusionConfig parsed = config;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(start, end - start);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = item.substr(0, eq);
+        char* parseEnd = nullptr;
+        double weight = strtod(item.c_str() + eq + 1, &parseEnd);
+        if (parseEnd == item.c_str() + eq + 1 || *parseEnd != '\0' || weight < 0.0) return false;
+
+        auto it = std::find_if(std::begin(kSignalNames), std::end(kSignalNames),
+                               [&key](const char* name) { return key == name; });
+        if (it == std::end(kSignalNames)) return false;
+        parsed.weights[it - std::begin(kSignalNames)] = weight;
+        start = end + 1;
+    }
+    config = parsed;
+    return true;
+}
+
+bool FusionConfig::parseBands(const std::string& text, FusionConfig& config) {
+    double enter = 0.0, exit = 0.0, minConfidence = config.minConfidence;
+    char extra;
+    int n = sscanf(text.c_str(), "%lf,%lf,%lf%c", &enter, &exit, &minConfidence, &extra);
+    if (n != 2 && n != 3) return false;
+    if (!(exit >= 0.0 && exit < enter && enter <= 1.0 && minConfidence >= 0.0 && minConfidence <= 1.0)) return false;
+    config.enterBand = enter;
+    config.exitBand = exit;
+    config.minConfidence = minConfidence;
+    return true;
+}
+
+FusionEngine::FusionEngine(const std::string& name, const FusionConfig& config)
+    : name_(name), config_(config) {}
+
+const char* FusionEngine::signalName(FusionSignal signal) {
+    return kSignalNames[static_cast<size_t>(signal)];
+}
+
+int64_t FusionEngine::nowMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void FusionEngine::update(FusionSignal signal, double value, double confidence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Input& input = inputs_[static_cast<size_t>(signal)];
+    input.value = clamp01(value);
+    input.confidence = clamp01(confidence);
+    input.updatedMs = nowMs();
+}
+
+double FusionEngine::effectiveConfidence(size_t i, int64_t now) const {
+    const Input& input = inputs_[i];
+    int64_t stale = config_.staleMs[i];
+    if (stale <= 0) return input.confidence;
+    int64_t age = now - input.updatedMs;
+    if (age <= stale) return input.confidence;
+    // Linear fade to zero over a second staleness horizon.
+    return input.confidence * clamp01(1.0 - static_cast<double>(age - stale) / stale);
+}
+
+void FusionEngine::evaluate(double& score, double& confidence) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+    double weighted = 0.0, evidence = 0.0, totalWeight = 0.0;
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        double w = config_.weights[i];
+        double c = effectiveConfidence(i, now);
+        weighted += w * c * inputs_[i].value;
+        evidence += w * c;
+        totalWeight += w;
+    }
+    score = evidence > 0.0 ? weighted / evidence : 0.0;
+    confidence = totalWeight > 0.0 ? evidence / totalWeight : 0.0;
+}
+
+double FusionEngine::score() const {
+    double score, confidence;
+    evaluate(score, confidence);
+    return score;
+}
+
+double FusionEngine::confidence() const {
+    double score, confidence;
+    evaluate(score, confidence);
+    return confidence;
+}
+
+FusionEngine::Decision FusionEngine::decide(bool contained) const {
+    double score, confidence;
+    evaluate(score, confidence);
+    if (!contained) {
+        return (score >= config_.enterBand && confidence >= config_.minConfidence) ? Decision::Enter
+                                                                                   : Decision::Hold;
+    }
+    return score <= config_.exitBand ? Decision::Exit : Decision::Hold;
+}
+
+void FusionEngine::appendInputs(std::string& out) const {
+    double score, confidence;
+    evaluate(score, confidence);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "score=%.3f confidence=%.3f", score, confidence);
+    out += buf;
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        snprintf(buf, sizeof(buf), " %s=%.2f", kSignalNames[i], inputs_[i].value);
+        out += buf;
+    }
+}
+
+void FusionEngine::appendText(std::string& out) const {
+    double score, confidence;
+    evaluate(score, confidence);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+    char buf[192];
+    snprintf(buf, sizeof(buf), "%s score=%.3f confidence=%.3f enter=%.2f exit=%.2f min_confidence=%.2f\n",
+             name_.c_str(), score, confidence, config_.enterBand, config_.exitBand, config_.minConfidence);
+    out += buf;
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        snprintf(buf, sizeof(buf), "%s.%s value=%.3f weight=%.2f confidence=%.3f age_ms=%lld\n", name_.c_str(),
+                 kSignalNames[i], inputs_[i].value, config_.weights[i], effectiveConfidence(i, now),
+                 inputs_[i].confidence > 0.0 ? static_cast<long long>(now - inputs_[i].updatedMs) : -1LL);
+        out += buf;
+    }
+}
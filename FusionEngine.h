@@ -0,0 +1,95 @@
+#pragma once
+
+// FusionEngine.h
+// -----------------------------------------------------------------------------
+// Combines the individual containment signals into one score in [0, 1]
+// (1 = contain). Each signal is normalized by the caller so that 1 favours
+// containment, carries a confidence in [0, 1] and decays towards zero
+// confidence once it is older than its staleness horizon (0 = never stale, for
+// event-driven signals that hold until they change).
+//
+//   score      = sum(w_i * c_i * v_i) / sum(w_i * c_i)
+//   confidence = sum(w_i * c_i) / sum(w_i)
+//
+// decide() applies hysteresis: contain when score >= enterBand with enough
+// confidence, release when score <= exitBand, otherwise keep the current state.
+// The engine keeps no containment state itself so several instances (e.g. a
+// shadow policy) can be evaluated against the same inputs.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#define FUSION_LOG_TAG "SocDaemon_Fusion"
+#define FUSIONLOGI(...) __android_log_print(ANDROID_LOG_INFO, FUSION_LOG_TAG, __VA_ARGS__)
+
+enum class FusionSignal : int {
+    Wlt = 0,      // WLT class: Idle 1.0, Btl 0.8, Sustain 0.2, Bursty 0.0
+    SwltPower,    // SWLT power bit (bit 4 of workload_type_index)
+    Hfi,          // HFI efficiency capability / 255
+    SysLoad,      // 1 - filtered system load / (2 * entry threshold)
+    SysLoadSlope, // 1 - load slope / (2 * slope threshold), 1 when falling
+    GpuBusy,      // 1 - GPU busy / 100
+    Count
+};
+
+struct FusionConfig {
+    std::array<double, static_cast<size_t>(FusionSignal::Count)> weights{3.0, 1.0, 2.0, 2.0, 1.0, 1.0};
+    std::array<int64_t, static_cast<size_t>(FusionSignal::Count)> staleMs{0, 0, 0, 10000, 10000, 10000};
+    double enterBand = 0.70;
+    double exitBand = 0.40;
+    double minConfidence = 0.50;
+
+    // "wlt=3,swlt=1,hfi=2,load=2,slope=1,gpu=1" (any subset). Returns false on a malformed list.
+    static bool parseWeights(const std::string& text, FusionConfig& config);
+    // "<enter>,<exit>[,<min_confidence>]". Returns false unless 0 <= exit < enter <= 1.
+    static bool parseBands(const std::string& text, FusionConfig& config);
+};
+
+class FusionEngine {
+public:
+    enum class Decision { Hold, Enter, Exit };
+
+    FusionEngine(const std::string& name, const FusionConfig& config);
+
+    // value and confidence are clamped to [0, 1].
+    void update(FusionSignal signal, double value, double confidence = 1.0);
+
+    // Current score/confidence from the latest inputs.
+    double score() const;
+    double confidence() const;
+
+    // Hysteresis decision relative to the caller's current containment state.
+    Decision decide(bool contained) const;
+
+    const std::string& name() const { return name_; }
+    const FusionConfig& config() const { return config_; }
+
+    void appendText(std::string& out) const;
+    // One line "score=.. confidence=.. wlt=.. swlt=.. ..." (values only), for logs.
+    void appendInputs(std::string& out) const;
+
+    // Signal names as used by parseWeights() and appendText().
+    static const char* signalName(FusionSignal signal);
+
+private:
+    struct Input {
+        double value = 0.0;
+        double confidence = 0.0; // 0 until the first update
+        int64_t updatedMs = 0;
+    };
+
+    static int64_t nowMs();
+    // Confidence after staleness decay. Caller holds mutex_.
+    double effectiveConfidence(size_t i, int64_t now) const;
+    void evaluate(double& score, double& confidence) const;
+
+    std::string name_;
+    FusionConfig config_;
+    std::array<Input, static_cast<size_t>(FusionSignal::Count)> inputs_{};
+    mutable std::mutex mutex_;
+};
@@ -1,85 +1,180 @@
-// Add missing destructor implementation to resolve vtable error
-GpuLoadMonitor::~GpuLoadMonitor() {
-    stop();
-}
+// -----------------------------------------------------------------------------
 // GpuLoadMonitor.cpp
+//
+// Periodic GPU activity sampler. Combines gtidle residency with the GT
+// frequency and throttle-reason attributes to produce a frequency-weighted
+// GPU load and to tell power-limited from thermally-limited operation.
+// -----------------------------------------------------------------------------
+
 #include "GpuLoadMonitor.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 
-static std::mutex g_gpuEmaMutex;
-static double g_gpuBusyValue = -1.0; // negative => not yet initialized
-static double g_gpuBusyValuePrev = -1.0; // previous EMA value
-//static std::chrono::steady_clock::time_point g_gpuEmaLastTs = std::chrono::steady_clock::now();
-// Time constant (tau) in seconds: larger => slower smoothing. Tune as needed.
-//static constexpr double kGpuEmaTimeConstantSec = 1.5;
-
-void GpuLoadMonitor::monitorLoop() {
-    SYSMON_ALOGI("GpuLoadMonitor: Thread started");
-
-    samplerRunning_.store(true);
-    while (samplerRunning_.load()) {
-        // If paused, wait until restarted or stopped
-        {
-            std::unique_lock<std::mutex> lk(pauseMutex_);
-            pauseCv_.wait(lk, [this] {
-                return !samplerPaused_.load() || !samplerRunning_.load();
-            });
-            if (!samplerRunning_.load())
-                break;
-        }
+GpuLoadMonitor::GpuLoadMonitor(const std::string& name, const std::string& gtPath,
+                               unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks), gtPath_(gtPath) {
+    GPULOADLOGD("GpuLoadMonitor: Initializing '%s' for '%s' every %u tick(s)",
+                name.c_str(), gtPath_.c_str(), periodTicks);
+}
 
-        // Perform GPU idle residency read and update samples
-        SYSMON_ALOGI("GpuLoadMonitor: Periodic GPU load check");
+GpuLoadMonitor::~GpuLoadMonitor() {
+    closeNodes();
+}
 
-        if (getGpuLoad() > kGpuLoadHighThreshold) {
-            SYSMON_ALOGI("GpuLoadMonitor: High GPU load detected more than %.1f", kGpuLoadHighThreshold);
-            onValueChanged(g_gpuBusyValuePrev, g_gpuBusyValue);
+int GpuLoadMonitor::openFirst(const char* const* candidates, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        std::string path = gtPath_ + "/" + candidates[i];
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            GPULOADLOGD("GpuLoadMonitor: Using '%s'", path.c_str());
+            return fd;
         }
+    }
+    return -1;
+}
 
-        // Sleep for up to 1s but wake early if paused/stopped
-        {
-            std::unique_lock<std::mutex> lk(pauseMutex_);
-            pauseCv_.wait_for(lk, samplerInterval_, [this]() {
-                return samplerPaused_.load() || !samplerRunning_.load();
-            });
-        }
+int GpuLoadMonitor::init() {
+    // Xe layout first, then i915.
+    static const char* const kIdleResidency[] = {"gtidle/idle_residency_ms", "rc6_residency_ms"};
+    static const char* const kActFreq[] = {"freq0/act_freq", "rps_act_freq_mhz"};
+    static const char* const kCurFreq[] = {"freq0/cur_freq", "rps_cur_freq_mhz"};
+    static const char* const kMaxFreq[] = {"freq0/max_freq", "rps_max_freq_mhz"};
+    static const char* const kThrottle[kThrottleReasonCount][2] = {
+        {"freq0/throttle/reason_pl1", "throttle_reason_pl1"},
+        {"freq0/throttle/reason_pl2", "throttle_reason_pl2"},
+        {"freq0/throttle/reason_pl4", "throttle_reason_pl4"},
+        {"freq0/throttle/reason_thermal", "throttle_reason_thermal"},
+        {"freq0/throttle/reason_prochot", "throttle_reason_prochot"},
+    };
+
+    closeNodes();
+    idleResidencyFd_ = openFirst(kIdleResidency, 2);
+    actFreqFd_ = openFirst(kActFreq, 2);
+    curFreqFd_ = openFirst(kCurFreq, 2);
+    maxFreqFd_ = openFirst(kMaxFreq, 2);
+
+    if (idleResidencyFd_ < 0 || actFreqFd_ < 0 || maxFreqFd_ < 0) {
+        GPULOADLOGE("GpuLoadMonitor: Missing residency/frequency nodes under '%s'", gtPath_.c_str());
+        closeNodes();
+        return -1;
+    }
+
+    int throttleCount = 0;
+    for (int i = 0; i < kThrottleReasonCount; ++i) {
+        throttleFds_[i] = openFirst(kThrottle[i], 2);
+        if (throttleFds_[i] >= 0) ++throttleCount;
     }
-    samplerRunning_.store(false);
-    SYSMON_ALOGI("GpuLoadMonitor: sampler thread exiting");
+    if (throttleCount == 0) {
+        GPULOADLOGI("GpuLoadMonitor: No throttle reason nodes, power limitation is assumed");
+    }
+
+    unsigned long long idleMs = 0;
+    if (!readNode(idleResidencyFd_, idleMs)) {
+        GPULOADLOGE("GpuLoadMonitor: Failed initial read of idle residency");
+        closeNodes();
+        return -1;
+    }
+    return 0;
 }
 
-double GpuLoadMonitor::getGpuLoad() {
+void GpuLoadMonitor::closeNodes() {
+    for (int* fd : {&idleResidencyFd_, &actFreqFd_, &curFreqFd_, &maxFreqFd_}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    for (int& fd : throttleFds_) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+}
 
-    // Backup previous sample
-    lastSample_ = currentSample_;
-    SYSMON_ALOGD("GpuLoadMonitor: backed up last sample: idle_residency_ms=%llu",
-                 lastSample_.idle_residency_ms);
+bool GpuLoadMonitor::readNode(int fd, unsigned long long& value_out) {
+    if (fd < 0) return false;
+    char buffer[32];
+    ssize_t bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (bytes_read <= 0) {
+        GPULOADLOGE("GpuLoadMonitor: pread failed: %s", std::strerror(errno));
+        return false;
+    }
+    buffer[bytes_read] = '\0';
+    char* endptr = nullptr;
+    value_out = std::strtoull(buffer, &endptr, 10);
+    return endptr != buffer;
+}
 
-    FILE* f = fopen("/sys/class/drm/card0/device/tile0/gt0/gtidle/idle_residency_ms", "r");
-    if (!f) {
-        SYSMON_ALOGE("GpuLoadMonitor: failed to open /sys/class/drm/card0/device/tile0/gt0/gtidle/idle_residency_ms");
-        return -1.0;
+void GpuLoadMonitor::sampleOnce() {
+    if (consumeReset()) {
+        // Residency accumulated while paused is not representative, and the
+        // daemon drops GFX_MODE when it pauses us, so re-arm the edge.
+        haveLastSample_ = false;
+        gfxMode_ = 0;
     }
 
-    // Read the residency value (should be a single integer in ms)
-    unsigned long long idleResidencyMs = 0;
-    if (fscanf(f, "%llu", &idleResidencyMs) != 1) {
-        SYSMON_ALOGE("GpuLoadMonitor: failed to parse idle_residency_ms value");
-        fclose(f);
-        return -1.0;
-    };
-    fclose(f);
-    if (currentSample_.idle_residency_ms > lastSample_.idle_residency_ms) {
-        delta_idle_residency = currentSample_.idle_residency_ms - lastSample_.idle_residency_ms;
-    } else {
-        delta_idle_residency = 0;
+    auto now = std::chrono::steady_clock::now();
+    unsigned long long idleMs = 0;
+    if (!readNode(idleResidencyFd_, idleMs)) {
+        return;
+    }
+
+    if (!haveLastSample_ || idleMs < lastIdleResidencyMs_) {
+        // First sample (or counter reset): nothing to compute yet.
+        lastIdleResidencyMs_ = idleMs;
+        lastSampleTs_ = now;
+        haveLastSample_ = true;
+        return;
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - lastSampleTs_).count();
+    if (elapsedMs <= 0.0) {
+        return;
+    }
+    double idlePercent = static_cast<double>(idleMs - lastIdleResidencyMs_) * 100.0 / elapsedMs;
+    if (idlePercent > 100.0) idlePercent = 100.0;
+    double busyPercent = 100.0 - idlePercent;
+    lastIdleResidencyMs_ = idleMs;
+    lastSampleTs_ = now;
+
+    // act_freq reads 0 while the GT is in RC6; fall back to the requested frequency.
+    unsigned long long actFreq = 0, curFreq = 0, maxFreq = 0;
+    readNode(actFreqFd_, actFreq);
+    readNode(curFreqFd_, curFreq);
+    readNode(maxFreqFd_, maxFreq);
+    unsigned long long freq = actFreq ? actFreq : curFreq;
+    double weightedLoad = busyPercent;
+    if (maxFreq > 0) {
+        weightedLoad = busyPercent * static_cast<double>(freq) / static_cast<double>(maxFreq);
+        if (weightedLoad > 100.0) weightedLoad = 100.0;
+    }
+
+    bool reasons[kThrottleReasonCount] = {};
+    bool anyThrottleNode = false;
+    for (int i = 0; i < kThrottleReasonCount; ++i) {
+        unsigned long long v = 0;
+        if (throttleFds_[i] >= 0) {
+            anyThrottleNode = true;
+            reasons[i] = readNode(throttleFds_[i], v) && v != 0;
+        }
+    }
+    // Without throttle nodes keep the old behaviour (busy alone drives GFX_MODE).
+    bool powerLimited = !anyThrottleNode || reasons[kPl1] || reasons[kPl2] || reasons[kPl4];
+    bool thermalLimited = reasons[kThermal] || reasons[kProchot];
+
+    busyPercent_ = busyPercent;
+    weightedLoad_ = weightedLoad;
+    powerLimited_ = powerLimited;
+    thermalLimited_ = thermalLimited;
+
+    GPULOADLOGD("GpuLoadMonitor: busy=%.1f%% act=%llu cur=%llu max=%llu weighted=%.1f%% pl=%d thermal=%d",
+                busyPercent, actFreq, curFreq, maxFreq, weightedLoad, powerLimited, thermalLimited);
+
+    int gfxMode = (busyPercent >= busyThreshold_.load() && powerLimited && !thermalLimited) ? 1 : 0;
+    if (gfxMode != gfxMode_) {
+        GPULOADLOGI("GpuLoadMonitor: GfxMode %d -> %d (busy=%.1f%% weighted=%.1f%% pl=%d thermal=%d)",
+                    gfxMode_, gfxMode, busyPercent, weightedLoad, powerLimited, thermalLimited);
+        gfxMode_ = gfxMode;
+        onValueChanged(static_cast<int>(weightedLoad), gfxMode);
     }
-    double gpu_idle_percent = (double)delta_idle_residency * 100.0 / (double)1000;
-    double gpu_busy_percent = 100 - (gpu_idle_percent > 100.0 ? 100.0 : gpu_idle_percent);
-    // Update current sample
-    currentSample_.idle_residency_ms = idleResidencyMs;
-    SYSMON_ALOGI("GpuLoadMonitor: Read idle_residency_ms = %llu", idleResidencyMs);
-
-    // You may want to compute and return a load value here, e.g., busy percent
-    // For now, just return the raw value
-    return gpu_busy_percent;
 }
@@ -1,113 +1,95 @@
 #ifndef GPULOADMONITOR_H
 #define GPULOADMONITOR_H
 
-#include <thread>
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-#include <string>
-#include <vector>
-#include <algorithm>
 #include <chrono>
+#include <string>
 #include <android/log.h>
 
-// Exponential-moving-average helpers (handle irregular sampling intervals)
-#include <chrono>
-#include <cmath>
-#include <mutex>
-#include <sstream>
-#include <fstream>
-
-// Default sampler interval is 1 seconds. Constructor can override per-instance.
-static constexpr std::chrono::milliseconds g_gpusamplerIntervalDefault{1000};
+#include "PeriodicMonitor.h"
+
+// Default sampler period is 1 base tick (1 second). Constructor can override per-instance.
+static constexpr unsigned g_gpuSamplerPeriodTicksDefault = 1;
+
+// Logging macros for GpuLoadMonitor
+#define GPU_LOAD_LOG_TAG "SocDaemon_GpuLoadMonitor"
+#define GPULOADLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, GPU_LOAD_LOG_TAG, __VA_ARGS__)
+#define GPULOADLOGI(...) __android_log_print(ANDROID_LOG_INFO, GPU_LOAD_LOG_TAG, __VA_ARGS__)
+#define GPULOADLOGE(...) __android_log_print(ANDROID_LOG_ERROR, GPU_LOAD_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Samples GT idle residency, frequency and throttle reasons to derive GPU activity.
+ *
+ * Every period the monitor reads:
+ *  - gtidle/idle_residency_ms           -> busy percentage over the interval
+ *  - freq0/act_freq, cur_freq, max_freq -> frequency weighting of the busy percentage
+ *  - throttle reason_* attributes       -> power (PL1/PL2/PL4) vs thermal limitation
+ *
+ * Both the Xe layout (freq0/..., freq0/throttle/reason_*) and the i915 layout
+ * (rps_*_freq_mhz, throttle_reason_*) are probed at init().
+ *
+ * The alert is raised only on edges of the GFX mode decision and carries
+ * (frequency-weighted load %, gfxMode). gfxMode is 1 only when the GPU is busy
+ * AND power-limited AND not thermally limited: raising PL1 does not help a GPU
+ * that is idle-bound or already thermally throttled.
+ */
+class GpuLoadMonitor : public PeriodicMonitor {
+public:
+    /**
+     * @param name Monitor name used for alerts.
+     * @param gtPath GT sysfs directory, e.g. /sys/class/drm/card0/device/tile0/gt0
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    GpuLoadMonitor(const std::string& name, const std::string& gtPath,
+                   unsigned periodTicks = g_gpuSamplerPeriodTicksDefault);
 
+    ~GpuLoadMonitor() override;
 
-#define SYS_MON_LOG_TAG "SocDaemon"
-#define SYSMON_ALOGI(...) __android_log_print(ANDROID_LOG_INFO,  SYS_MON_LOG_TAG, __VA_ARGS__)
-#define SYSMON_ALOGE(...) __android_log_print(ANDROID_LOG_ERROR, SYS_MON_LOG_TAG, __VA_ARGS__)
-#define SYSMON_ALOGD(...) __android_log_print(ANDROID_LOG_DEBUG, SYS_MON_LOG_TAG, __VA_ARGS__)
+    // Opens the residency/frequency/throttle nodes. Returns -1 if residency or
+    // frequency nodes are missing; throttle reasons are optional.
+    int init() override;
 
-#include "HintMonitor.h"
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
 
-// GpuLoadMonitor: cleaned up to assume an external thread will call monitorLoop()
-// (SoCDaemon will create the pthread; do not create or manage std::thread here)
+    // Idle % at or below which the GPU counts as highly loaded, tunable at runtime
+    // (PolicyParams, shared with GpuRc6Monitor): busy at or above 100 - percent.
+    void setHighLoadPercent(int percent) { busyThreshold_ = 100.0 - percent; }
 
-class GpuLoadMonitor : public HintMonitor {
-public:
-    GpuLoadMonitor(const std::string& name,
-                   std::chrono::milliseconds interval = g_gpusamplerIntervalDefault)
-        : HintMonitor(name),
-          samplerRunning_(false),
-          samplerPaused_(false),
-          samplerInterval_(interval) {}
-
-    ~GpuLoadMonitor() { stop(); }
-
-    // monitorLoop() is executed by an external thread (SoCDaemon). Do NOT spawn a thread here.
-    void monitorLoop() override;
-
-    // Initialize internal flags only; do not create a thread.
-    int init() {
-        bool expected = false;
-        if (samplerRunning_.compare_exchange_strong(expected, true)) {
-            std::lock_guard<std::mutex> lk(pauseMutex_);
-            samplerPaused_.store(true); // start in paused state
-            SYSMON_ALOGI("GpuLoadMonitor: initialized (external thread expected)");
-        }
-        return 0;
-    }
-
-    // Stop sampling and wake any waiters.
-    void stop() {
-        samplerRunning_.store(false);
-        {
-            std::lock_guard<std::mutex> lk(pauseMutex_);
-            samplerPaused_.store(false);
-        }
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("GpuLoadMonitor: stop requested");
-    }
-
-    // Pause sampling
-    void pause() {
-        samplerPaused_.store(true);
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("GpuLoadMonitor: Pause periodic GPU load checks");
-    }
-
-    // Resume sampling
-    void restart() {
-        samplerPaused_.store(false);
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("GpuLoadMonitor: Resume periodic GPU load checks");
-    }
-
-    // Accessors
-    double getGpuLoad();
-    double getGpuLoadOld();
-    double getLatestGpuLoad() const;
-    double getGpuLoadDetails();
+    // Accessors (updated every sample)
+    double getBusyPercent() const { return busyPercent_.load(); }
+    double getWeightedLoad() const { return weightedLoad_.load(); }
+    bool isPowerLimited() const { return powerLimited_.load(); }
+    bool isThermalLimited() const { return thermalLimited_.load(); }
 
 private:
-    struct GpuLoadSample {
-        unsigned long long idle_residency_ms = 0;
-        //unsigned long long idleTime  = 0;
-    };
-
-    // Control flags (no internal std::thread anymore)
-    std::atomic<bool> samplerRunning_;
-    std::atomic<bool> samplerPaused_;
-    mutable std::mutex pauseMutex_;
-    std::condition_variable pauseCv_;
-
-    // Recent samples
-    GpuLoadSample lastSample_;
-    GpuLoadSample currentSample_;
-    std::chrono::milliseconds samplerInterval_;
-
-    static constexpr double kGpuLoadHighThreshold = 65.0;
+    enum ThrottleReason : int { kPl1 = 0, kPl2, kPl4, kThermal, kProchot, kThrottleReasonCount };
+
+    int openFirst(const char* const* candidates, size_t count) const;
+    static bool readNode(int fd, unsigned long long& value_out);
+    void closeNodes();
+
+    std::string gtPath_;
+
+    // Persistent descriptors, re-read with pread() every sample
+    int idleResidencyFd_ = -1;
+    int actFreqFd_ = -1;
+    int curFreqFd_ = -1;
+    int maxFreqFd_ = -1;
+    int throttleFds_[kThrottleReasonCount] = {-1, -1, -1, -1, -1};
+
+    // Previous sample
+    unsigned long long lastIdleResidencyMs_ = 0;
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    bool haveLastSample_ = false;
+    int gfxMode_ = 0;
+
+    std::atomic<double> busyPercent_{0.0};
+    std::atomic<double> weightedLoad_{0.0};
+    std::atomic<bool> powerLimited_{false};
+    std::atomic<bool> thermalLimited_{false};
+
+    static constexpr double kGpuBusyPercent = 60.0; // busy above this is "high load"
+    std::atomic<double> busyThreshold_{kGpuBusyPercent};
 };
-#endif // GPULOADMONITOR_H
\ No newline at end of file
+#endif // GPULOADMONITOR_H
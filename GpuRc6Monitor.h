@@ -1,10 +1,9 @@
 #pragma once
 
 #include <string>
-#include <functional>
 #include <android/log.h>
 
-#include "HintMonitor.h"
+#include "MonitorPipeline.h"
 
 // Logging macros for wltMonitor
 #define GPU_MONITOR_LOG_TAG "SocDaemon_GPUMonitor"
@@ -12,30 +11,30 @@
 #define GPULOGI(...) __android_log_print(ANDROID_LOG_INFO, GPU_MONITOR_LOG_TAG, __VA_ARGS__)
 #define GPULOGE(...) __android_log_print(ANDROID_LOG_ERROR, GPU_MONITOR_LOG_TAG, __VA_ARGS__)
 
+// idle_residency_ms is a millisecond counter: idle % of the elapsed sample time,
+// reported as (idle %, gfxMode) when the high-load level flips.
+using GpuRc6Pipeline = pipeline::Monitor<pipeline::FileSource, pipeline::CounterPercentParser<1000>,
+                                         pipeline::NoFilter, pipeline::ThresholdDetector<true>, pipeline::AlertSink>;
+
 /**
  * @brief Monitor GPU RC6 residency by reading sysfs entry.
  */
-class GpuRc6Monitor : public HintMonitor {
+class GpuRc6Monitor : public GpuRc6Pipeline {
 public:
-    GpuRc6Monitor(const std::string& name, const std::string& sysfsPath, int pollTimeoutMs);
-
-    virtual ~GpuRc6Monitor() = default;
-    bool readValueOnce(std::string& value_out);
-    bool readValue(int fd, std::string& value_out);
-    void onValueChanged(int previous_value, int current_value) override;
-    void monitorLoop() override;
-    int init();
-    void stop();
-    void pause();
-    void resume();
+    // One residency read per base tick through the SamplingClock.
+    GpuRc6Monitor(const std::string& name, const std::string& sysfsPath);
+
+    ~GpuRc6Monitor() override = default;
+
+    // Idle % at or below which the GPU counts as highly loaded, tunable at runtime (PolicyParams).
+    void setHighLoadPercent(int percent) { detector().setThreshold(percent); }
+
+    // 100 - idle % of the last sample; -1 before the first one.
+    double getBusyPercent() const {
+        double idle = lastValue();
+        return std::isnan(idle) ? -1.0 : 100.0 - idle;
+    }
 
 private:
-    std::string sysfs_path_;
-    int poll_timeout_ms_;
-    static constexpr size_t kSysfsReadBufferSize = 32;
     static constexpr int kGpuHighLoadPercent = 40; // Example threshold percentage
-    std::mutex pauseMutex_;
-    std::condition_variable pauseCv_;
-    bool paused_ = false;
-    bool shouldExit_ = false;
 };
@@ -10,8 +10,8 @@
  * Key Functions:
  * - HfiMonitor::init(): Initializes the netlink socket, connects to the generic netlink family,
  *   subscribes to the thermal event multicast group, and sets up the message callback.
- * - HfiMonitor::monitorLoop(): Runs a blocking loop to receive and dispatch netlink messages
- *   to the registered callback handler.
+ * - HfiMonitor::monitorLoop(): Blocks in poll() on the socket and dispatches netlink
+ *   messages to the registered callback handler.
  * - HfiMonitor::process_message(): Processes incoming netlink messages, parses thermal event
  *   attributes, and updates the efficient power mode if necessary.
  *
@@ -25,8 +25,9 @@
  * - PowerHalService for updating power modes.
  *
  * Thread Safety:
- * - The monitorLoop() function is designed to run in a dedicated thread, blocking on message
- *   reception and dispatching events as they arrive.
+ * - The monitorLoop() function is designed to run in a dedicated thread, waiting without a
+ *   timeout for message reception and dispatching events as they arrive. A blocked poll is
+ *   healthy; the watchdog only reports the thread's exit.
  *
  * Usage:
  * 1. Create an instance of HfiMonitor.
@@ -34,11 +35,21 @@
  * 3. Start monitorLoop() in a separate thread to begin processing events.
  *
  * Note:
- * - The process_message() function currently focuses on handling CPU capability change events,
- *   but can be extended to support additional thermal event types as needed.
+ * - The process_message() function handles CPU capability change events (the HFI hint) and
+ *   decodes trip crossings (with the zone temperature they carry) and cooling device
+ *   updates into a thermal pressure level, raised as the
+ *   kThermalPressureAlert change alert. Trip types/temperatures are read from sysfs once
+ *   per zone, when the zone is first seen.
  */
 #include <linux/netlink.h>
 #include <linux/thermal.h>
+#include <poll.h>
+#include <cerrno>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
 
 #include "HfiMonitor.h"
 
@@ -76,6 +87,9 @@ int HfiMonitor::init()
         return -1;
     }
 
+    // The "sampling" group is not joined: it multicasts every zone's temperature on
+    // every polling interval. Zone temperatures come with the trip events instead.
+
     // Register a custom callback handler for incoming netlink messages
     // NL_CB_MSG_IN: Callback type for incoming messages
     // NL_CB_CUSTOM: Use a user-defined callback function
@@ -86,21 +100,33 @@ int HfiMonitor::init()
     // Disable sequence number checking for multicast/event sockets
     nl_socket_disable_seq_check(hfi_sock_);
 
+    // monitorLoop() waits in poll(); receive without blocking once woken
+    nl_socket_set_nonblocking(hfi_sock_);
+
     return 0; // Return 0 on successful initialization
 }
 
 void HfiMonitor::monitorLoop() {
+    struct pollfd pfd = {nl_socket_get_fd(hfi_sock_), POLLIN, 0};
 
-     while (true) {
-            // This function blocks, receives messages, and dispatches them to our callback
+    while (!shouldExit_) {
+        int ret = poll(&pfd, 1, -1);
+        if (ret < 0) {
+            if (errno != EINTR) {
+                HFILOGE("poll() failed on the thermal netlink socket: %s", strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+        if (ret > 0) {
+            // Receives pending messages and dispatches them to our callback
             int res = nl_recvmsgs_default(hfi_sock_);
-            if (res < 0) {
-                 // An error like -NLE_INTR (Interrupted system call) is not fatal.
-                 // You might want more sophisticated error handling here.
-                 HFILOGE("Failed to receive netlink messages: %s", nl_geterror(res));
+            if (res < 0 && res != -NLE_AGAIN) {
+                // An error like -NLE_INTR (Interrupted system call) is not fatal.
+                HFILOGE("Failed to receive netlink messages: %s", nl_geterror(res));
             }
         }
-
+    }
 }
 
 void HfiMonitor::process_message(struct nl_msg *msg) {
@@ -155,8 +181,174 @@ void HfiMonitor::process_message(struct nl_msg *msg) {
 
             break;
         }
-        // ... (all other cases unchanged) ...
+        case THERMAL_GENL_EVENT_TZ_TRIP_UP:
+        case THERMAL_GENL_EVENT_TZ_TRIP_DOWN: {
+            if (!attrs[THERMAL_GENL_ATTR_TZ_ID] || !attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]) break;
+            int tz = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            int trip = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]);
+            bool up = glh->cmd == THERMAL_GENL_EVENT_TZ_TRIP_UP;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            Zone& z = zone(tz);
+            if (attrs[THERMAL_GENL_ATTR_TZ_TEMP]) {
+                z.tempMC = static_cast<int>(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TEMP]));
+                z.haveTemp = true;
+            }
+            auto known = z.trips.find(trip);
+            if (up && (known == z.trips.end() || known->second.limits)) { // unknown trips count as limits
+                z.crossed.insert(trip);
+            } else {
+                z.crossed.erase(trip);
+            }
+            tripEvents_++;
+            HFILOGI("Thermal zone %d trip %d crossed %s (temp %d)", tz, trip, up ? "up" : "down", z.tempMC);
+            break;
+        }
+        case THERMAL_GENL_EVENT_TZ_TRIP_CHANGE:
+        case THERMAL_GENL_EVENT_TZ_TRIP_ADD: {
+            if (!attrs[THERMAL_GENL_ATTR_TZ_ID] || !attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID] ||
+                !attrs[THERMAL_GENL_ATTR_TZ_TRIP_TYPE] || !attrs[THERMAL_GENL_ATTR_TZ_TRIP_TEMP]) break;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            Trip& t = zone(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID])).trips[nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID])];
+            t.limits = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_TYPE]) != 0; // 0 is THERMAL_TRIP_ACTIVE
+            t.tempMC = static_cast<int>(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_TEMP]));
+            break;
+        }
+        case THERMAL_GENL_EVENT_TZ_TRIP_DELETE: {
+            if (!attrs[THERMAL_GENL_ATTR_TZ_ID] || !attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]) break;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            Zone& z = zone(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
+            z.trips.erase(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]));
+            z.crossed.erase(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]));
+            break;
+        }
+        case THERMAL_GENL_EVENT_TZ_DELETE:
+        case THERMAL_GENL_EVENT_TZ_DISABLE: {
+            if (!attrs[THERMAL_GENL_ATTR_TZ_ID]) break;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            zones_.erase(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
+            break;
+        }
+        case THERMAL_GENL_EVENT_CDEV_STATE_UPDATE: {
+            if (!attrs[THERMAL_GENL_ATTR_CDEV_ID] || !attrs[THERMAL_GENL_ATTR_CDEV_CUR_STATE]) break;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            Cdev& c = cdev(nla_get_u32(attrs[THERMAL_GENL_ATTR_CDEV_ID]));
+            c.state = static_cast<int>(nla_get_u32(attrs[THERMAL_GENL_ATTR_CDEV_CUR_STATE]));
+            cdevUpdates_++;
+            HFILOGD("Cooling device %u state %d", nla_get_u32(attrs[THERMAL_GENL_ATTR_CDEV_ID]), c.state);
+            break;
+        }
+        case THERMAL_GENL_EVENT_CDEV_DELETE: {
+            if (!attrs[THERMAL_GENL_ATTR_CDEV_ID]) break;
+            std::lock_guard<std::mutex> lock(thermalMutex_);
+            cdevs_.erase(nla_get_u32(attrs[THERMAL_GENL_ATTR_CDEV_ID]));
+            break;
+        }
+        case THERMAL_GENL_EVENT_TZ_CREATE:
+        case THERMAL_GENL_EVENT_TZ_ENABLE:
+        case THERMAL_GENL_EVENT_CDEV_ADD:
+        case THERMAL_GENL_EVENT_TZ_GOV_CHANGE:
+            // Zones and cooling devices are loaded lazily on their first event.
+            break;
         default:
             HFILOGE("JHS Unknown genlink event command:%x", glh->cmd);
     }
+
+    if (glh->cmd != THERMAL_GENL_EVENT_CPU_CAPABILITY_CHANGE) {
+        updateThermalLevel();
+    }
+}
+
+HfiMonitor::Zone& HfiMonitor::zone(int id) {
+    Zone& z = zones_[id];
+    if (z.loaded) return z;
+    z.loaded = true;
+    // Trip types/temperatures once per zone; later changes arrive as TZ_TRIP_CHANGE.
+    char path[128];
+    for (int trip = 0;; ++trip) {
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/trip_point_%d_type", id, trip);
+        std::ifstream typeFile(path);
+        std::string type;
+        if (!(typeFile >> type)) break;
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/trip_point_%d_temp", id, trip);
+        std::ifstream tempFile(path);
+        Trip& t = z.trips[trip];
+        t.limits = type != "active";
+        if (!(tempFile >> t.tempMC)) z.trips.erase(trip);
+    }
+    return z;
+}
+
+HfiMonitor::Cdev& HfiMonitor::cdev(int id) {
+    Cdev& c = cdevs_[id];
+    if (c.loaded) return c;
+    c.loaded = true;
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/class/thermal/cooling_device%d/type", id);
+    std::ifstream typeFile(path);
+    std::string type;
+    std::getline(typeFile, type);
+    c.fan = type.find("Fan") != std::string::npos || type.find("fan") != std::string::npos;
+    return c;
+}
+
+int HfiMonitor::computeLevelLocked(ThermalStatus* status) const {
+    int tripped = 0, activeCdevs = 0, headroom = -1, hottest = -1;
+    for (const auto& [id, z] : zones_) {
+        tripped += static_cast<int>(z.crossed.size());
+        if (!z.haveTemp) continue;
+        for (const auto& [tripId, t] : z.trips) {
+            if (!t.limits || t.tempMC <= 0) continue;
+            int margin = t.tempMC - z.tempMC;
+            if (headroom < 0 || margin < headroom) {
+                headroom = std::max(margin, 0);
+                hottest = id;
+            }
+        }
+    }
+    for (const auto& [id, c] : cdevs_) {
+        if (!c.fan && c.state > 0) activeCdevs++;
+    }
+
+    int level = kThermalNormal;
+    if (tripped > 0 || activeCdevs > 0) {
+        level = kThermalThrottling;
+    } else if (headroom >= 0) {
+        int margin = kNearTripMarginMC + (thermalLevel_ >= kThermalNear ? kNearTripHysteresisMC : 0);
+        if (headroom < margin) level = kThermalNear;
+    }
+    if (status) {
+        status->level = level;
+        status->headroomMC = headroom;
+        status->hottestZone = hottest;
+        status->trippedTrips = tripped;
+        status->activeCdevs = activeCdevs;
+        status->tripEvents = tripEvents_;
+        status->cdevUpdates = cdevUpdates_;
+    }
+    return level;
+}
+
+void HfiMonitor::updateThermalLevel() {
+    int previous, level;
+    ThermalStatus status;
+    {
+        std::lock_guard<std::mutex> lock(thermalMutex_);
+        level = computeLevelLocked(&status);
+        previous = thermalLevel_;
+        thermalLevel_ = level;
+    }
+    if (level == previous) return;
+    HFILOGI("Thermal pressure %d -> %d (headroom %d mC in zone %d, %d trip(s) crossed, %d cdev(s) engaged)",
+            previous, level, status.headroomMC, status.hottestZone, status.trippedTrips, status.activeCdevs);
+    if (alertCallback_) {
+        alertCallback_(kThermalPressureAlert, previous, level);
+    }
+}
+
+HfiMonitor::ThermalStatus HfiMonitor::thermalStatus() const {
+    ThermalStatus status;
+    std::lock_guard<std::mutex> lock(thermalMutex_);
+    computeLevelLocked(&status);
+    status.level = thermalLevel_;
+    return status;
 }
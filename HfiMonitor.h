@@ -1,5 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <functional>
 #include <android/log.h>
@@ -11,10 +16,25 @@
 // Logging macros for HfiMonitor
 #define HFI_MONITOR_LOG_TAG "SocDaemon_HfiMonitor"
 #define HFILOGI(...) __android_log_print(ANDROID_LOG_INFO, HFI_MONITOR_LOG_TAG, __VA_ARGS__)
+#define HFILOGD(...) __android_log_print(ANDROID_LOG_DEBUG, HFI_MONITOR_LOG_TAG, __VA_ARGS__)
 #define HFILOGE(...) __android_log_print(ANDROID_LOG_ERROR, HFI_MONITOR_LOG_TAG, __VA_ARGS__)
 
+// Thermal pressure decoded from the same genetlink socket, raised as its own
+// change alert: alert name kThermalPressureAlert, (previous level, level).
+inline constexpr char kThermalPressureAlert[] = "ThermalPressure";
+enum ThermalPressure : int {
+    kThermalNormal = 0,
+    kThermalNear = 1,       // within kNearTripMargin of a passive trip
+    kThermalThrottling = 2, // a passive/hot/critical trip crossed, or a non-fan cooling device engaged
+};
+
 /**
  * @brief Monitors HFI
+ *
+ * Also decodes the thermal trip and cooling device events multicast on the
+ * thermal "event" group into a thermal pressure level. Headroom is known from
+ * the temperature carried by trip events, so "near" is seen when a lower
+ * (e.g. active) trip of the zone is crossed.
  */
 class HfiMonitor : public HintMonitor {
 public:
@@ -25,11 +45,56 @@ public:
     void monitorLoop() override;
     
     int init();
+    void stop() { shouldExit_ = true; }
+
+    struct ThermalStatus {
+        int level = kThermalNormal;
+        int headroomMC = -1;   // to the nearest passive trip, -1 when unknown
+        int hottestZone = -1;  // zone with the least headroom
+        int trippedTrips = 0;  // passive/hot/critical trips currently crossed
+        int activeCdevs = 0;   // non-fan cooling devices in a non-zero state
+        uint64_t tripEvents = 0;
+        uint64_t cdevUpdates = 0;
+    };
+    ThermalStatus thermalStatus() const;
 
 private:
-    struct nl_sock *hfi_sock_;
+    static constexpr int kNearTripMarginMC = 5000;  // millidegrees C below the nearest passive trip
+    static constexpr int kNearTripHysteresisMC = 2000;
+
+    struct Trip {
+        bool limits = false; // passive, hot or critical (active trips only start fans)
+        int tempMC = 0;
+    };
+    struct Zone {
+        bool loaded = false;
+        int tempMC = 0;
+        bool haveTemp = false;
+        std::map<int, Trip> trips; // by trip id
+        std::set<int> crossed;     // trip ids crossed on the way up
+    };
+    struct Cdev {
+        bool loaded = false;
+        bool fan = false;
+        int state = 0;
+    };
+
+    // Thermal state; HFI thread writes, control thread reads. Caller holds thermalMutex_.
+    Zone& zone(int id);
+    Cdev& cdev(int id);
+    int computeLevelLocked(ThermalStatus* status) const;
+    void updateThermalLevel();
+    struct nl_sock *hfi_sock_ = nullptr;
+    std::atomic<bool> shouldExit_{false};
     int efficient_power = 0; // Default efficient power mode
 
+    mutable std::mutex thermalMutex_;
+    std::map<int, Zone> zones_;
+    std::map<int, Cdev> cdevs_;
+    int thermalLevel_ = kThermalNormal;
+    uint64_t tripEvents_ = 0;
+    uint64_t cdevUpdates_ = 0;
+
     static int event_handler(struct nl_msg *msg, void *arg) {
          // Cast the 'arg' back to our class instance
         HfiMonitor* self = static_cast<HfiMonitor*>(arg);
@@ -0,0 +1,137 @@
+// -----------------------------------------------------------------------------
+// HintGovernor.cpp
+//
+// Toggle budget / minimum hold / back-off for HAL hints. See HintGovernor.h.
+// -----------------------------------------------------------------------------
+
+#include "HintGovernor.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+HintGovernor::HintGovernor(const std::string& name, const GovernorConfig& config, int urgentValue)
+    : name_(name), config_(config), urgentValue_(urgentValue) {}
+
+int64_t HintGovernor::nowMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+int64_t HintGovernor::requiredHoldMs() const {
+    int64_t hold = config_.minHold.count();
+    for (unsigned i = 0; i < backoffLevel_ && hold < config_.maxBackoff.count(); ++i) hold *= 2;
+    return std::min<int64_t>(hold, config_.maxBackoff.count());
+}
+
+HintGovernor::Decision HintGovernor::request(int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+
+    if (value == current_) {
+        if (pendingValue_ >= 0) {
+            // The toggle we were holding back is no longer wanted.
+            ++suppressed_;
+            pendingValue_ = -1;
+        }
+        return Decision::Unchanged;
+    }
+
+    if (config_.maxToggles == 0 || current_ < 0) {
+        ++allowed_;
+        current_ = value;
+        lastToggleMs_ = now;
+        pendingValue_ = -1;
+        return Decision::Allow;
+    }
+
+    while (!toggles_.empty() && now - toggles_.front() >= config_.window.count()) toggles_.pop_front();
+
+    int64_t held = now - lastToggleMs_;
+    int64_t requiredHold = requiredHoldMs();
+    int64_t dueMs = 0;
+    bool budget = false;
+    if (held < requiredHold) {
+        dueMs = lastToggleMs_ + requiredHold;
+    } else if (toggles_.size() >= config_.maxToggles) {
+        dueMs = toggles_.front() + config_.window.count();
+        budget = true;
+    }
+
+    if (dueMs > now && value == urgentValue_) {
+        ++urgent_;
+        GOVLOGI("HintGovernor: %s -> %d allowed despite %s (urgent)", name_.c_str(), value,
+                budget ? "toggle budget" : "min hold");
+    } else if (dueMs > now) {
+        if (pendingValue_ != value) {
+            (budget ? deferredBudget_ : deferredHold_)++;
+            GOVLOGI("HintGovernor: %s -> %d deferred %lldms (%s, backoff level %u)", name_.c_str(), value,
+                    static_cast<long long>(dueMs - now), budget ? "toggle budget" : "min hold", backoffLevel_);
+        }
+        pendingValue_ = value;
+        pendingDueMs_ = dueMs;
+        return Decision::Defer;
+    }
+
+    // Allowed: adjust the back-off from how long the previous value was held.
+    if (held < config_.flapWindow.count()) {
+        if (requiredHoldMs() < config_.maxBackoff.count()) ++backoffLevel_;
+        ++flaps_;
+    } else if (backoffLevel_ > 0 && held >= 2 * requiredHold) {
+        --backoffLevel_;
+    }
+
+    ++allowed_;
+    current_ = value;
+    lastToggleMs_ = now;
+    toggles_.push_back(now);
+    pendingValue_ = -1;
+    return Decision::Allow;
+}
+
+void HintGovernor::sync(int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ = value;
+    pendingValue_ = -1;
+}
+
+int HintGovernor::duePending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pendingValue_ < 0 || nowMs() < pendingDueMs_) return -1;
+    return pendingValue_;
+}
+
+bool HintGovernor::hasPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pendingValue_ >= 0;
+}
+
+void HintGovernor::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[384];
+    snprintf(buf, sizeof(buf),
+             "governor_%s value=%d pending=%d backoff_level=%u required_hold_ms=%lld toggles_in_window=%zu "
+             "allowed=%" PRIu64 " urgent=%" PRIu64 " deferred_hold=%" PRIu64 " deferred_budget=%" PRIu64
+             " suppressed=%" PRIu64 " flaps=%" PRIu64 "\n",
+             name_.c_str(), current_, pendingValue_, backoffLevel_, static_cast<long long>(requiredHoldMs()),
+             toggles_.size(), allowed_, urgent_, deferredHold_, deferredBudget_, suppressed_, flaps_);
+    out += buf;
+}
+
+void HintGovernor::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[256];
+    const struct { const char* outcome; uint64_t value; } outcomes[] = {
+        {"allowed", allowed_},
+        {"urgent", urgent_},
+        {"deferred_hold", deferredHold_},
+        {"deferred_budget", deferredBudget_},
+        {"suppressed", suppressed_},
+    };
+    for (const auto& outcome : outcomes) {
+        snprintf(buf, sizeof(buf), "socdaemon_governor_toggles_total{type=\"%s\",outcome=\"%s\"} %" PRIu64 "\n",
+                 name_.c_str(), outcome.outcome, outcome.value);
+        out += buf;
+    }
+}
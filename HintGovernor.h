@@ -0,0 +1,85 @@
+#pragma once
+
+// HintGovernor.h
+// -----------------------------------------------------------------------------
+// Output-side rate governor for one boolean HAL hint. Every EFFICIENT_POWER
+// toggle makes the Power HAL rewrite cpusets, uclamp and the workqueue mask and
+// migrate every task, so flapping costs more than staying in either state.
+//
+// A toggle is allowed only if:
+//   - the current value has been held for at least minHold << backoffLevel
+//   - fewer than maxToggles toggles happened in the last window
+// A toggle that reverses the previous one within flapWindow raises the back-off
+// level; holding a value for twice the required hold lowers it again.
+// Denied toggles are kept as a pending request that the owner retries once it
+// becomes due; a pending request that is reverted before it is sent is counted
+// as suppressed.
+//
+// A toggle to the urgent value (the performance direction: leaving containment,
+// raising GFX_MODE) is never deferred, since holding it back is what causes
+// jank. It still counts against the budget and the back-off, so a flap costs
+// the next toggle away from it.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#define GOV_LOG_TAG "SocDaemon_HintGovernor"
+#define GOVLOGI(...) __android_log_print(ANDROID_LOG_INFO, GOV_LOG_TAG, __VA_ARGS__)
+
+struct GovernorConfig {
+    unsigned maxToggles = 0;                         // per window; 0 disables the governor (default)
+    std::chrono::milliseconds window{60000};
+    std::chrono::milliseconds minHold{5000};
+    std::chrono::milliseconds flapWindow{30000};     // reversal within this counts as flapping
+    std::chrono::milliseconds maxBackoff{120000};    // cap of minHold << backoffLevel
+};
+
+class HintGovernor {
+public:
+    enum class Decision { Unchanged, Allow, Defer };
+
+    // urgentValue: value that is always allowed at once (-1: none).
+    HintGovernor(const std::string& name, const GovernorConfig& config, int urgentValue = -1);
+
+    // Ask to move the hint to `value`. On Allow the caller must send it.
+    Decision request(int value);
+
+    // Record a value sent outside the governor (startup reconcile); no toggle is counted.
+    void sync(int value);
+
+    // Pending value whose deferral has expired, or -1.
+    int duePending();
+    bool hasPending() const;
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const; // samples only; the caller writes # TYPE
+
+private:
+    static int64_t nowMs();
+    int64_t requiredHoldMs() const; // caller holds mutex_
+
+    std::string name_;
+    GovernorConfig config_;
+    int urgentValue_;
+
+    int current_ = -1;
+    int64_t lastToggleMs_ = INT64_MIN / 2;
+    unsigned backoffLevel_ = 0;
+    std::deque<int64_t> toggles_; // toggle times within the window
+
+    int pendingValue_ = -1;
+    int64_t pendingDueMs_ = 0;
+
+    uint64_t allowed_ = 0;
+    uint64_t urgent_ = 0; // allowed only because the value is urgent
+    uint64_t deferredHold_ = 0;
+    uint64_t deferredBudget_ = 0;
+    uint64_t suppressed_ = 0;
+    uint64_t flaps_ = 0;
+    mutable std::mutex mutex_;
+};
@@ -1,49 +1,120 @@
 #include "HintManager.h" // Include your header file first
 
+#include <thread>
+#include <vector>
+
 // Definition of the HintManager constructor
-HintManager::HintManager() {
+HintManager::HintManager() = default;
+
+HintManager::~HintManager() {
+    // The daemon outlives the attempt; joining keeps the thread off a destroyed HintManager.
+    if (connectThread_.joinable()) connectThread_.join();
+}
+
+std::shared_ptr<IPowerExt> HintManager::connect() {
     // Attempt to connect to the Power HAL Extension service.
     const std::string kInstance = std::string(IPower::descriptor) + "/default";
-    ndk::SpAIBinder power_binder = ndk::SpAIBinder(AServiceManager_getService(kInstance.c_str()));
+    // A declared service is waited for (it may not be registered yet at boot);
+    // otherwise fall back to the bounded lookup.
+    ndk::SpAIBinder power_binder = ndk::SpAIBinder(AServiceManager_isDeclared(kInstance.c_str())
+                                                           ? AServiceManager_waitForService(kInstance.c_str())
+                                                           : AServiceManager_getService(kInstance.c_str()));
     ndk::SpAIBinder ext_power_binder;
 
     if (power_binder.get() == nullptr) {
         HMLOGE("HintManager: Cannot get Power Hal Binder for instance '%s'", kInstance.c_str());
-        return; // Connection failed
+        return nullptr; // Connection failed
     }
 
     // Try to get the extension interface from the main IPower binder.
     if (STATUS_OK != AIBinder_getExtension(power_binder.get(), ext_power_binder.getR()) ||
         ext_power_binder.get() == nullptr) {
         HMLOGE("HintManager: Cannot get Power Hal Extension Binder from main HAL.");
-        return; // Connection failed
+        return nullptr; // Connection failed
     }
 
     // Convert the AIBinder to the AIDL interface shared_ptr.
-    power_ext_hal_ = IPowerExt::fromBinder(ext_power_binder);
-    if (power_ext_hal_ == nullptr) {
+    std::shared_ptr<IPowerExt> hal = IPowerExt::fromBinder(ext_power_binder);
+    if (hal == nullptr) {
         HMLOGE("HintManager: Cannot get Power Hal Extension AIDL interface.");
-        return; // Connection failed
+        return nullptr; // Connection failed
     }
 
     HMLOGI("HintManager: Successfully connected to Power HAL Extension.");
+    return hal;
+}
+
+void HintManager::connectAsync(ConnectCallback callback) {
+    if (connecting_.exchange(true)) return;
+    // Off the caller: waitForService may block for as long as the HAL is not registered.
+    connectThread_ = std::thread(&HintManager::connectThread, this, std::move(callback));
+}
+
+void HintManager::connectThread(ConnectCallback callback) {
+    std::shared_ptr<IPowerExt> hal = connect();
+    size_t delivered = 0;
+    std::map<std::string, bool> undelivered;
+    {
+        // Held while flushing so a concurrent sendHint() cannot be overtaken by
+        // an older buffered value; it waits here, then goes straight to the HAL.
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hal == nullptr) {
+            if (!desired_.empty()) {
+                HMLOGE("HintManager: Dropping %zu buffered hint(s), Power HAL not reachable.", desired_.size());
+            }
+            undelivered.swap(desired_);
+            gaveUp_ = true;
+        } else {
+            // Enables first: a mode handed over to another (TUNE_*) never falls back to the defaults.
+            std::vector<std::pair<std::string, bool>> ordered;
+            for (const auto& entry : desired_) if (entry.second) ordered.push_back(entry);
+            for (const auto& entry : desired_) if (!entry.second) ordered.push_back(entry);
+            for (const auto& [type, enable] : ordered) {
+                if (hal->setMode(type, enable).isOk()) {
+                    HMLOGI("Delivered buffered hint. Mode: '%s' enabled: %d", type.c_str(), enable);
+                    delivered++;
+                } else {
+                    HMLOGE("Fail to send buffered hint. Mode: '%s' enabled: %d", type.c_str(), enable);
+                    undelivered[type] = enable;
+                }
+            }
+            desired_.clear();
+            power_ext_hal_ = hal;
+            connected_ = true;
+        }
+    }
+    if (callback) callback(hal != nullptr, delivered, undelivered);
 }
 
 bool HintManager::isPowerHalConnected() const
 {
-    return power_ext_hal_ != nullptr;
+    return connected_.load();
+}
+
+size_t HintManager::pendingHints() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return desired_.size();
 }
- 
 
 // Definition of setMode() member function
 bool HintManager::sendHint(const std::string &type, const bool &enable) {
-    if (!isPowerHalConnected()) {
-        HMLOGE("Not connected to Power HAL Extension. Cannot set mode '%s'.", type.c_str());
-        return false;
+    std::shared_ptr<IPowerExt> hal;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!connected_) {
+            if (gaveUp_ || !connecting_) {
+                HMLOGE("Not connected to Power HAL Extension. Cannot set mode '%s'.", type.c_str());
+                return false;
+            }
+            desired_[type] = enable;
+            HMLOGI("Power HAL not connected yet, buffered hint. Mode: '%s' enabled: %d", type.c_str(), enable);
+            return true;
+        }
+        hal = power_ext_hal_;
     }
 
     // Call the AIDL interface method. Check if the transaction was successful.
-    if (!power_ext_hal_->setMode(type, enable).isOk()) {
+    if (!hal->setMode(type, enable).isOk()) {
         HMLOGE("Fail to send hint. Mode: '%s' enabled: %d", type.c_str(), enable);
         return false;
     } else {
@@ -51,4 +122,3 @@ bool HintManager::sendHint(const std::string &type, const bool &enable) {
         return true;
     }
 }
-
@@ -6,8 +6,13 @@
 #include <android/binder_manager.h>
 #include <android/binder_status.h>
 
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>   // For std::shared_ptr
+#include <mutex>
 #include <string>   // For std::string
+#include <thread>
 #include <utility>  // For std::move
 
 // Required for Android logging
@@ -25,14 +30,40 @@ using ::aidl::google::hardware::power::extension::pixel::IPowerExt;
  * @brief Manages connection to the Power HAL Extension and sends power hints.
  * This class handles establishing and maintaining a connection to the IPowerExt
  * AIDL service, allowing the daemon to send specific power modes.
+ *
+ * The connection is made in the background (connectAsync()) so that the daemon
+ * does not block on the service manager at boot. Hints sent before the HAL is
+ * reachable are kept as desired state (last value per mode) and delivered when
+ * the connection is made.
  */
 class HintManager {
 public:
     /**
-     * @brief Constructor for HintManager. Attempts to connect to the Power HAL Extension.
-     * The connection status can be checked using isConnected().
+     * @brief Called once the connection attempt has finished.
+     * @param connected True if the Power HAL Extension is reachable.
+     * @param delivered Buffered modes successfully set on connection.
+     * @param undelivered Buffered modes (mode -> value) that did not reach the HAL:
+     * dropped because it is not reachable, or failed on delivery.
      */
-    HintManager(); // Declare the default constructor here
+    using ConnectCallback = std::function<void(bool connected, size_t delivered,
+                                               const std::map<std::string, bool>& undelivered)>;
+
+    /**
+     * @brief Constructor for HintManager. Does not connect; see connectAsync().
+     */
+    HintManager();
+
+    /**
+     * @brief Joins the connection thread.
+     */
+    ~HintManager();
+
+    /**
+     * @brief Starts a thread that waits for the Power HAL Extension, connects
+     * and flushes the buffered desired state. Only the first call has an effect.
+     * @param callback Invoked on that thread when the attempt has finished.
+     */
+    void connectAsync(ConnectCallback callback);
 
     /**
      * @brief Checks if the HintManager is successfully connected to the Power HAL Extension.
@@ -44,14 +75,31 @@ public:
      * @brief Sends a power mode hint to the Power HAL Extension.
      * @param type The type of power mode to set (e.g., "CPU_BOOST", "INTERACTION").
      * @param enable True to enable the mode, false to disable.
-     * @return true if the mode was successfully set, false otherwise.
+     * @return true if the mode was successfully set, or buffered while the connection is
+     * pending; false otherwise.
      */
     bool sendHint(const std::string &type, const bool &enable);
 
+    /**
+     * @brief Number of modes currently buffered for delivery on connection.
+     */
+    size_t pendingHints() const;
+
 private:
+    // Blocks until the service is registered (or known to be absent) and connects.
+    std::shared_ptr<IPowerExt> connect();
+    void connectThread(ConnectCallback callback);
+
     // Shared pointer to the IPowerExt AIDL interface.
-    // This will manage the lifecycle of the connection.
+    // This will manage the lifecycle of the connection. Guarded by mutex_.
     std::shared_ptr<IPowerExt> power_ext_hal_;
+    std::atomic<bool> connected_{false};
+    std::atomic<bool> connecting_{false};
+    bool gaveUp_ = false; // connection failed for good: hints are no longer buffered
+
+    mutable std::mutex mutex_;
+    std::map<std::string, bool> desired_; // mode -> last requested value, while not connected
+    std::thread connectThread_;
 };
 
 #endif // HINT_MANAGER_H
@@ -1,6 +1,7 @@
 #ifndef HINTMONITOR_H
 #define HINTMONITOR_H
 
+#include <chrono>
 #include <string>
 #include <functional>
 
@@ -85,6 +86,30 @@ public:
      */
     virtual void monitorLoop() = 0;
 
+    /**
+     * @brief Sampling period as a multiple of the SamplingClock base tick.
+     * @return 0 for event-driven monitors that own a thread (the default).
+     *
+     * Periodic monitors return a non-zero period and implement sampleOnce();
+     * the daemon then services them from the shared SamplingClock instead of
+     * running monitorLoop() on a dedicated thread, so that all periodic reads
+     * are coalesced into one wakeup.
+     */
+    virtual unsigned periodTicks() const { return 0; }
+
+    /**
+     * @brief Whether a periodic monitor currently wants to be sampled.
+     *
+     * Paused monitors return false; when no source is sampling the clock
+     * thread sleeps until it is woken.
+     */
+    virtual bool isSampling() const { return true; }
+
+    /**
+     * @brief Take one sample. Called from the SamplingClock thread when due.
+     */
+    virtual void sampleOnce() {}
+
     /**
      * @brief Install a callback to be notified on value changes.
      * @param cb A callable accepting (const std::string& hintName, int oldValue, int newValue).
@@ -102,6 +127,36 @@ public:
         alertCallback_ = std::move(cb);
     }
 
+    /**
+     * @brief Liveness period of an event-driven monitor.
+     * @return 0 when the loop may legitimately block forever (the default).
+     *
+     * Monitors that return a non-zero period call heartbeat() at least that
+     * often while their loop is healthy (e.g. on every poll timeout), so a
+     * watchdog can tell a quiet source from a dead or stuck thread.
+     */
+    virtual std::chrono::milliseconds heartbeatPeriod() const { return std::chrono::milliseconds(0); }
+
+    /**
+     * @brief Install the liveness callback invoked by heartbeat(). May be empty.
+     */
+    void setHeartbeatCallback(std::function<void()> cb)
+    {
+        heartbeatCallback_ = std::move(cb);
+    }
+
+    /**
+     * @brief Install the callback told when the monitored source is lost (true)
+     * and when it delivers again (false). May be empty.
+     *
+     * A loop that keeps re-opening a missing node never exits, so without this
+     * a lost input would look like a quiet one.
+     */
+    void setSourceCallback(std::function<void(bool lost)> cb)
+    {
+        sourceCallback_ = std::move(cb);
+    }
+
     /**
      * @brief Return the name of the monitored hint.
      * @return const std::string& Reference to the stored hint name.
@@ -137,6 +192,32 @@ protected:
         }
     }
 
+    /**
+     * @brief Invoked by derived loops every time they complete a wait/read cycle.
+     */
+    void heartbeat()
+    {
+        if (heartbeatCallback_) {
+            heartbeatCallback_();
+        }
+    }
+
+    /**
+     * @brief Invoked by derived loops when their source is lost and when it is back.
+     */
+    void sourceChanged(bool lost)
+    {
+        if (sourceCallback_) {
+            sourceCallback_(lost);
+        }
+    }
+
+    // Stored liveness callback. May be empty.
+    std::function<void()> heartbeatCallback_;
+
+    // Stored source loss callback. May be empty.
+    std::function<void(bool lost)> sourceCallback_;
+
     // Stored change notification callback. May be empty.
     std::function<void(const std::string& hintName, int oldValue, int newValue)> alertCallback_;
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+// Histogram.h
+// -----------------------------------------------------------------------------
+// Fixed-bucket histogram with cumulative OpenMetrics export. Bucket bounds are
+// upper bounds (inclusive) in the caller's unit; a final +Inf bucket is
+// implicit. Updates take a short lock and a bounded bucket search.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Histogram {
+public:
+    explicit Histogram(std::vector<uint64_t> upperBounds)
+        : bounds_(std::move(upperBounds)), counts_(bounds_.size() + 1, 0) {
+        std::sort(bounds_.begin(), bounds_.end());
+    }
+
+    void record(uint64_t value) {
+        size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++counts_[bucket];
+        ++count_;
+        sum_ += value;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = 0;
+        sum_ = 0;
+    }
+
+    uint64_t count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    // Compact "le=count" listing (non-cumulative) for the control socket.
+    void appendText(std::string& out, const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        char buf[96];
+        out += name;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            if (i < bounds_.size()) {
+                snprintf(buf, sizeof(buf), " %" PRIu64 ":%" PRIu64, bounds_[i], counts_[i]);
+            } else {
+                snprintf(buf, sizeof(buf), " inf:%" PRIu64, counts_[i]);
+            }
+            out += buf;
+        }
+        snprintf(buf, sizeof(buf), " count=%" PRIu64 " sum=%" PRIu64 "\n", count_, sum_);
+        out += buf;
+    }
+
+    // OpenMetrics histogram samples. `scale` converts the stored unit (e.g. 1e-3 for ms -> s).
+    void appendOpenMetrics(std::string& out, const std::string& name, const std::string& labels,
+                           double scale) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string sep = labels.empty() ? "" : ",";
+        char buf[256];
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            cumulative += counts_[i];
+            if (i < bounds_.size()) {
+                snprintf(buf, sizeof(buf), "%s_bucket{%s%sle=\"%g\"} %" PRIu64 "\n", name.c_str(),
+                         labels.c_str(), sep.c_str(), bounds_[i] * scale, cumulative);
+            } else {
+                snprintf(buf, sizeof(buf), "%s_bucket{%s%sle=\"+Inf\"} %" PRIu64 "\n", name.c_str(),
+                         labels.c_str(), sep.c_str(), cumulative);
+            }
+            out += buf;
+        }
+        const char* open = labels.empty() ? "" : "{";
+        const char* close = labels.empty() ? "" : "}";
+        snprintf(buf, sizeof(buf), "%s_count%s%s%s %" PRIu64 "\n%s_sum%s%s%s %g\n", name.c_str(), open,
+                 labels.c_str(), close, count_, name.c_str(), open, labels.c_str(), close, sum_ * scale);
+        out += buf;
+    }
+
+private:
+    std::vector<uint64_t> bounds_;
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    mutable std::mutex mutex_;
+};
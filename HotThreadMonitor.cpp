@@ -0,0 +1,234 @@
+// -----------------------------------------------------------------------------
+// HotThreadMonitor.cpp
+//
+// Per-thread CPU time of the top-app cpuset: slow rescan of the task list,
+// per-tick sampling of the hottest threads through persistent descriptors.
+// -----------------------------------------------------------------------------
+
+#include "HotThreadMonitor.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr char kTopAppTasks[] = "/dev/cpuset/top-app/tasks";
+} // namespace
+
+HotThreadMonitor::HotThreadMonitor(const std::string& name, unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks) {
+    long hz = sysconf(_SC_CLK_TCK);
+    ticksPerSecond_ = hz > 0 ? static_cast<double>(hz) : 100.0;
+    HOTLOGD("HotThreadMonitor: Initializing '%s' every %u tick(s)", name.c_str(), periodTicks);
+}
+
+HotThreadMonitor::~HotThreadMonitor() {
+    untrackAll();
+}
+
+std::string HotThreadMonitor::statPath(pid_t tid) {
+    // /proc/<tid> resolves for any thread, not only group leaders.
+    return "/proc/" + std::to_string(tid) + "/task/" + std::to_string(tid) + "/stat";
+}
+
+bool HotThreadMonitor::readTaskList(const char* path, std::vector<pid_t>& tids) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    std::string text;
+    char buffer[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, buffer, sizeof(buffer))) > 0) text.append(buffer, bytes_read);
+    close(fd);
+    if (bytes_read < 0) return false;
+
+    tids.clear();
+    const char* p = text.c_str();
+    while (*p) {
+        char* endptr = nullptr;
+        long tid = std::strtol(p, &endptr, 10);
+        if (endptr == p) break;
+        if (tid > 0) tids.push_back(static_cast<pid_t>(tid));
+        p = endptr;
+        while (*p == '\n') ++p;
+    }
+    return true;
+}
+
+bool HotThreadMonitor::parseStat(const char* buffer, unsigned long long& ticks, std::string* comm) {
+    // comm may contain spaces and parentheses: fields resume after the last ')'.
+    const char* lparen = strchr(buffer, '(');
+    const char* rparen = strrchr(buffer, ')');
+    if (!lparen || !rparen || rparen < lparen) return false;
+    if (comm) comm->assign(lparen + 1, rparen - lparen - 1);
+
+    // After ')': state (field 3) ... utime (14), stime (15).
+    const char* p = rparen + 1;
+    for (int field = 3; field < 14; ++field) {
+        p = strchr(p + 1, ' ');
+        if (!p) return false;
+    }
+    char* endptr = nullptr;
+    unsigned long long utime = std::strtoull(p + 1, &endptr, 10);
+    if (endptr == p + 1) return false;
+    unsigned long long stime = std::strtoull(endptr + 1, &endptr, 10);
+    ticks = utime + stime;
+    return true;
+}
+
+bool HotThreadMonitor::readStat(int fd, unsigned long long& ticks, std::string* comm) {
+    char buffer[512];
+    ssize_t bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (bytes_read <= 0) return false; // ESRCH once the thread has exited
+    buffer[bytes_read] = '\0';
+    return parseStat(buffer, ticks, comm);
+}
+
+int HotThreadMonitor::init() {
+    std::vector<pid_t> tids;
+    if (!readTaskList(kTopAppTasks, tids)) {
+        HOTLOGE("HotThreadMonitor: Cannot read %s: %s", kTopAppTasks, std::strerror(errno));
+        return -1;
+    }
+    HOTLOGD("HotThreadMonitor: %zu top-app thread(s)", tids.size());
+    return 0;
+}
+
+void HotThreadMonitor::untrackAll() {
+    std::lock_guard<std::mutex> lock(usageMutex_);
+    for (auto& entry : tracked_) {
+        if (entry.second.fd >= 0) close(entry.second.fd);
+    }
+    tracked_.clear();
+}
+
+void HotThreadMonitor::rescan(std::chrono::steady_clock::time_point now) {
+    std::vector<pid_t> tids;
+    if (!readTaskList(kTopAppTasks, tids)) {
+        HOTLOGE("HotThreadMonitor: Cannot read %s: %s", kTopAppTasks, std::strerror(errno));
+        nextScanTs_ = now + kRescanPeriod;
+        return;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - lastScanTs_).count();
+    bool haveBaseline = !scanTicks_.empty() && elapsed > 0.0;
+    std::map<pid_t, unsigned long long> ticksNow;
+    std::vector<std::pair<double, pid_t>> ranked;
+    for (pid_t tid : tids) {
+        int fd = open(statPath(tid).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        unsigned long long ticks = 0;
+        bool ok = readStat(fd, ticks, nullptr);
+        close(fd);
+        if (!ok) continue;
+        ticksNow[tid] = ticks;
+        auto last = scanTicks_.find(tid);
+        if (!haveBaseline || last == scanTicks_.end() || ticks < last->second) continue;
+        double percent = static_cast<double>(ticks - last->second) * 100.0 / (ticksPerSecond_ * elapsed);
+        if (percent >= kCandidatePercent) ranked.emplace_back(percent, tid);
+    }
+    scanTicks_.swap(ticksNow);
+    lastScanTs_ = now;
+    // The first scan only sets the baseline: rank again on the next tick.
+    nextScanTs_ = haveBaseline ? now + kRescanPeriod : now;
+
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    if (ranked.size() > kMaxTracked) ranked.resize(kMaxTracked);
+
+    std::lock_guard<std::mutex> lock(usageMutex_);
+    // Drop threads that left the top set, unless they are saturated right now.
+    for (auto it = tracked_.begin(); it != tracked_.end();) {
+        bool keep = it->second.saturated ||
+                    std::any_of(ranked.begin(), ranked.end(), [&](const auto& r) { return r.second == it->first; });
+        if (keep) {
+            ++it;
+            continue;
+        }
+        close(it->second.fd);
+        it = tracked_.erase(it);
+    }
+    for (const auto& [percent, tid] : ranked) {
+        if (tracked_.count(tid) || tracked_.size() >= kMaxTracked) continue;
+        Tracked entry;
+        entry.fd = open(statPath(tid).c_str(), O_RDONLY | O_CLOEXEC);
+        if (entry.fd < 0) continue;
+        if (!readStat(entry.fd, entry.lastTicks, &entry.usage.comm)) {
+            close(entry.fd);
+            continue;
+        }
+        entry.usage.tid = tid;
+        entry.usage.percent = percent;
+        tracked_.emplace(tid, std::move(entry));
+    }
+    HOTLOGD("HotThreadMonitor: Rescanned %zu thread(s), tracking %zu", tids.size(), tracked_.size());
+}
+
+void HotThreadMonitor::sampleOnce() {
+    auto now = std::chrono::steady_clock::now();
+    if (consumeReset()) {
+        // Paused while open: baselines and sustain windows are stale.
+        untrackAll();
+        scanTicks_.clear();
+        nextScanTs_ = {};
+        hot_ = 0;
+        hottestPercent_ = 0.0;
+    }
+
+    double elapsed = std::chrono::duration<double>(now - lastSampleTs_).count();
+    lastSampleTs_ = now;
+    double hottest = 0.0;
+    bool hot = false;
+    {
+        std::lock_guard<std::mutex> lock(usageMutex_);
+        for (auto it = tracked_.begin(); it != tracked_.end();) {
+            Tracked& entry = it->second;
+            unsigned long long ticks = 0;
+            if (!readStat(entry.fd, ticks, nullptr)) {
+                close(entry.fd);
+                it = tracked_.erase(it);
+                continue;
+            }
+            if (elapsed > 0.0 && ticks >= entry.lastTicks) {
+                entry.usage.percent = static_cast<double>(ticks - entry.lastTicks) * 100.0 / (ticksPerSecond_ * elapsed);
+            }
+            entry.lastTicks = ticks;
+
+            if (entry.usage.percent >= kSaturatedPercent) {
+                if (!entry.saturated) {
+                    entry.saturated = true;
+                    entry.saturatedSince = now;
+                }
+                entry.usage.saturatedMs =
+                        std::chrono::duration_cast<std::chrono::milliseconds>(now - entry.saturatedSince).count();
+                hot = hot || now - entry.saturatedSince >= kSustainedWindow;
+            } else {
+                entry.saturated = false;
+                entry.usage.saturatedMs = 0;
+            }
+            hottest = std::max(hottest, entry.usage.percent);
+            ++it;
+        }
+    }
+    // Rescan after sampling so that newly tracked threads get a full interval.
+    if (now >= nextScanTs_) rescan(now);
+
+    hottestPercent_ = hottest;
+    int hotValue = hot ? 1 : 0;
+    if (hotValue != hot_) {
+        HOTLOGI("HotThreadMonitor: hot thread %d -> %d (hottest %.1f%% of one core)", hot_, hotValue, hottest);
+        hot_ = hotValue;
+        onValueChanged(static_cast<int>(hottest), hotValue);
+    }
+}
+
+std::vector<HotThreadMonitor::ThreadUsage> HotThreadMonitor::getTracked() const {
+    std::vector<ThreadUsage> usage;
+    {
+        std::lock_guard<std::mutex> lock(usageMutex_);
+        for (const auto& entry : tracked_) usage.push_back(entry.second.usage);
+    }
+    std::sort(usage.begin(), usage.end(), [](const auto& a, const auto& b) { return a.percent > b.percent; });
+    return usage;
+}
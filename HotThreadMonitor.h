@@ -0,0 +1,103 @@
+#ifndef HOTTHREADMONITOR_H
+#define HOTTHREADMONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include <android/log.h>
+
+#include "PeriodicMonitor.h"
+
+// Default sampler period is 1 base tick: a saturated thread must be seen within the sustain window.
+static constexpr unsigned g_hotThreadSamplerPeriodTicksDefault = 1;
+
+// Logging macros for HotThreadMonitor
+#define HOT_THREAD_LOG_TAG "SocDaemon_HotThreadMonitor"
+#define HOTLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, HOT_THREAD_LOG_TAG, __VA_ARGS__)
+#define HOTLOGI(...) __android_log_print(ANDROID_LOG_INFO, HOT_THREAD_LOG_TAG, __VA_ARGS__)
+#define HOTLOGE(...) __android_log_print(ANDROID_LOG_ERROR, HOT_THREAD_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Detects a single top-app thread saturating one (contained) core.
+ *
+ * Aggregate utilization can stay low while one render/UI thread is pinned at
+ * 100% of an E-core. The monitor works in two tiers:
+ *  - Every kRescanPeriod it reads /dev/cpuset/top-app/tasks and does a one-shot
+ *    read of /proc/<tid>/task/<tid>/stat for every thread, ranking them by CPU
+ *    time since the previous rescan.
+ *  - The kMaxTracked hottest threads above kCandidatePercent keep a persistent
+ *    stat descriptor and are sampled with pread on every tick.
+ *
+ * A thread is hot once it has stayed at or above kSaturatedPercent of one core
+ * for kSustainedWindow. The alert is raised only on edges of "some thread is
+ * hot" and carries (hottest thread utilization % of one core, hot).
+ */
+class HotThreadMonitor : public PeriodicMonitor {
+public:
+    struct ThreadUsage {
+        pid_t tid = 0;
+        std::string comm;
+        double percent = 0.0;     // of one core, last interval
+        long long saturatedMs = 0; // time continuously at or above kSaturatedPercent
+    };
+
+    /**
+     * @param name Monitor name used for alerts.
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    explicit HotThreadMonitor(const std::string& name, unsigned periodTicks = g_hotThreadSamplerPeriodTicksDefault);
+
+    ~HotThreadMonitor() override;
+
+    // Checks that the top-app task list is readable. Returns -1 otherwise.
+    int init() override;
+
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
+
+    // Thread IDs listed in a cgroup "tasks" file.
+    static bool readTaskList(const char* path, std::vector<pid_t>& tids);
+
+    // Threads currently tracked, hottest first (copy).
+    std::vector<ThreadUsage> getTracked() const;
+    double getHottestPercent() const { return hottestPercent_.load(); }
+
+private:
+    struct Tracked {
+        int fd = -1;
+        unsigned long long lastTicks = 0;
+        std::chrono::steady_clock::time_point saturatedSince{};
+        bool saturated = false;
+        ThreadUsage usage;
+    };
+
+    void rescan(std::chrono::steady_clock::time_point now);
+    void untrackAll();
+    // utime + stime in clock ticks, and the comm field, from one stat read.
+    static bool parseStat(const char* buffer, unsigned long long& ticks, std::string* comm);
+    static bool readStat(int fd, unsigned long long& ticks, std::string* comm);
+    static std::string statPath(pid_t tid);
+
+    double ticksPerSecond_;
+
+    std::map<pid_t, Tracked> tracked_;             // persistent descriptors, clock thread only
+    std::map<pid_t, unsigned long long> scanTicks_; // CPU time at the previous rescan
+    std::chrono::steady_clock::time_point lastScanTs_{};
+    std::chrono::steady_clock::time_point nextScanTs_{};
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    int hot_ = 0;
+
+    mutable std::mutex usageMutex_; // guards Tracked::usage for readers off the clock thread
+    std::atomic<double> hottestPercent_{0.0};
+
+    static constexpr double kSaturatedPercent = 90.0;  // of one core
+    static constexpr double kCandidatePercent = 25.0;  // minimum to be tracked per tick
+    static constexpr size_t kMaxTracked = 8;
+    static constexpr std::chrono::seconds kSustainedWindow{3};
+    static constexpr std::chrono::seconds kRescanPeriod{10};
+};
+#endif // HOTTHREADMONITOR_H
@@ -0,0 +1,220 @@
+// -----------------------------------------------------------------------------
+// LoadForecaster.cpp
+//
+// Holt linear-trend forecast of contained-CPU and system load from /proc/stat.
+// -----------------------------------------------------------------------------
+
+#include "LoadForecaster.h"
+#include "ThreadPlacement.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr char kProcStat[] = "/proc/stat";
+const char* const kSeriesNames[LoadForecaster::kSeriesCount] = {"contained", "system"};
+
+// "cpu[N] user nice system idle iowait irq softirq steal ..." (guest time is
+// already part of user). Returns false on a malformed line.
+bool parseCpuLine(const char* p, unsigned long long& busy, unsigned long long& total) {
+    unsigned long long fields[8] = {};
+    char* endptr = nullptr;
+    int n = 0;
+    for (; n < 8; ++n) {
+        fields[n] = std::strtoull(p, &endptr, 10);
+        if (endptr == p) break;
+        p = endptr;
+    }
+    if (n < 4) return false;
+    total = 0;
+    for (int i = 0; i < n; ++i) total += fields[i];
+    busy = total - fields[3] - fields[4];
+    return true;
+}
+} // namespace
+
+LoadForecaster::LoadForecaster(const std::string& name, const std::string& containedCpus, unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks) {
+    long cpus = std::clamp(sysconf(_SC_NPROCESSORS_CONF), 1L, static_cast<long>(CPU_SETSIZE));
+    cpu_set_t set;
+    if (!ThreadPlacement::parseCpuList(containedCpus, &set)) {
+        FCSTLOGE("LoadForecaster: Invalid contained CPU list '%s', using all CPUs", containedCpus.c_str());
+        CPU_ZERO(&set);
+        for (long cpu = 0; cpu < cpus; ++cpu) CPU_SET(cpu, &set);
+    }
+    contained_.assign(CPU_SETSIZE, false);
+    long containedCount = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        contained_[cpu] = CPU_ISSET(cpu, &set);
+        if (contained_[cpu] && cpu < cpus) containedCount++;
+    }
+    // Everything runs on the contained CPUs in containment, so the system saturates
+    // at their share of it (the same point sysload_high_threshold is tuned to).
+    capacity_[kContained] = kCapacityPercent;
+    capacity_[kSystem] = kCapacityPercent * std::max(containedCount, 1L) / cpus;
+    FCSTLOGD("LoadForecaster: Initializing '%s', capacity %.1f%% contained / %.1f%% system", name.c_str(),
+             capacity_[kContained], capacity_[kSystem]);
+}
+
+LoadForecaster::~LoadForecaster() {
+    if (statFd_ >= 0) close(statFd_);
+}
+
+const char* LoadForecaster::seriesName(int series) {
+    return series >= 0 && series < kSeriesCount ? kSeriesNames[series] : "unknown";
+}
+
+int LoadForecaster::init() {
+    statFd_ = open(kProcStat, O_RDONLY | O_CLOEXEC);
+    if (statFd_ < 0) {
+        FCSTLOGE("LoadForecaster: Failed to open %s: %s", kProcStat, std::strerror(errno));
+        return -1;
+    }
+    CpuTimes system, contained;
+    if (!readStat(system, contained)) {
+        FCSTLOGE("LoadForecaster: No contained CPU found in %s", kProcStat);
+        close(statFd_);
+        statFd_ = -1;
+        return -1;
+    }
+    return 0;
+}
+
+bool LoadForecaster::readStat(CpuTimes& system, CpuTimes& contained) {
+    if (statFd_ < 0) return false;
+    // The per-CPU lines come first; the interrupt counters after them are not needed.
+    static constexpr size_t kBufferSize = 16384;
+    std::vector<char> buffer(kBufferSize);
+    ssize_t bytes_read = pread(statFd_, buffer.data(), kBufferSize - 1, 0);
+    if (bytes_read <= 0) return false;
+    buffer[bytes_read] = '\0';
+
+    system = CpuTimes();
+    contained = CpuTimes();
+    bool haveSystem = false, haveContained = false;
+    for (char* line = buffer.data(); line && !strncmp(line, "cpu", 3);) {
+        unsigned long long busy = 0, total = 0;
+        if (line[3] == ' ') {
+            haveSystem = parseCpuLine(line + 3, system.busy, system.total);
+        } else {
+            char* endptr = nullptr;
+            long cpu = std::strtol(line + 3, &endptr, 10);
+            if (endptr != line + 3 && cpu >= 0 && cpu < static_cast<long>(contained_.size()) && contained_[cpu] &&
+                parseCpuLine(endptr, busy, total)) {
+                contained.busy += busy;
+                contained.total += total;
+                haveContained = true;
+            }
+        }
+        line = strchr(line, '\n');
+        if (line) ++line;
+    }
+    return haveSystem && haveContained;
+}
+
+void LoadForecaster::Holt::update(double value, double dt) {
+    lastDt = dt;
+    if (samples++ == 0) {
+        level = value;
+        trend = 0.0;
+        return;
+    }
+    double expected = level + trend * dt;
+    double error = value - expected;
+    errorVar = samples == 2 ? error * error : (1.0 - kErrorGain) * errorVar + kErrorGain * error * error;
+    double newLevel = kAlpha * value + (1.0 - kAlpha) * expected;
+    trend = kBeta * (newLevel - level) / dt + (1.0 - kBeta) * trend;
+    level = newLevel;
+}
+
+LoadForecaster::Forecast LoadForecaster::forecastLocked(int series) const {
+    const Holt& holt = holt_[series];
+    Forecast forecast;
+    forecast.current = current_[series];
+    forecast.capacity = capacity_[series];
+    forecast.samples = holt.samples;
+    if (holt.samples == 0) return forecast;
+    double horizonS = std::chrono::duration<double>(kHorizon).count();
+    forecast.trendPerS = holt.trend;
+    // Not capped at 100: past saturation it still reflects the demand the trend implies.
+    forecast.predicted = std::max(holt.level + holt.trend * horizonS, 0.0);
+    forecast.bound = kConfidenceZ * std::sqrt(holt.errorVar) * std::sqrt(std::max(1.0, horizonS / holt.lastDt));
+    return forecast;
+}
+
+void LoadForecaster::sampleOnce() {
+    if (consumeReset()) {
+        // Paused while open: the trend and baselines describe another state.
+        haveLast_ = false;
+        predicted_ = 0;
+        std::lock_guard<std::mutex> lock(forecastMutex_);
+        for (int s = 0; s < kSeriesCount; ++s) {
+            holt_[s].reset();
+            current_[s] = -1.0;
+        }
+    }
+    auto now = std::chrono::steady_clock::now();
+    CpuTimes times[kSeriesCount];
+    if (!readStat(times[kSystem], times[kContained])) {
+        FCSTLOGE("LoadForecaster: Failed to read %s", kProcStat);
+        return;
+    }
+    double dt = std::chrono::duration<double>(now - lastSampleTs_).count();
+    bool first = !haveLast_;
+    CpuTimes last[kSeriesCount] = {last_[kContained], last_[kSystem]};
+    last_[kContained] = times[kContained];
+    last_[kSystem] = times[kSystem];
+    lastSampleTs_ = now;
+    haveLast_ = true;
+    if (first || dt <= 0.0) return;
+
+    Forecast forecasts[kSeriesCount];
+    {
+        std::lock_guard<std::mutex> lock(forecastMutex_);
+        for (int s = 0; s < kSeriesCount; ++s) {
+            if (times[s].total <= last[s].total || times[s].busy < last[s].busy) continue;
+            double load = 100.0 * (times[s].busy - last[s].busy) / (times[s].total - last[s].total);
+            current_[s] = std::min(load, 100.0);
+            holt_[s].update(current_[s], dt);
+        }
+        for (int s = 0; s < kSeriesCount; ++s) forecasts[s] = forecastLocked(s);
+    }
+    FCSTLOGD("LoadForecaster: contained %.1f%% -> %.1f%% +/- %.1f, system %.1f%% -> %.1f%% +/- %.1f",
+             forecasts[kContained].current, forecasts[kContained].predicted, forecasts[kContained].bound,
+             forecasts[kSystem].current, forecasts[kSystem].predicted, forecasts[kSystem].bound);
+
+    int crossing = -1;
+    bool clear = true;
+    for (int s = 0; s < kSeriesCount; ++s) {
+        const Forecast& f = forecasts[s];
+        if (f.samples < kMinSamples) {
+            clear = false;
+            continue;
+        }
+        if (crossing < 0 && f.predicted - f.bound >= f.capacity) crossing = s;
+        if (f.predicted + f.bound >= f.capacity) clear = false;
+    }
+    int predicted = predicted_;
+    if (!predicted_ && crossing >= 0) predicted = 1;
+    if (predicted_ && clear) predicted = 0;
+    if (predicted != predicted_) {
+        int series = crossing >= 0 ? crossing : kContained;
+        const Forecast& f = forecasts[series];
+        FCSTLOGI("LoadForecaster: saturation predicted %d -> %d (%s %.1f%% -> %.1f%% +/- %.1f in %lldms, capacity "
+                 "%.1f%%)",
+                 predicted_, predicted, seriesName(series), f.current, f.predicted, f.bound,
+                 static_cast<long long>(kHorizon.count()), f.capacity);
+        predicted_ = predicted;
+        onValueChanged(static_cast<int>(std::lround(f.predicted * 100.0)), predicted);
+    }
+}
+
+LoadForecaster::Forecast LoadForecaster::getForecast(Series series) const {
+    std::lock_guard<std::mutex> lock(forecastMutex_);
+    return forecastLocked(series);
+}
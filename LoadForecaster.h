@@ -0,0 +1,116 @@
+#ifndef LOADFORECASTER_H
+#define LOADFORECASTER_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <android/log.h>
+
+#include "PeriodicMonitor.h"
+
+// Default sampler period is 1 base tick: the forecast horizon is only a few ticks.
+static constexpr unsigned g_loadForecastSamplerPeriodTicksDefault = 1;
+
+// Logging macros for LoadForecaster
+#define LOAD_FORECAST_LOG_TAG "SocDaemon_LoadForecaster"
+#define FCSTLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOAD_FORECAST_LOG_TAG, __VA_ARGS__)
+#define FCSTLOGI(...) __android_log_print(ANDROID_LOG_INFO, LOAD_FORECAST_LOG_TAG, __VA_ARGS__)
+#define FCSTLOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOAD_FORECAST_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Short-horizon forecast of contained-core and system load.
+ *
+ * Every tick the monitor reads /proc/stat once (persistent descriptor) and
+ * derives the busy share of the contained CPUs and of the whole system. Each
+ * series feeds a Holt linear-trend filter (level + trend per second, for
+ * irregular intervals) that also tracks the variance of its one-step error:
+ *
+ *   predicted(h) = level + trend * h
+ *   bound(h)     = kConfidenceZ * sigma * sqrt(max(1, h / dt))
+ *
+ * The capacity of the contained CPUs is kCapacityPercent of them, and the
+ * same share of the system (the contained CPUs' fraction of all CPUs) for the
+ * system series. The alert rises once the lower bound of either forecast at
+ * kHorizon reaches its capacity, i.e. saturation is predicted with confidence,
+ * and clears when both upper bounds are back below it. It carries (predicted
+ * load in 1/100 % of the series that crossed, predicted).
+ */
+class LoadForecaster : public PeriodicMonitor {
+public:
+    enum Series : int { kContained = 0, kSystem, kSeriesCount };
+
+    struct Forecast {
+        double current = -1.0;   // last observed load (%), -1 before the first interval
+        double trendPerS = 0.0;  // %/s
+        double predicted = -1.0; // at kHorizon
+        double bound = 0.0;      // half-width of the confidence interval
+        double capacity = 0.0;   // threshold the lower bound is compared against
+        unsigned samples = 0;    // since the last reset
+    };
+
+    /**
+     * @param name Monitor name used for alerts.
+     * @param containedCpus CPU list the foreground groups are confined to in containment, e.g. "4-7".
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    LoadForecaster(const std::string& name, const std::string& containedCpus,
+                   unsigned periodTicks = g_loadForecastSamplerPeriodTicksDefault);
+
+    ~LoadForecaster() override;
+
+    // Opens /proc/stat. Returns -1 if it cannot be read.
+    int init() override;
+
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
+
+    Forecast getForecast(Series series) const;
+    static const char* seriesName(int series);
+
+    static constexpr std::chrono::milliseconds kHorizon{2000};
+
+private:
+    // Holt's linear trend on an irregularly sampled series.
+    struct Holt {
+        double level = 0.0;
+        double trend = 0.0;     // per second
+        double errorVar = 0.0;  // EWMA of the squared one-step error
+        double lastDt = 1.0;    // s
+        unsigned samples = 0;
+
+        void update(double value, double dt);
+        void reset() { *this = Holt(); }
+    };
+
+    struct CpuTimes {
+        unsigned long long busy = 0;
+        unsigned long long total = 0;
+    };
+
+    // Aggregate and contained-CPU times from one /proc/stat read.
+    bool readStat(CpuTimes& system, CpuTimes& contained);
+    Forecast forecastLocked(int series) const;
+
+    std::vector<bool> contained_; // indexed by CPU number
+    double capacity_[kSeriesCount];
+    int statFd_ = -1;
+
+    // Clock thread only
+    CpuTimes last_[kSeriesCount];
+    bool haveLast_ = false;
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    int predicted_ = 0;
+
+    mutable std::mutex forecastMutex_; // guards holt_ and current_ for readers off the clock thread
+    Holt holt_[kSeriesCount];
+    double current_[kSeriesCount] = {-1.0, -1.0};
+
+    static constexpr double kAlpha = 0.6;          // level smoothing
+    static constexpr double kBeta = 0.4;           // trend smoothing
+    static constexpr double kErrorGain = 0.2;      // error variance smoothing
+    static constexpr double kConfidenceZ = 1.0;    // one-sided 84%
+    static constexpr double kCapacityPercent = 90.0;
+    static constexpr unsigned kMinSamples = 3;     // before a forecast is trusted
+};
+#endif // LOADFORECASTER_H
@@ -7,7 +7,11 @@
  *
  */
 #include <iostream>
+#include <cstdio>
 #include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cctype>
 #include <algorithm>
 #include "SocDaemon.h"
 
@@ -17,6 +21,7 @@ int main(int argc, char* argv[]) {
     bool sendGfxHint = false;
     std::string socHint;
     int notificationDelay = -1; // Default: not set
+    SocDaemonOptions options;
 
      // Parse command line arguments for --sendHint, --sochint, --notification-delay, and --help
     for (int i = 1; i < argc; ++i) {
@@ -60,7 +65,7 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--socHint") {
             if (i + 1 < argc) {
                 socHint = argv[i + 1];
-                if (socHint == "wlt" || socHint == "swlt" || socHint == "hfi") {
+                if (socHint == "wlt" || socHint == "swlt" || socHint == "hfi" || socHint == "fusion") {
                     ALOGI("--sochint set to %s", socHint.c_str());
                 } else {
                     std::cout << "Invalid value for --sochint: " << socHint.c_str() << std::endl;
@@ -92,23 +97,378 @@ int main(int argc, char* argv[]) {
                 std::cout << "--notification-delay requires a value" << std::endl;
                 exit(1);
             }
+        } else if (arg == "--sample-tick" || arg == "--timer-slack") {
+            if (i + 1 < argc) {
+                std::string valueStr = argv[i + 1];
+                bool valid = !valueStr.empty() && valueStr.size() < 10 &&
+                             std::all_of(valueStr.begin(), valueStr.end(), ::isdigit);
+                if (!valid) {
+                    std::cout << "Invalid value for " << arg << ": " << valueStr << std::endl;
+                    exit(1);
+                }
+                int value = std::stoi(valueStr);
+                if (arg == "--sample-tick") {
+                    if (value <= 0) {
+                        std::cout << "--sample-tick must be positive" << std::endl;
+                        exit(1);
+                    }
+                    options.sampleTick = std::chrono::milliseconds(value);
+                } else {
+                    options.timerSlack = std::chrono::microseconds(value);
+                }
+                ALOGI("%s set to %d", arg.c_str(), value);
+                ++i; // Skip the value
+            } else {
+                std::cout << arg << " requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--self-cpus" || arg == "--sampler-sched" || arg == "--policy-nice" ||
+                   arg == "--cgroup" || arg == "--cpu-max") {
+            if (i + 1 >= argc) {
+                std::cout << arg << " requires a value" << std::endl;
+                exit(1);
+            }
+            std::string value = argv[i + 1];
+            auto isInt = [](const std::string& v) {
+                size_t start = (!v.empty() && v[0] == '-') ? 1 : 0;
+                return v.size() > start && v.size() < 4 + start &&
+                       std::all_of(v.begin() + start, v.end(), ::isdigit);
+            };
+            if (arg == "--self-cpus") {
+                cpu_set_t set;
+                if (!ThreadPlacement::parseCpuList(value, &set)) {
+                    std::cout << "Invalid CPU list for --self-cpus: " << value << std::endl;
+                    exit(1);
+                }
+                options.placement.cpus = value;
+            } else if (arg == "--sampler-sched") {
+                if (value == "idle") {
+                    options.placement.samplerIdle = true;
+                } else if (isInt(value)) {
+                    options.placement.samplerIdle = false;
+                    options.placement.samplerNice = std::stoi(value);
+                } else {
+                    std::cout << "Invalid value for --sampler-sched: " << value << ". Use idle or a nice value." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--policy-nice") {
+                if (!isInt(value)) {
+                    std::cout << "Invalid value for --policy-nice: " << value << std::endl;
+                    exit(1);
+                }
+                options.placement.policyNice = std::stoi(value);
+            } else if (arg == "--cgroup") {
+                options.placement.cgroupPath = value;
+            } else {
+                // <quota_us>[,<period_us>] -> "quota period" as written to cpu.max
+                std::string quota = value.substr(0, value.find(','));
+                std::string period = value.find(',') == std::string::npos ? "100000" : value.substr(value.find(',') + 1);
+                auto digits = [](const std::string& v) {
+                    return !v.empty() && std::all_of(v.begin(), v.end(), ::isdigit);
+                };
+                if (!digits(quota) || !digits(period)) {
+                    std::cout << "Invalid value for --cpu-max: " << value << ". Use <quota_us>[,<period_us>]" << std::endl;
+                    exit(1);
+                }
+                options.placement.cpuMax = quota + " " + period;
+            }
+            ALOGI("%s set to %s", arg.c_str(), value.c_str());
+            ++i; // Skip the value
+        } else if (arg == "--state-file") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                options.stateFile = (value == "none") ? std::string() : value;
+                ALOGI("--state-file set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--state-file requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--state-max-age") {
+            if (i + 1 < argc) {
+                std::string ageStr = argv[i + 1];
+                bool valid = !ageStr.empty() && ageStr.size() < 8 && std::all_of(ageStr.begin(), ageStr.end(), ::isdigit);
+                if (!valid) {
+                    std::cout << "Invalid value for --state-max-age: " << ageStr << std::endl;
+                    exit(1);
+                }
+                options.stateMaxAge = std::chrono::seconds(std::stoi(ageStr));
+                ALOGI("--state-max-age set to %s", ageStr.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--state-max-age requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--ctl-socket") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                options.controlSocket = (value == "none") ? std::string() : value;
+                ALOGI("--ctl-socket set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--ctl-socket requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--shared-state") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                options.sharedStateFile = (value == "none") ? std::string() : value;
+                ALOGI("--shared-state set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--shared-state requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--wlt-predict") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (value == "true") {
+                    options.wltPredictor = true;
+                } else if (value == "false") {
+                    options.wltPredictor = false;
+                } else {
+                    std::cout << "Invalid value for --wlt-predict: " << value << ". Use true or false." << std::endl;
+                    exit(1);
+                }
+                ALOGI("--wlt-predict set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--wlt-predict requires a value (true or false)" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--hint-budget") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                // strtoul accepts a sign and wraps "-1" to ULONG_MAX, so require
+                // each field to start with a digit and bound it explicitly.
+                auto parseField = [](const char* s, const char** end, unsigned long max) -> long {
+                    if (!isdigit(static_cast<unsigned char>(*s))) {
+                        return -1;
+                    }
+                    errno = 0;
+                    char* e = nullptr;
+                    unsigned long v = strtoul(s, &e, 10);
+                    *end = e;
+                    return (errno != 0 || v > max) ? -1 : static_cast<long>(v);
+                };
+                const char* end = value.c_str();
+                long toggles = parseField(end, &end, 1000);
+                long windowSec = -1;
+                if (toggles >= 0 && *end == '/') {
+                    windowSec = parseField(end + 1, &end, 86400);
+                }
+                if (toggles < 0 || windowSec <= 0 || *end != '\0') {
+                    std::cout << "Invalid value for --hint-budget: " << value << ". Use <toggles>/<window_s> (toggles 0-1000, window 1-86400)" << std::endl;
+                    exit(1);
+                }
+                options.hintGovernor.maxToggles = static_cast<unsigned>(toggles);
+                options.hintGovernor.window = std::chrono::seconds(windowSec);
+                ALOGI("--hint-budget set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--hint-budget requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--hint-min-hold") {
+            if (i + 1 < argc) {
+                std::string holdStr = argv[i + 1];
+                bool valid = !holdStr.empty() && holdStr.size() < 8 && std::all_of(holdStr.begin(), holdStr.end(), ::isdigit);
+                if (!valid) {
+                    std::cout << "Invalid value for --hint-min-hold: " << holdStr << std::endl;
+                    exit(1);
+                }
+                options.hintGovernor.minHold = std::chrono::milliseconds(std::stoi(holdStr));
+                ALOGI("--hint-min-hold set to %s", holdStr.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--hint-min-hold requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--fusion-weights") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!FusionConfig::parseWeights(value, options.fusion)) {
+                    std::cout << "Invalid value for --fusion-weights: " << value
+                              << ". Use e.g. wlt=3,swlt=1,hfi=2,load=2,slope=1,gpu=1" << std::endl;
+                    exit(1);
+                }
+                ALOGI("--fusion-weights set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--fusion-weights requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--fusion-bands") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!FusionConfig::parseBands(value, options.fusion)) {
+                    std::cout << "Invalid value for --fusion-bands: " << value
+                              << ". Use <enter>,<exit>[,<min_confidence>] with 0 <= exit < enter <= 1" << std::endl;
+                    exit(1);
+                }
+                ALOGI("--fusion-bands set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--fusion-bands requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--policy-file") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                options.policyFile = (value == "none") ? std::string() : value;
+                ALOGI("--policy-file set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--policy-file requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--shadow-weights") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!FusionConfig::parseWeights(value, options.shadowFusion)) {
+                    std::cout << "Invalid value for --shadow-weights: " << value
+                              << ". Use e.g. wlt=3,swlt=1,hfi=2,load=2,slope=1,gpu=1" << std::endl;
+                    exit(1);
+                }
+                options.shadowPolicy = true;
+                ALOGI("--shadow-weights set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--shadow-weights requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--shadow-bands") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!FusionConfig::parseBands(value, options.shadowFusion)) {
+                    std::cout << "Invalid value for --shadow-bands: " << value
+                              << ". Use <enter>,<exit>[,<min_confidence>] with 0 <= exit < enter <= 1" << std::endl;
+                    exit(1);
+                }
+                options.shadowPolicy = true;
+                ALOGI("--shadow-bands set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--shadow-bands requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--contained-cpus") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                cpu_set_t set;
+                if (!ThreadPlacement::parseCpuList(value, &set)) {
+                    std::cout << "Invalid CPU list for --contained-cpus: " << value << std::endl;
+                    exit(1);
+                }
+                options.containedCpus = value;
+                ALOGI("--contained-cpus set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--contained-cpus requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--hal-deadline") {
+            if (i + 1 < argc) {
+                std::string valueStr = argv[i + 1];
+                bool valid = !valueStr.empty() && valueStr.size() < 7 &&
+                             std::all_of(valueStr.begin(), valueStr.end(), ::isdigit) && std::stoi(valueStr) > 0;
+                if (!valid) {
+                    std::cout << "Invalid value for --hal-deadline: " << valueStr << std::endl;
+                    exit(1);
+                }
+                options.halDeadline = std::chrono::milliseconds(std::stoi(valueStr));
+                ALOGI("--hal-deadline set to %s", valueStr.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--hal-deadline requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--pl1-range") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!Pl1Config::parseRange(value, options.pl1)) {
+                    std::cout << "Invalid value for --pl1-range: " << value
+                              << ". Use <min_w>,<max_w>[,<gpu_busy_target>] with 0 < min < max" << std::endl;
+                    exit(1);
+                }
+                options.pl1Control = true;
+                ALOGI("--pl1-range set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--pl1-range requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--pl1-node") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                options.pl1.node = value;
+                options.pl1Control = true;
+                ALOGI("--pl1-node set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--pl1-node requires a value" << std::endl;
+                exit(1);
+            }
+        } else if (arg == "--tune-ladder") {
+            if (i + 1 < argc) {
+                std::string value = argv[i + 1];
+                if (!TuneConfig::parseBackend(value, options.tuning)) {
+                    std::cout << "Invalid value for --tune-ladder: " << value << ". Allowed values: hint, direct, none"
+                              << std::endl;
+                    exit(1);
+                }
+                ALOGI("--tune-ladder set to %s", value.c_str());
+                ++i; // Skip the value
+            } else {
+                std::cout << "--tune-ladder requires a value" << std::endl;
+                exit(1);
+            }
         } else if (arg == "--help" || arg == "-h") {
-            std::cout << "Usage: " << argv[0] << " [--sendHint <true|false>] [--sendGfxHint <true|false>] [--sochint <wlt|swlt|hfi>] [--notification-delay <ms>] [--help]\n";
+            std::cout << "Usage: " << argv[0] << " [--sendHint <true|false>] [--sendGfxHint <true|false>] [--sochint <wlt|swlt|hfi|fusion>] [--notification-delay <ms>] [--sample-tick <ms>] [--timer-slack <us>] [--self-cpus <list>] [--sampler-sched <idle|nice>] [--policy-nice <n>] [--cgroup <path>] [--cpu-max <quota_us>[,<period_us>]] [--state-file <path|none>] [--state-max-age <s>] [--ctl-socket <path|none>] [--shared-state <path|none>] [--wlt-predict <true|false>] [--hint-budget <n>/<s>] [--hint-min-hold <ms>] [--fusion-weights <list>] [--fusion-bands <enter>,<exit>[,<conf>]] [--policy-file <path|none>] [--shadow-weights <list>] [--shadow-bands <enter>,<exit>[,<conf>]] [--contained-cpus <list>] [--hal-deadline <ms>] [--pl1-range <min>,<max>[,<busy>]] [--pl1-node <path>] [--tune-ladder <hint|direct|none>] [--help]\n";
             std::cout << "  --sendHint <true|false>         : Specify whether to send power hints to PowerHal (default: false)\n";
             std::cout << "  --sendGfxHint <true|false>      : Specify whether to send GFX power hints (default: false)\n";
-            std::cout << "  --sochint <value>               : Set SoC hint type. Allowed values: wlt, swlt, hfi\n";
-            std::cout << "  --notification-delay <ms>       : Notification delay in milliseconds (only valid with wlt or swlt)\n";
+            std::cout << "  --sochint <value>               : Set SoC hint type. Allowed values: wlt, swlt, hfi, fusion\n";
+            std::cout << "  --notification-delay <ms>       : Notification delay in milliseconds (only valid with wlt, swlt or fusion)\n";
+            std::cout << "  --sample-tick <ms>              : Base tick shared by all periodic monitors (default: 1000)\n";
+            std::cout << "  --timer-slack <us>              : Timer slack of the sampling thread (default: 50000)\n";
+            std::cout << "  --self-cpus <list>              : Pin all daemon threads to these CPUs, e.g. 4-7 (default: unpinned)\n";
+            std::cout << "  --sampler-sched <idle|nice>     : Sampler thread class: SCHED_IDLE or a nice value (default: idle)\n";
+            std::cout << "  --policy-nice <n>               : Nice value of event/policy threads (default: -4)\n";
+            std::cout << "  --cgroup <path>                 : Move the daemon into this cgroup directory\n";
+            std::cout << "  --cpu-max <quota_us>[,<period>] : CPU bandwidth cap written to cpu.max of --cgroup (cgroup v2, period default 100000)\n";
+            std::cout << "  --state-file <path|none>        : Warm-start checkpoint file (default: /dev/socdaemon/checkpoint)\n";
+            std::cout << "  --state-max-age <s>             : Ignore checkpoints older than this (default: 600)\n";
+            std::cout << "  --ctl-socket <path|none>        : Control/metrics socket (default: /data/vendor/socdaemon/ctl)\n";
+            std::cout << "  --shared-state <path|none>      : Memory-mapped state for other processes (default: /dev/socdaemon/state)\n";
+            std::cout << "  --wlt-predict <true|false>      : Adapt CC entry/exit debounce from learned WLT dwell times (default: false)\n";
+            std::cout << "  --hint-budget <n>/<s>           : Max hint toggles per window, 0 disables the governor (default: 0/60, off)\n";
+            std::cout << "  --hint-min-hold <ms>            : Minimum time a hint value is held before toggling (default: 5000)\n";
+            std::cout << "  --fusion-weights <list>         : Signal weights for fusion (default: wlt=3,swlt=1,hfi=2,load=2,slope=1,gpu=1)\n";
+            std::cout << "  --fusion-bands <e>,<x>[,<c>]    : Fusion enter/exit score bands and min confidence (default: 0.70,0.40,0.50)\n";
+            std::cout << "  --policy-file <path|none>       : Runtime-tunable thresholds, reloaded on change (default: /data/vendor/socdaemon/policy.conf)\n";
+            std::cout << "  --shadow-weights <list>         : Enable the record-only shadow policy with these fusion weights\n";
+            std::cout << "  --shadow-bands <e>,<x>[,<c>]    : Enable the shadow policy with these enter/exit bands\n";
+            std::cout << "  --contained-cpus <list>         : CPUs foreground cgroups are confined to in CC (default: 4-7)\n";
+            std::cout << "  --hal-deadline <ms>             : Report a Power HAL setMode call as stalled after this long (default: 500)\n";
+            std::cout << "  --pl1-range <min>,<max>[,<b>]   : Closed-loop PL1 in watts instead of GFX_MODE, GPU busy target b (default: 15,25,85)\n";
+            std::cout << "  --pl1-node <path>               : PL1 node of the closed loop (default: intel-rapl-mmio:0 constraint_0_power_limit_uw)\n";
+            std::cout << "  --tune-ladder <mode>            : EPP/uclamp/profile/slider bundle per WLT class: hint (TUNE_* modes), direct or none (default: none)\n";
             std::cout << "  --help, -h                      : Show this help message\n";
             exit(1);
         } else {
-            std::cout << "Usage: " << argv[0] << " [--sendHint <true|false>] [--sendGfxHint <true|false>] [--sochint <wlt|swlt|hfi>] [--notification-delay <ms>] [--help]\n";
+            std::cout << "Usage: " << argv[0] << " [--sendHint <true|false>] [--sendGfxHint <true|false>] [--sochint <wlt|swlt|hfi|fusion>] [--notification-delay <ms>] [--sample-tick <ms>] [--timer-slack <us>] [--self-cpus <list>] [--sampler-sched <idle|nice>] [--policy-nice <n>] [--cgroup <path>] [--cpu-max <quota_us>[,<period_us>]] [--state-file <path|none>] [--state-max-age <s>] [--ctl-socket <path|none>] [--shared-state <path|none>] [--wlt-predict <true|false>] [--hint-budget <n>/<s>] [--hint-min-hold <ms>] [--fusion-weights <list>] [--fusion-bands <enter>,<exit>[,<conf>]] [--policy-file <path|none>] [--shadow-weights <list>] [--shadow-bands <enter>,<exit>[,<conf>]] [--contained-cpus <list>] [--hal-deadline <ms>] [--pl1-range <min>,<max>[,<busy>]] [--pl1-node <path>] [--tune-ladder <hint|direct|none>] [--help]\n";
             exit(1);
         }
     }
 
+    if (!options.placement.cpuMax.empty() && options.placement.cgroupPath.empty()) {
+        std::cout << "--cpu-max requires --cgroup\n";
+        exit(1);
+    }
+
     // Validate --notification-delay usage
-    if (notificationDelay >= 0 && !(socHint == "wlt" || socHint == "swlt")) {
-        std::cout << "--notification-delay is only valid with --sochint wlt or swlt\n";
+    if (notificationDelay >= 0 && !(socHint == "wlt" || socHint == "swlt" || socHint == "fusion")) {
+        std::cout << "--notification-delay is only valid with --sochint wlt, swlt or fusion\n";
         exit(1);
     }
 
@@ -117,7 +477,7 @@ int main(int argc, char* argv[]) {
         ALOGI("--sochint not given, defaulting to %s", socHint.c_str());
     }
 
-    SocDaemon daemon(sendHint, sendGfxHint, socHint, notificationDelay);
+    SocDaemon daemon(sendHint, sendGfxHint, socHint, notificationDelay, options);
     daemon.start();
     return 0;
 }
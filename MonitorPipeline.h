@@ -0,0 +1,387 @@
+#pragma once
+
+// MonitorPipeline.h
+// -----------------------------------------------------------------------------
+// Compile-time composed monitors:
+//
+//   pipeline::Monitor<Source, Parser, Filter, Detector, Sink>
+//
+// Each stage is a plain policy type; the monitor calls them directly, so a
+// sample is one read plus whatever the chosen stages do, with no virtual calls
+// or allocations in between. A new signal is a type alias (plus a subclass when
+// it needs a custom init()), not another copy of the read/poll loop.
+//
+// Stage contracts:
+//   Source    kEventDriven; bool open(); bool read(char* buf, size_t size, size_t& len);
+//             event sources also: void wait()  (blocks until the next notification/timeout),
+//             int timeoutMs(), bool isOpen(), void close()
+//   Parser    bool parse(std::string_view text, Clock::time_point ts, double& value); void reset();
+//   Filter    double apply(double value); void reset();
+//   Detector  bool detect(double value, int& oldValue, int& newValue); void reset();
+//   Sink      static void emit(Monitor& monitor, int oldValue, int newValue);
+//
+// Event-driven sources run monitorLoop() on their own thread; periodic sources
+// are serviced by the SamplingClock (periodTicks() > 0) and honour pause().
+// An event loop that loses its source (read error, node gone) re-opens it with
+// back-off, reset only by a successful read, instead of exiting. It reports the
+// loss, and the first good read after it, through sourceChanged(), so a watchdog
+// sees a dead node as a lost input rather than a quiet one.
+//
+// Sources are file descriptors read as text. There is no netlink source:
+// genetlink events (HFI, thermal) are binary attribute sets decoded by libnl
+// callbacks and do not fit the text Parser stage, so HfiMonitor keeps its
+// own loop.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+#include "HintMonitor.h"
+
+#define PIPELINE_LOG_TAG "SocDaemon_Pipeline"
+#define PIPELOGD(...) __android_log_print(ANDROID_LOG_DEBUG, PIPELINE_LOG_TAG, __VA_ARGS__)
+#define PIPELOGE(...) __android_log_print(ANDROID_LOG_ERROR, PIPELINE_LOG_TAG, __VA_ARGS__)
+
+namespace pipeline {
+
+using Clock = std::chrono::steady_clock;
+
+// --- Sources -----------------------------------------------------------------
+
+// Persistent descriptor on a file, re-read from offset 0 on every sample.
+class FileSource {
+public:
+    static constexpr bool kEventDriven = false;
+
+    explicit FileSource(std::string path) : path_(std::move(path)) {}
+    ~FileSource() { close(); }
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+    FileSource(FileSource&& other) noexcept : path_(std::move(other.path_)), fd_(other.fd_) { other.fd_ = -1; }
+
+    bool open() {
+        close();
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            PIPELOGE("Could not open '%s': %s", path_.c_str(), std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    bool read(char* buf, size_t size, size_t& len) {
+        ssize_t n = pread(fd_, buf, size - 1, 0);
+        if (n < 0) {
+            PIPELOGE("Could not read '%s': %s", path_.c_str(), std::strerror(errno));
+            return false;
+        }
+        buf[n] = '\0';
+        len = strcspn(buf, "\n");
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    const std::string& path() const { return path_; }
+    int fd() const { return fd_; }
+    bool isOpen() const { return fd_ >= 0; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+};
+
+// sysfs attribute that notifies changes with sysfs_notify() (POLLPRI). Reading
+// from offset 0 re-arms the notification; the timeout bounds how long a missed
+// notification can go unnoticed (-1 waits forever).
+class SysfsPollSource : public FileSource {
+public:
+    static constexpr bool kEventDriven = true;
+
+    SysfsPollSource(std::string path, int timeoutMs) : FileSource(std::move(path)), timeoutMs_(timeoutMs) {}
+
+    void wait() {
+        struct pollfd pfd = {fd(), POLLPRI | POLLERR, 0};
+        int ret = poll(&pfd, 1, timeoutMs_);
+        if (ret < 0) {
+            PIPELOGE("poll() failed for '%s': %s", path().c_str(), std::strerror(errno));
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    int timeoutMs() const { return timeoutMs_; }
+
+private:
+    int timeoutMs_;
+};
+
+// --- Parsers -----------------------------------------------------------------
+
+// Decimal integer attribute.
+struct IntParser {
+    bool parse(std::string_view text, Clock::time_point, double& value) {
+        char* end = nullptr;
+        long v = std::strtol(text.data(), &end, 10);
+        if (end == text.data()) return false;
+        value = static_cast<double>(v);
+        return true;
+    }
+    void reset() {}
+};
+
+// Monotonic counter in units of `kUnitsPerSecond` (e.g. a residency in ms = 1000)
+// turned into the percentage of wall time it advanced by since the last sample.
+template <long kUnitsPerSecond>
+struct CounterPercentParser {
+    bool parse(std::string_view text, Clock::time_point ts, double& value) {
+        char* end = nullptr;
+        unsigned long long counter = std::strtoull(text.data(), &end, 10);
+        if (end == text.data()) return false;
+        bool valid = haveLast_ && counter >= lastCounter_ && ts > lastTs_;
+        if (valid) {
+            double seconds = std::chrono::duration<double>(ts - lastTs_).count();
+            value = std::min(100.0, static_cast<double>(counter - lastCounter_) * 100.0 / (seconds * kUnitsPerSecond));
+        }
+        lastCounter_ = counter;
+        lastTs_ = ts;
+        haveLast_ = true;
+        return valid;
+    }
+    void reset() { haveLast_ = false; }
+
+private:
+    unsigned long long lastCounter_ = 0;
+    Clock::time_point lastTs_{};
+    bool haveLast_ = false;
+};
+
+// --- Filters -----------------------------------------------------------------
+
+struct NoFilter {
+    double apply(double value) { return value; }
+    void reset() {}
+};
+
+// Exponential moving average over irregular sample intervals: a sample taken
+// dt after the previous one weighs 1 - exp(-dt / tau). The first sample seeds it.
+class EmaFilter {
+public:
+    explicit EmaFilter(double timeConstantSec) : tauSec_(timeConstantSec) {}
+    double apply(double value) {
+        Clock::time_point now = Clock::now();
+        if (std::isnan(ema_)) {
+            ema_ = value;
+        } else {
+            double dt = std::max(0.0, std::chrono::duration<double>(now - lastTs_).count());
+            ema_ += (1.0 - std::exp(-dt / tauSec_)) * (value - ema_);
+        }
+        lastTs_ = now;
+        return ema_;
+    }
+    void reset() { ema_ = NAN; }
+
+    // Warm start from a previously filtered value.
+    void seed(double value) {
+        ema_ = value;
+        lastTs_ = Clock::now();
+    }
+    // NaN until the first sample or seed().
+    double value() const { return ema_; }
+
+private:
+    double tauSec_;
+    double ema_ = NAN;
+    Clock::time_point lastTs_{};
+};
+
+// --- Detectors ---------------------------------------------------------------
+
+// Any change of the (integer) value: (previous, current). The first sample
+// always reports, against 0.
+struct ChangeDetector {
+    bool detect(double value, int& oldValue, int& newValue) {
+        int current = static_cast<int>(value);
+        if (have_ && current == last_) return false;
+        oldValue = have_ ? last_ : 0;
+        newValue = current;
+        last_ = current;
+        have_ = true;
+        return true;
+    }
+    void reset() { have_ = false; }
+
+private:
+    int last_ = 0;
+    bool have_ = false;
+};
+
+// Level of `value` against a runtime threshold: active at or below it when
+// kActiveBelow, at or above it otherwise. Reports (value, level) when the level
+// changes; the first sample always reports.
+template <bool kActiveBelow>
+struct ThresholdDetector {
+    explicit ThresholdDetector(double threshold = 0.0) : threshold_(threshold) {}
+    ThresholdDetector(ThresholdDetector&& other) noexcept : threshold_(other.threshold_.load()) {}
+
+    bool detect(double value, int& oldValue, int& newValue) {
+        double threshold = threshold_.load(std::memory_order_relaxed);
+        int level = (kActiveBelow ? value <= threshold : value >= threshold) ? 1 : 0;
+        if (level == level_) return false;
+        level_ = level;
+        oldValue = static_cast<int>(value);
+        newValue = level;
+        return true;
+    }
+    void reset() { level_ = -1; }
+    void setThreshold(double threshold) { threshold_ = threshold; }
+
+private:
+    std::atomic<double> threshold_;
+    int level_ = -1;
+};
+
+// --- Sinks -------------------------------------------------------------------
+
+// HintMonitor change alert (the daemon's handleChangeAlert()).
+struct AlertSink {
+    template <typename M>
+    static void emit(M& monitor, int oldValue, int newValue) {
+        monitor.raise(oldValue, newValue);
+    }
+};
+
+// --- Monitor -----------------------------------------------------------------
+
+template <typename Source, typename Parser, typename Filter, typename Detector, typename Sink>
+class Monitor : public HintMonitor {
+public:
+    Monitor(const std::string& name, Source source, Parser parser = Parser(), Filter filter = Filter(),
+            Detector detector = Detector(), unsigned periodTicks = 1)
+        : HintMonitor(name),
+          source_(std::move(source)),
+          parser_(std::move(parser)),
+          filter_(std::move(filter)),
+          detector_(std::move(detector)),
+          periodTicks_(periodTicks) {}
+
+    int init() override { return source_.open() ? 0 : -1; }
+
+    // Event-driven: sample, then block until the source notifies. Periodic sources
+    // have no loop: the SamplingClock calls sampleOnce().
+    void monitorLoop() override {
+        if constexpr (Source::kEventDriven) {
+            auto backoff = kReopenBackoffMin;
+            bool lost = false;
+            while (!shouldExit_) {
+                if (!source_.isOpen() && source_.open()) {
+                    PIPELOGD("Opened '%s' for %s", source_.path().c_str(), name().c_str());
+                }
+                if (!source_.isOpen() || !sample()) {
+                    // Missing or unreadable node: only a good read resets the back-off.
+                    source_.close();
+                    if (!lost) {
+                        lost = true;
+                        PIPELOGE("%s lost '%s', re-opening with back-off", name().c_str(), source_.path().c_str());
+                        sourceChanged(true);
+                    }
+                    std::this_thread::sleep_for(backoff);
+                    backoff = std::min(backoff * 2, kReopenBackoffMax);
+                    continue;
+                }
+                if (lost) {
+                    lost = false;
+                    PIPELOGD("%s delivering again from '%s'", name().c_str(), source_.path().c_str());
+                    sourceChanged(false);
+                }
+                backoff = kReopenBackoffMin;
+                heartbeat();
+                source_.wait();
+            }
+        }
+    }
+
+    // SamplingClock interface (periodic sources only)
+    unsigned periodTicks() const override { return Source::kEventDriven ? 0 : periodTicks_; }
+    std::chrono::milliseconds heartbeatPeriod() const override {
+        if constexpr (Source::kEventDriven) {
+            return std::chrono::milliseconds(std::max(source_.timeoutMs(), 0));
+        } else {
+            return std::chrono::milliseconds(0);
+        }
+    }
+    bool isSampling() const override { return !paused_.load() && !shouldExit_.load(); }
+    void sampleOnce() override { sample(); }
+
+    void pause() {
+        resetPending_ = true;
+        paused_ = true;
+    }
+
+    void resume() { paused_ = false; }
+
+    void stop() { shouldExit_ = true; }
+
+    // Called by the sink.
+    void raise(int oldValue, int newValue) { onValueChanged(oldValue, newValue); }
+
+    // Last filtered value; NaN before the first one after (re)start.
+    double lastValue() const { return value_.load(std::memory_order_relaxed); }
+
+protected:
+    Source& source() { return source_; }
+    Detector& detector() { return detector_; }
+
+private:
+    // False only when the source could not be read.
+    bool sample() {
+        if (resetPending_.exchange(false)) {
+            // Counters/filters must not span a pause.
+            parser_.reset();
+            filter_.reset();
+            detector_.reset();
+            value_ = NAN;
+        }
+        char buf[kReadBufferSize];
+        size_t len = 0;
+        if (!source_.read(buf, sizeof(buf), len)) return false;
+        double value = 0.0;
+        if (!parser_.parse(std::string_view(buf, len), Clock::now(), value)) return true;
+        value = filter_.apply(value);
+        value_.store(value, std::memory_order_relaxed);
+        int oldValue = 0, newValue = 0;
+        if (detector_.detect(value, oldValue, newValue)) Sink::emit(*this, oldValue, newValue);
+        return true;
+    }
+
+    static constexpr size_t kReadBufferSize = 32;
+    static constexpr std::chrono::milliseconds kReopenBackoffMin{500};
+    static constexpr std::chrono::milliseconds kReopenBackoffMax{30000};
+
+    Source source_;
+    Parser parser_;
+    Filter filter_;
+    Detector detector_;
+    unsigned periodTicks_;
+
+    std::atomic<bool> paused_{false};
+    std::atomic<bool> shouldExit_{false};
+    std::atomic<bool> resetPending_{false};
+    std::atomic<double> value_{NAN};
+};
+
+} // namespace pipeline
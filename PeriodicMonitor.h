@@ -0,0 +1,69 @@
+#ifndef PERIODICMONITOR_H
+#define PERIODICMONITOR_H
+
+#include <atomic>
+#include <string>
+#include <android/log.h>
+
+#include "HintMonitor.h"
+
+// Logging macros for PeriodicMonitor
+#define PERIODIC_LOG_TAG "SocDaemon_PeriodicMonitor"
+#define PERIODICLOGI(...) __android_log_print(ANDROID_LOG_INFO, PERIODIC_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Base of the monitors that are sampled by the SamplingClock.
+ *
+ * Holds the period and the pause state. The daemon registers periodTicks(),
+ * isSampling() and sampleOnce() with the clock, so these monitors have no loop
+ * or thread of their own. pause() also requests a reset; the subclass consumes
+ * it with consumeReset() at the start of its next sample, so that no interval
+ * or baseline spans the pause.
+ */
+class PeriodicMonitor : public HintMonitor {
+public:
+    /**
+     * @param name Monitor name used for alerts.
+     * @param periodTicks Sampling period in SamplingClock base ticks.
+     */
+    PeriodicMonitor(const std::string& name, unsigned periodTicks)
+        : HintMonitor(name), samplerPeriodTicks_(periodTicks) {}
+
+    // Not used: the SamplingClock calls sampleOnce().
+    void monitorLoop() override {}
+
+    // SamplingClock interface
+    unsigned periodTicks() const override { return samplerPeriodTicks_; }
+    bool isSampling() const override { return !paused_.load(); }
+
+    void pause() {
+        resetPending_ = true;
+        paused_ = true;
+        PERIODICLOGI("%s: Paused sampling", name().c_str());
+    }
+
+    void resume() {
+        if (!paused_.load()) return;
+        onResumed(); // before the clock may sample again
+        paused_ = false;
+        PERIODICLOGI("%s: Resumed sampling", name().c_str());
+    }
+
+protected:
+    // Called on the resuming thread when resume() ends a pause, before sampling
+    // restarts. Lets a monitor take its baseline now rather than on its first tick.
+    virtual void onResumed() {}
+    // True once after each pause() or requestReset(): the next sample starts
+    // from fresh baselines.
+    bool consumeReset() { return resetPending_.exchange(false); }
+    // For subclasses whose own state changes invalidate the current interval.
+    void requestReset() { resetPending_ = true; }
+    // For subclasses that size the period in init(), before registration with the clock.
+    void setPeriodTicks(unsigned periodTicks) { samplerPeriodTicks_ = periodTicks; }
+
+private:
+    unsigned samplerPeriodTicks_;
+    std::atomic<bool> paused_{false};
+    std::atomic<bool> resetPending_{false};
+};
+#endif // PERIODICMONITOR_H
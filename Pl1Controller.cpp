@@ -0,0 +1,168 @@
+// -----------------------------------------------------------------------------
+// Pl1Controller.cpp
+//
+// Rate-limited PI control of package PL1 from GPU demand, package power and
+// thermal headroom. See Pl1Controller.h.
+// -----------------------------------------------------------------------------
+
+#include "Pl1Controller.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+bool Pl1Config::parseRange(const std::string& text, Pl1Config& config) {
+    // "min,max[,target]": each field must parse completely (as in PolicyParams), nothing may follow.
+    double values[3] = {0.0, 0.0, config.targetBusyPercent};
+    const char* p = text.c_str();
+    int fields = 0;
+    while (true) {
+        if (fields == 3) return false;
+        char* end = nullptr;
+        values[fields++] = strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        if (*p != ',') break;
+        ++p;
+    }
+    if (*p != '\0' || fields < 2) return false;
+    double minW = values[0], maxW = values[1], target = values[2];
+    if (!(minW > 0.0 && minW < maxW && target > 0.0 && target <= 100.0)) return false;
+    config.minW = minW;
+    config.maxW = maxW;
+    config.targetBusyPercent = target;
+    return true;
+}
+
+Pl1Controller::Pl1Controller(const Pl1Config& config)
+    : config_(config), limitW_(config.minW), ceilingW_(config.maxW) {}
+
+Pl1Controller::~Pl1Controller() {
+    if (fd_ >= 0) close(fd_);
+}
+
+int Pl1Controller::init() {
+    fd_ = open(config_.node.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        PL1LOGE("Pl1Controller: Cannot open %s: %s", config_.node.c_str(), strerror(errno));
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Never inherit a raised limit from a previous instance or the HAL's GFX_MODE.
+    writeLimitLocked(config_.minW);
+    PL1LOGI("Pl1Controller: %s in [%.2f, %.2f] W, GPU busy target %.0f%%", config_.node.c_str(), config_.minW,
+            config_.maxW, config_.targetBusyPercent);
+    return 0;
+}
+
+bool Pl1Controller::writeLimitLocked(double watts) {
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(std::llround(watts * 1e6)));
+    if (pwrite(fd_, buf, len, 0) != len) {
+        if (writeErrors_++ == 0) {
+            PL1LOGE("Pl1Controller: Write of %s to %s failed: %s", buf, config_.node.c_str(), strerror(errno));
+        }
+        return false;
+    }
+    writtenW_ = watts;
+    writes_++;
+    return true;
+}
+
+void Pl1Controller::update(const Inputs& in) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    double dt = lastUpdate_ == std::chrono::steady_clock::time_point{}
+                        ? 1.0
+                        : std::chrono::duration<double>(now - lastUpdate_).count();
+    dt = std::clamp(dt, 0.0, kMaxStepSeconds);
+    lastUpdate_ = now;
+    lastInputs_ = in;
+
+    // Thermal ceiling: the budget shrinks as the hottest zone approaches its trip.
+    double ceiling = config_.maxW;
+    if (in.tripCrossed) {
+        ceiling = config_.minW;
+    } else if (in.headroomMC >= 0 && config_.thermalBandMC > 0) {
+        double fraction = std::min(1.0, static_cast<double>(in.headroomMC) / config_.thermalBandMC);
+        ceiling = config_.minW + (config_.maxW - config_.minW) * fraction;
+    }
+    ceilingW_ = ceiling;
+
+    double maxStep = config_.maxSlewWPerS * dt;
+    double target;
+    if (!in.gpuActive) {
+        // No GPU demand is being measured: return to the resting limit.
+        havePrev_ = false;
+        target = limitW_ - maxStep;
+    } else {
+        double error = in.gpuBusyPercent - config_.targetBusyPercent;
+        bool budgetBound = in.gpuPowerLimited ||
+                           (in.packageW >= 0.0 && in.packageW >= limitW_ - config_.budgetMarginW);
+        if (error > 0.0 && (!budgetBound || in.gpuThermalLimited)) {
+            // Busy, but more PL1 would not be used (or would only heat a throttled GPU).
+            error = 0.0;
+        }
+        double delta = config_.kp * (havePrev_ ? error - prevError_ : 0.0) + config_.ki * error * dt;
+        prevError_ = error;
+        havePrev_ = true;
+        target = limitW_ + std::clamp(delta, -maxStep, maxStep);
+    }
+
+    double limit = std::clamp(target, config_.minW, config_.maxW);
+    if (limit > ceiling) {
+        limit = ceiling;
+        thermalCaps_++;
+    }
+    limitW_ = limit;
+
+    double quantized = std::round(limit / kWriteQuantumW) * kWriteQuantumW;
+    quantized = std::clamp(quantized, config_.minW, config_.maxW);
+    double output = in.apply ? quantized : config_.minW;
+    if (output == writtenW_) return;
+    if (writeLimitLocked(output)) {
+        PL1LOGD("Pl1Controller: PL1 %.2f W (busy %.1f%%, package %.2f W, ceiling %.2f W)", output,
+                in.gpuBusyPercent, in.packageW, ceiling);
+    }
+}
+
+bool Pl1Controller::isAboveFloor() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limitW_ > config_.minW || writtenW_ > config_.minW;
+}
+
+double Pl1Controller::limitW() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limitW_;
+}
+
+void Pl1Controller::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "node=%s\nrange_w=%.2f,%.2f\ntarget_busy=%.1f\nlimit_w=%.2f\nwritten_w=%.2f\nceiling_w=%.2f\n"
+             "gpu_active=%d\ngpu_busy=%.1f\ngpu_power_limited=%d\ngpu_thermal_limited=%d\npackage_w=%.2f\n"
+             "headroom_mc=%d\napply=%d\nwrites=%" PRIu64 "\nwrite_errors=%" PRIu64 "\nthermal_caps=%" PRIu64 "\n",
+             config_.node.c_str(), config_.minW, config_.maxW, config_.targetBusyPercent, limitW_, writtenW_,
+             ceilingW_, lastInputs_.gpuActive, lastInputs_.gpuBusyPercent, lastInputs_.gpuPowerLimited,
+             lastInputs_.gpuThermalLimited, lastInputs_.packageW, lastInputs_.headroomMC, lastInputs_.apply, writes_,
+             writeErrors_, thermalCaps_);
+    out += buf;
+}
+
+void Pl1Controller::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "# TYPE socdaemon_pl1_limit_watts gauge\nsocdaemon_pl1_limit_watts %.2f\n"
+             "# TYPE socdaemon_pl1_ceiling_watts gauge\nsocdaemon_pl1_ceiling_watts %.2f\n"
+             "# TYPE socdaemon_pl1_writes counter\nsocdaemon_pl1_writes_total %" PRIu64 "\n"
+             "# TYPE socdaemon_pl1_write_errors counter\nsocdaemon_pl1_write_errors_total %" PRIu64 "\n",
+             writtenW_, ceilingW_, writes_, writeErrors_);
+    out += buf;
+}
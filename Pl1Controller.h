@@ -0,0 +1,107 @@
+#pragma once
+
+// Pl1Controller.h
+// -----------------------------------------------------------------------------
+// Closed-loop package PL1 for GPU-bound work. GFX_MODE only knows two values
+// (the HAL writes 18 W or 15 W); this controller instead picks a limit in
+// [minW, maxW] every sample and writes it to the powercap node itself.
+//
+// Each step uses the GPU busy error against targetBusyPercent in velocity form:
+//
+//   delta = kp * (e - e_prev) + ki * e * dt,   |delta| <= maxSlewWPerS * dt
+//
+// A positive error only raises the limit while the GPU is actually held back
+// by it: throttled for PL1/PL2, or (without throttle reasons) the package
+// drawing within budgetMarginW of the current limit. A thermally limited GPU
+// is never given more budget. Thermal headroom caps the limit: the ceiling
+// falls linearly from maxW to minW as the hottest zone's headroom drops from
+// thermalBandMC to 0, and is minW once a trip is crossed. Dropping to the
+// ceiling is immediate; everything else is rate limited. While the GPU is not
+// sampled (WLT Idle/Btl) the limit slews back to minW.
+//
+// Writes are quantized to kWriteQuantumW so a settled loop does not rewrite
+// the node every second.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#define PL1_LOG_TAG "SocDaemon_Pl1Controller"
+#define PL1LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, PL1_LOG_TAG, __VA_ARGS__)
+#define PL1LOGI(...) __android_log_print(ANDROID_LOG_INFO, PL1_LOG_TAG, __VA_ARGS__)
+#define PL1LOGE(...) __android_log_print(ANDROID_LOG_ERROR, PL1_LOG_TAG, __VA_ARGS__)
+
+// Same node the powerhint GFX_MODE action writes.
+inline constexpr char kDefaultPl1Node[] = "/sys/class/powercap/intel-rapl-mmio:0/constraint_0_power_limit_uw";
+
+struct Pl1Config {
+    std::string node{kDefaultPl1Node};
+    double minW = 15.0;               // resting PL1 (the HAL's GFX_MODE=0 value)
+    double maxW = 25.0;
+    double targetBusyPercent = 85.0;  // GPU busy setpoint
+    double kp = 0.05;                 // W per % of busy error change
+    double ki = 0.02;                 // W per % of busy error per second
+    double maxSlewWPerS = 1.0;
+    double budgetMarginW = 1.0;       // package within this of the limit counts as power-limited
+    int thermalBandMC = 10000;        // headroom below which the ceiling is lowered
+
+    // "<min_w>,<max_w>[,<target_busy_percent>]". Returns false unless 0 < min < max and 0 < target <= 100.
+    static bool parseRange(const std::string& text, Pl1Config& config);
+};
+
+class Pl1Controller {
+public:
+    struct Inputs {
+        bool gpuActive = false;       // GPU monitor sampled (not WLT Idle/Btl)
+        double gpuBusyPercent = 0.0;
+        bool gpuPowerLimited = false;
+        bool gpuThermalLimited = false;
+        double packageW = -1.0;       // < 0: unknown
+        bool tripCrossed = false;     // thermal pressure at kThermalThrottling
+        int headroomMC = -1;          // < 0: unknown
+        bool apply = true;            // false: compute only, the node is held at minW (send_gfx_hint=0)
+    };
+
+    explicit Pl1Controller(const Pl1Config& config);
+    ~Pl1Controller();
+
+    Pl1Controller(const Pl1Controller&) = delete;
+    Pl1Controller& operator=(const Pl1Controller&) = delete;
+
+    // Opens the node and writes minW. Returns -1 if the node cannot be opened.
+    int init();
+
+    // One control step; called from the sampling clock.
+    void update(const Inputs& in);
+
+    // Still above minW: keep stepping after the GPU monitor paused.
+    bool isAboveFloor() const;
+    double limitW() const;
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const;
+
+private:
+    static constexpr double kWriteQuantumW = 0.25;
+    static constexpr double kMaxStepSeconds = 5.0; // a late tick must not allow a large jump
+
+    bool writeLimitLocked(double watts); // caller holds mutex_
+
+    Pl1Config config_;
+    int fd_ = -1;
+
+    mutable std::mutex mutex_;
+    double limitW_;                   // controller output
+    double writtenW_ = -1.0;          // last value in the node
+    double ceilingW_;
+    double prevError_ = 0.0;
+    bool havePrev_ = false;
+    std::chrono::steady_clock::time_point lastUpdate_{};
+    Inputs lastInputs_;
+    uint64_t writes_ = 0;
+    uint64_t writeErrors_ = 0;
+    uint64_t thermalCaps_ = 0;        // steps where the ceiling cut the limit
+};
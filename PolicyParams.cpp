@@ -0,0 +1,280 @@
+// -----------------------------------------------------------------------------
+// PolicyParams.cpp
+//
+// Validated policy parameter sets with snapshot readers and inotify reload.
+// See PolicyParams.h.
+// -----------------------------------------------------------------------------
+
+#include "PolicyParams.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+bool parseBool(const std::string& value, bool& out) {
+    if (value == "true" || value == "1") {
+        out = true;
+    } else if (value == "false" || value == "0") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseLong(const std::string& value, long& out) {
+    char* end = nullptr;
+    out = strtol(value.c_str(), &end, 10);
+    return !value.empty() && *end == '\0';
+}
+
+bool parseDouble(const std::string& value, double& out) {
+    char* end = nullptr;
+    out = strtod(value.c_str(), &end);
+    return !value.empty() && *end == '\0';
+}
+
+bool parseMs(const std::string& value, std::chrono::milliseconds& out) {
+    long ms = 0;
+    if (!parseLong(value, ms)) return false;
+    out = std::chrono::milliseconds(ms);
+    return true;
+}
+} // namespace
+
+bool PolicyParams::parse(const std::string& text, std::string& error) {
+    PolicyParams parsed = *this;
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            error = "line " + std::to_string(lineNo) + ": expected key=value";
+            return false;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        long l = 0;
+        bool ok;
+        if (key == "send_hint") {
+            ok = parseBool(value, parsed.sendHint);
+        } else if (key == "send_gfx_hint") {
+            ok = parseBool(value, parsed.sendGfxHint);
+        } else if (key == "cc_entry_debounce_ms") {
+            ok = parseMs(value, parsed.ccEntryDebounce);
+        } else if (key == "cc_exit_debounce_ms") {
+            ok = parseMs(value, parsed.ccExitDebounce);
+        } else if (key == "cc_exit_recheck_ms") {
+            ok = parseMs(value, parsed.ccExitRecheck);
+        } else if (key == "sysload_entry_threshold") {
+            ok = parseDouble(value, parsed.sysloadEntryThreshold);
+        } else if (key == "sysload_slope_threshold") {
+            ok = parseDouble(value, parsed.sysloadSlopeThreshold);
+        } else if (key == "sysload_high_threshold") {
+            ok = parseDouble(value, parsed.sysloadHighThreshold);
+        } else if (key == "sysload_fall_threshold") {
+            ok = parseDouble(value, parsed.sysloadFallThreshold);
+        } else if (key == "sysload_high_min_ms") {
+            ok = parseMs(value, parsed.sysloadHighMinAbove);
+        } else if (key == "gpu_high_load_percent") {
+            ok = parseLong(value, l);
+            parsed.gpuHighLoadPercent = static_cast<int>(l);
+        } else {
+            error = "line " + std::to_string(lineNo) + ": unknown key '" + key + "'";
+            return false;
+        }
+        if (!ok) {
+            error = "line " + std::to_string(lineNo) + ": invalid value for " + key;
+            return false;
+        }
+    }
+    if (!parsed.validate(error)) return false;
+    *this = parsed;
+    return true;
+}
+
+bool PolicyParams::validate(std::string& error) const {
+    constexpr std::chrono::milliseconds kMaxTimer{600000};
+    auto timerOk = [&](std::chrono::milliseconds t) { return t.count() > 0 && t <= kMaxTimer; };
+    auto percentOk = [](double p) { return p > 0.0 && p <= 100.0; };
+    if (!timerOk(ccEntryDebounce) || !timerOk(ccExitDebounce) || !timerOk(ccExitRecheck)) {
+        error = "timers must be in (0, 600000] ms";
+    } else if (!percentOk(sysloadEntryThreshold) || !percentOk(sysloadSlopeThreshold) ||
+               !percentOk(sysloadHighThreshold) || !percentOk(sysloadFallThreshold)) {
+        error = "load thresholds must be in (0, 100]";
+    } else if (sysloadFallThreshold > sysloadHighThreshold) {
+        error = "sysload_fall_threshold must not exceed sysload_high_threshold";
+    } else if (sysloadHighMinAbove.count() < 0 || sysloadHighMinAbove > kMaxTimer) {
+        error = "sysload_high_min_ms must be in [0, 600000]";
+    } else if (gpuHighLoadPercent < 0 || gpuHighLoadPercent > 100) {
+        error = "gpu_high_load_percent must be in [0, 100]";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+void PolicyParams::appendText(std::string& out) const {
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "send_hint=%d\nsend_gfx_hint=%d\ncc_entry_debounce_ms=%lld\ncc_exit_debounce_ms=%lld\n"
+             "cc_exit_recheck_ms=%lld\nsysload_entry_threshold=%.2f\nsysload_slope_threshold=%.2f\n"
+             "sysload_high_threshold=%.2f\nsysload_fall_threshold=%.2f\nsysload_high_min_ms=%lld\n"
+             "gpu_high_load_percent=%d\n",
+             sendHint, sendGfxHint, static_cast<long long>(ccEntryDebounce.count()),
+             static_cast<long long>(ccExitDebounce.count()), static_cast<long long>(ccExitRecheck.count()),
+             sysloadEntryThreshold, sysloadSlopeThreshold, sysloadHighThreshold, sysloadFallThreshold,
+             static_cast<long long>(sysloadHighMinAbove.count()), gpuHighLoadPercent);
+    out += buf;
+}
+
+PolicyRegistry::PolicyRegistry(const PolicyParams& defaults, const std::string& path)
+    : defaults_(defaults), path_(path) {
+    size_t slash = path_.rfind('/');
+    dir_ = slash == std::string::npos ? "." : path_.substr(0, slash);
+    file_ = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish(std::make_unique<PolicyParams>(defaults_));
+}
+
+PolicyRegistry::~PolicyRegistry() {
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+}
+
+void PolicyRegistry::publish(std::unique_ptr<PolicyParams> params) {
+    params->version = nextVersion_++;
+    std::atomic_store_explicit(&current_, std::shared_ptr<const PolicyParams>(std::move(params)),
+                               std::memory_order_release);
+}
+
+void PolicyRegistry::setListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener_ = std::move(listener);
+}
+
+bool PolicyRegistry::reload(std::string& error) {
+    if (path_.empty()) {
+        error = "no policy file";
+        return false;
+    }
+    auto params = std::make_unique<PolicyParams>(defaults_);
+    std::ifstream in(path_);
+    if (in) {
+        std::stringstream text;
+        text << in.rdbuf();
+        if (!params->parse(text.str(), error)) {
+            PARAMSLOGE("PolicyRegistry: Rejected %s: %s", path_.c_str(), error.c_str());
+            std::lock_guard<std::mutex> lock(mutex_);
+            lastError_ = error;
+            return false;
+        }
+    }
+
+    Listener listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_.clear();
+        publish(std::move(params));
+        PARAMSLOGI("PolicyRegistry: Published version %u from %s", current()->version,
+                   in ? path_.c_str() : "defaults (no file)");
+        listener = listener_;
+    }
+    if (listener) {
+        std::lock_guard<std::mutex> lock(listenerMutex_);
+        listener(*current());
+    }
+    return true;
+}
+
+int PolicyRegistry::init() {
+    if (path_.empty()) return -1;
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        PARAMSLOGE("PolicyRegistry: inotify_init1 failed: %s", strerror(errno));
+        return -1;
+    }
+    if (inotify_add_watch(inotifyFd_, dir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0) {
+        PARAMSLOGE("PolicyRegistry: Cannot watch %s: %s", dir_.c_str(), strerror(errno));
+        close(inotifyFd_);
+        inotifyFd_ = -1;
+        return -1;
+    }
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return 0;
+}
+
+void PolicyRegistry::watchLoop() {
+    if (inotifyFd_ < 0) return;
+    alignas(struct inotify_event) char buffer[4096];
+    while (!shouldExit_) {
+        struct pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+        if (poll(fds, wakeFd_ >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            PARAMSLOGE("PolicyRegistry: poll failed: %s", strerror(errno));
+            return;
+        }
+        if (shouldExit_) break;
+
+        bool changed = false;
+        ssize_t len;
+        while ((len = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len;) {
+                auto* event = reinterpret_cast<struct inotify_event*>(p);
+                if (event->len > 0 && file_ == event->name) changed = true;
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            std::string error;
+            reload(error);
+        }
+    }
+    PARAMSLOGI("PolicyRegistry: watch thread exiting");
+}
+
+void PolicyRegistry::stop() {
+    shouldExit_ = true;
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        if (write(wakeFd_, &one, sizeof(one)) < 0) {
+            PARAMSLOGE("PolicyRegistry: wake failed: %s", strerror(errno));
+        }
+    }
+}
+
+void PolicyRegistry::appendText(std::string& out) const {
+    std::shared_ptr<const PolicyParams> params = current();
+    char buf[64];
+    snprintf(buf, sizeof(buf), "version=%u\n", params->version);
+    out += buf;
+    out += "source=" + (path_.empty() ? std::string("defaults") : path_) + "\n";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!lastError_.empty()) out += "last_error=" + lastError_ + "\n";
+    }
+    params->appendText(out);
+}
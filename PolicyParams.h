@@ -0,0 +1,110 @@
+#pragma once
+
+// PolicyParams.h
+// -----------------------------------------------------------------------------
+// Runtime-tunable policy thresholds and timers.
+//
+// PolicyRegistry holds the current PolicyParams snapshot as a shared_ptr.
+// Readers take a copy with current() (an atomic shared_ptr load) once per
+// decision and read every field from it. That load is not lock-free: libc++
+// guards it with a short internal lock from a global pool, but readers never
+// wait on the registry's mutex_ or on a reload in progress. A reload parses
+// the config file over the start-up defaults (built-in values + command
+// line), validates the complete set and publishes it with one atomic store,
+// so readers always see one consistent version. A replaced snapshot is freed
+// when its last reader drops its copy, however long that reader was
+// descheduled.
+//
+// The file is "key=value" lines ('#' starts a comment); unknown keys and out
+// of range values reject the whole file and keep the current set. The
+// directory is watched with inotify: IN_CLOSE_WRITE and IN_MOVED_TO pick up
+// in-place edits and atomic renames, and IN_DELETE reloads as well, so
+// deleting the file publishes the start-up defaults again.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#define PARAMS_LOG_TAG "SocDaemon_Params"
+#define PARAMSLOGI(...) __android_log_print(ANDROID_LOG_INFO, PARAMS_LOG_TAG, __VA_ARGS__)
+#define PARAMSLOGE(...) __android_log_print(ANDROID_LOG_ERROR, PARAMS_LOG_TAG, __VA_ARGS__)
+
+inline constexpr char kDefaultPolicyFile[] = "/data/vendor/socdaemon/policy.conf";
+
+struct PolicyParams {
+    bool sendHint = false;                                  // send_hint
+    bool sendGfxHint = false;                               // send_gfx_hint
+    std::chrono::milliseconds ccEntryDebounce{10000};       // cc_entry_debounce_ms, WltPredictor base
+    std::chrono::milliseconds ccExitDebounce{1000};         // cc_exit_debounce_ms, WltPredictor base
+    std::chrono::milliseconds ccExitRecheck{5000};          // cc_exit_recheck_ms, when the load did not rise
+    double sysloadEntryThreshold = 25.0;                    // sysload_entry_threshold, % for CC entry
+    double sysloadSlopeThreshold = 5.0;                     // sysload_slope_threshold, % rise that exits CC
+    double sysloadHighThreshold = 25.0;                     // sysload_high_threshold, SysLoadMonitor alert rises
+    double sysloadFallThreshold = 20.0;                     // sysload_fall_threshold, SysLoadMonitor alert clears
+    std::chrono::milliseconds sysloadHighMinAbove{2000};    // sysload_high_min_ms, time above before the alert
+    int gpuHighLoadPercent = 40;                            // gpu_high_load_percent, GPU idle % at high load
+
+    unsigned version = 0; // set by the registry on publish
+
+    // Applies "key=value" lines on top of this set. On failure sets `error` and returns false.
+    bool parse(const std::string& text, std::string& error);
+    bool validate(std::string& error) const;
+    void appendText(std::string& out) const;
+};
+
+class PolicyRegistry {
+public:
+    using Listener = std::function<void(const PolicyParams& params)>;
+
+    // `path` may be empty: the defaults are then fixed for the process lifetime.
+    PolicyRegistry(const PolicyParams& defaults, const std::string& path);
+    ~PolicyRegistry();
+
+    PolicyRegistry(const PolicyRegistry&) = delete;
+    PolicyRegistry& operator=(const PolicyRegistry&) = delete;
+
+    // Snapshot of the current parameter set; keep the copy for the whole decision.
+    std::shared_ptr<const PolicyParams> current() const noexcept {
+        return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+    }
+
+    // Called after every successful publish, from the reloading thread once the
+    // registry is unlocked. Calls are serialized and get the latest snapshot.
+    void setListener(Listener listener);
+
+    // Re-reads the file over the defaults; a missing file restores the defaults.
+    bool reload(std::string& error);
+
+    // Sets up the inotify watch. Returns -1 on failure (reload() still works).
+    int init();
+    // Reloads on file changes until stop(). Intended to be run in a dedicated thread.
+    void watchLoop();
+    void stop();
+
+    // Current set plus source, version and the last reload error.
+    void appendText(std::string& out) const;
+
+private:
+    void publish(std::unique_ptr<PolicyParams> params);
+
+    PolicyParams defaults_;
+    std::string path_;
+    std::string dir_;
+    std::string file_;
+
+    std::shared_ptr<const PolicyParams> current_; // std::atomic_load/atomic_store only
+    mutable std::mutex mutex_; // writers, listener_, lastError_
+    Listener listener_;
+    std::mutex listenerMutex_; // serializes listener calls outside mutex_
+    std::string lastError_;
+    unsigned nextVersion_ = 1;
+
+    int inotifyFd_ = -1;
+    int wakeFd_ = -1;
+    std::atomic<bool> shouldExit_{false};
+};
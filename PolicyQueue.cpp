@@ -0,0 +1,45 @@
+// -----------------------------------------------------------------------------
+// PolicyQueue.cpp
+//
+// Ordered hand-off from the SamplingClock thread to the policy thread.
+// -----------------------------------------------------------------------------
+
+#include "PolicyQueue.h"
+#include <algorithm>
+#include <cstring>
+
+void PolicyQueue::post(Task task, const char* key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (key && std::any_of(queue_.begin(), queue_.end(),
+                               [key](const Entry& entry) { return entry.key && !strcmp(entry.key, key); })) {
+            coalesced_++;
+            return;
+        }
+        queue_.push_back({std::move(task), key});
+    }
+    cv_.notify_one();
+}
+
+void PolicyQueue::run() {
+    PQLOGI("PolicyQueue: Policy thread started");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return !queue_.empty(); });
+        Entry entry = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        entry.task();
+        lock.lock();
+    }
+}
+
+size_t PolicyQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+uint64_t PolicyQueue::coalesced() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return coalesced_;
+}
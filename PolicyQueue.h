@@ -0,0 +1,50 @@
+#pragma once
+
+// PolicyQueue.h
+// -----------------------------------------------------------------------------
+// Hands work from the SamplingClock thread to the policy thread. The clock runs
+// at SCHED_IDLE so that sampling never competes with the foreground, but the
+// alerts it raises lead to containment exits and HAL calls, which are needed
+// most exactly when the contained cores are busy. Those run here instead, in
+// order, on the thread that calls run() (placed with applyPolicy()).
+//
+// A task posted with a key is dropped while another task with the same key is
+// still queued: a periodic source that the policy thread has not caught up
+// with yet does not pile up. Alerts are posted without a key and never dropped.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#define POLICY_QUEUE_LOG_TAG "SocDaemon_PolicyQueue"
+#define PQLOGI(...) __android_log_print(ANDROID_LOG_INFO, POLICY_QUEUE_LOG_TAG, __VA_ARGS__)
+
+class PolicyQueue {
+public:
+    using Task = std::function<void()>;
+
+    // key: coalescing key (a string literal), or nullptr to always queue.
+    void post(Task task, const char* key = nullptr);
+
+    // Runs the queued tasks in order; never returns.
+    void run();
+
+    size_t pending() const;
+    uint64_t coalesced() const;
+
+private:
+    struct Entry {
+        Task task;
+        const char* key;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Entry> queue_;
+    uint64_t coalesced_ = 0;
+};
@@ -0,0 +1,272 @@
+// -----------------------------------------------------------------------------
+// RaplMonitor.cpp
+//
+// RAPL energy sampling with per-state and per-episode attribution.
+// -----------------------------------------------------------------------------
+
+#include "RaplMonitor.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+constexpr char kPowercapRoot[] = "/sys/class/powercap";
+constexpr char kMmioPackageZone[] = "intel-rapl-mmio:0";
+constexpr const char* kDomainNames[] = {"package", "core", "uncore"};
+constexpr const char* kAccountNames[] = {"cc_state", "gfx_mode"};
+constexpr const char* kStateNames[RaplMonitor::kAccountCount][RaplMonitor::kStatesPerAccount] = {
+    {"Open", "CoreContainment"},
+    {"off", "on"},
+};
+
+std::string readZoneName(const std::string& zone) {
+    std::string path = std::string(kPowercapRoot) + "/" + zone + "/name";
+    FILE* f = fopen(path.c_str(), "re");
+    if (!f) return "";
+    char buf[64] = {};
+    if (!fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+    fclose(f);
+    buf[strcspn(buf, "\n")] = '\0';
+    return buf;
+}
+} // namespace
+
+RaplMonitor::RaplMonitor(const std::string& name, std::chrono::milliseconds baseTick)
+    : PeriodicMonitor(name, 1), baseTick_(baseTick) {
+    RAPLLOGD("RaplMonitor: Initializing '%s'", name.c_str());
+}
+
+RaplMonitor::~RaplMonitor() {
+    for (auto& domain : domains_) {
+        if (domain.fd >= 0) close(domain.fd);
+    }
+}
+
+bool RaplMonitor::readCounter(int fd, uint64_t& value_out) {
+    if (fd < 0) return false;
+    char buffer[32];
+    ssize_t bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (bytes_read <= 0) return false;
+    buffer[bytes_read] = '\0';
+    char* endptr = nullptr;
+    value_out = std::strtoull(buffer, &endptr, 10);
+    return endptr != buffer;
+}
+
+void RaplMonitor::openDomain(Domain domain, const std::string& zone) {
+    DomainNode& node = domains_[domain];
+    if (node.present) return;
+    std::string base = std::string(kPowercapRoot) + "/" + zone;
+
+    int rangeFd = open((base + "/max_energy_range_uj").c_str(), O_RDONLY | O_CLOEXEC);
+    uint64_t maxRange = 0;
+    bool haveRange = readCounter(rangeFd, maxRange);
+    if (rangeFd >= 0) close(rangeFd);
+
+    int fd = open((base + "/energy_uj").c_str(), O_RDONLY | O_CLOEXEC);
+    uint64_t value = 0;
+    if (fd < 0 || !haveRange || maxRange == 0 || !readCounter(fd, value)) {
+        if (fd >= 0) close(fd);
+        RAPLLOGI("RaplMonitor: %s energy not readable", base.c_str());
+        return;
+    }
+    node.fd = fd;
+    node.maxRangeUj = maxRange;
+    node.present = true;
+    RAPLLOGI("RaplMonitor: %s domain from %s (range %" PRIu64 " uJ)", kDomainNames[domain], base.c_str(), maxRange);
+}
+
+int RaplMonitor::init() {
+    DIR* dir = opendir(kPowercapRoot);
+    if (dir) {
+        std::vector<std::string> zones;
+        while (struct dirent* entry = readdir(dir)) {
+            if (!strncmp(entry->d_name, "intel-rapl:", strlen("intel-rapl:"))) zones.push_back(entry->d_name);
+        }
+        closedir(dir);
+
+        for (const auto& zone : zones) {
+            std::string zoneName = readZoneName(zone);
+            if (zoneName == "package-0") {
+                openDomain(kPackage, zone);
+            } else if (zoneName == "core") {
+                openDomain(kCore, zone);
+            } else if (zoneName == "uncore") {
+                openDomain(kUncore, zone);
+            }
+        }
+    }
+    // The MMIO interface exposes the package domain only (same zone powerhint_404.json limits).
+    openDomain(kPackage, kMmioPackageZone);
+
+    if (!domains_[kPackage].present) {
+        RAPLLOGE("RaplMonitor: No RAPL package energy counter available");
+        return -1;
+    }
+
+    uint64_t minRangeUj = UINT64_MAX;
+    for (const auto& domain : domains_) {
+        if (domain.present && domain.maxRangeUj < minRangeUj) minRangeUj = domain.maxRangeUj;
+    }
+    double guardMs = static_cast<double>(minRangeUj) / 1e3 / kMaxPackageW / 2.0;
+    double ticks = guardMs / static_cast<double>(std::max<long long>(baseTick_.count(), 1));
+    setPeriodTicks(ticks < 1.0 ? 1u : ticks > UINT32_MAX ? UINT32_MAX : static_cast<unsigned>(ticks));
+    RAPLLOGI("RaplMonitor: Wrap guard every %u tick(s) (%.0f s)", periodTicks(), guardMs / 1e3);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleLocked();
+    return 0;
+}
+
+void RaplMonitor::sampleLocked() {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - lastSampleTs_).count();
+    bool valid = haveLast_ && seconds > 0.0;
+    double energyJ[kDomainCount] = {};
+
+    for (int d = 0; d < kDomainCount; ++d) {
+        DomainNode& node = domains_[d];
+        if (!node.present) continue;
+        uint64_t value = 0;
+        if (!readCounter(node.fd, value)) {
+            if (d == kPackage) valid = false;
+            continue;
+        }
+        // energy_uj wraps at max_energy_range_uj; the wrap guard period keeps it to one per interval.
+        uint64_t delta = value >= node.lastUj ? value - node.lastUj : value + (node.maxRangeUj - node.lastUj);
+        energyJ[d] = static_cast<double>(delta) / 1e6;
+        node.lastUj = value;
+    }
+    lastSampleTs_ = now;
+    haveLast_ = true;
+    if (!valid) return;
+
+    currentPackageW_ = energyJ[kPackage] / seconds;
+    for (auto& account : accounts_) {
+        if (account.state < 0) continue;
+        for (int d = 0; d < kDomainCount; ++d) account.energyJ[account.state][d] += energyJ[d];
+        account.seconds[account.state] += seconds;
+    }
+    if (accounts_[kCcAccount].state == 1) {
+        episodeEnergyJ_ += energyJ[kPackage];
+        episodeSeconds_ += seconds;
+    } else if (accounts_[kCcAccount].state == 0) {
+        // Intervals are irregular (transitions, wrap guard): weigh each by its length.
+        if (openBaselineW_ < 0.0) {
+            openBaselineW_ = currentPackageW_;
+        } else {
+            openBaselineW_ += (1.0 - std::exp(-seconds / kOpenBaselineTau)) * (currentPackageW_ - openBaselineW_);
+        }
+    }
+}
+
+void RaplMonitor::sampleOnce() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleLocked();
+    RAPLLOGD("RaplMonitor: Wrap guard read, package %.2f W", currentPackageW_);
+}
+
+void RaplMonitor::setState(Account account, int state) {
+    if (state < 0 || state >= kStatesPerAccount) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleLocked();
+    AccountState& current = accounts_[account];
+    if (current.state == state) return;
+
+    if (account == kCcAccount && current.state == 1 && episodeSeconds_ > 0.0) {
+        Episode episode;
+        episode.durationS = episodeSeconds_;
+        episode.packageW = episodeEnergyJ_ / episodeSeconds_;
+        if (openBaselineW_ >= 0.0) {
+            episode.savedW = openBaselineW_ - episode.packageW;
+            savedJoules_ += episode.savedW * episode.durationS;
+        }
+        RAPLLOGI("RaplMonitor: Containment episode %.1fs at %.2f W, saved %.2f W against %.2f W Open", episode.durationS,
+                 episode.packageW, episode.savedW, openBaselineW_);
+        episodes_.push_back(episode);
+        if (episodes_.size() > kMaxEpisodes) episodes_.pop_front();
+    }
+    if (account == kCcAccount) {
+        episodeEnergyJ_ = 0.0;
+        episodeSeconds_ = 0.0;
+    }
+    current.state = state;
+}
+
+double RaplMonitor::averagePowerW(Account account, int state, Domain domain) const {
+    if (state < 0 || state >= kStatesPerAccount) return -1.0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const AccountState& a = accounts_[account];
+    if (!domains_[domain].present || a.seconds[state] <= 0.0) return -1.0;
+    return a.energyJ[state][domain] / a.seconds[state];
+}
+
+double RaplMonitor::currentPowerW() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return currentPackageW_;
+}
+
+double RaplMonitor::samplePowerW() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleLocked();
+    return currentPackageW_;
+}
+
+double RaplMonitor::savedJoules() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return savedJoules_;
+}
+
+void RaplMonitor::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[192];
+    snprintf(buf, sizeof(buf), "package_w=%.2f saved_j=%.1f\n", currentPackageW_, savedJoules_);
+    out += buf;
+    for (int a = 0; a < kAccountCount; ++a) {
+        for (int s = 0; s < kStatesPerAccount; ++s) {
+            const AccountState& account = accounts_[a];
+            double secs = account.seconds[s];
+            int n = snprintf(buf, sizeof(buf), "%s.%s seconds=%.1f", kAccountNames[a], kStateNames[a][s], secs);
+            for (int d = 0; d < kDomainCount && n < static_cast<int>(sizeof(buf)); ++d) {
+                if (!domains_[d].present) continue;
+                n += snprintf(buf + n, sizeof(buf) - n, " %s_w=%.2f", kDomainNames[d],
+                              secs > 0.0 ? account.energyJ[s][d] / secs : -1.0);
+            }
+            out += buf;
+            out += '\n';
+        }
+    }
+    for (const auto& episode : episodes_) {
+        snprintf(buf, sizeof(buf), "episode seconds=%.1f package_w=%.2f saved_w=%.2f\n", episode.durationS,
+                 episode.packageW, episode.savedW);
+        out += buf;
+    }
+}
+
+void RaplMonitor::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[192];
+    out += "# TYPE socdaemon_rapl_energy_joules counter\n";
+    for (int a = 0; a < kAccountCount; ++a) {
+        for (int s = 0; s < kStatesPerAccount; ++s) {
+            for (int d = 0; d < kDomainCount; ++d) {
+                if (!domains_[d].present) continue;
+                snprintf(buf, sizeof(buf), "socdaemon_rapl_energy_joules_total{var=\"%s\",state=\"%s\",domain=\"%s\"} %.3f\n",
+                         kAccountNames[a], kStateNames[a][s], kDomainNames[d], accounts_[a].energyJ[s][d]);
+                out += buf;
+            }
+        }
+    }
+    out += "# TYPE socdaemon_package_power_watts gauge\n";
+    snprintf(buf, sizeof(buf), "socdaemon_package_power_watts %.2f\n", currentPackageW_);
+    out += buf;
+    out += "# HELP socdaemon_containment_saved_joules Net package energy saved by containment episodes\n";
+    out += "# TYPE socdaemon_containment_saved_joules gauge\n";
+    snprintf(buf, sizeof(buf), "socdaemon_containment_saved_joules %.1f\n", savedJoules_);
+    out += buf;
+}
@@ -0,0 +1,126 @@
+#ifndef RAPLMONITOR_H
+#define RAPLMONITOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <android/log.h>
+
+#include "PeriodicMonitor.h"
+#include "SamplingClock.h"
+
+// Logging macros for RaplMonitor
+#define RAPL_LOG_TAG "SocDaemon_RaplMonitor"
+#define RAPLLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, RAPL_LOG_TAG, __VA_ARGS__)
+#define RAPLLOGI(...) __android_log_print(ANDROID_LOG_INFO, RAPL_LOG_TAG, __VA_ARGS__)
+#define RAPLLOGE(...) __android_log_print(ANDROID_LOG_ERROR, RAPL_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief RAPL energy counters attributed to policy states and containment episodes.
+ *
+ * Reads /sys/class/powercap/intel-rapl:<n>[:<m>]/energy_uj of the package,
+ * core and uncore domains (intel-rapl-mmio:0 as package fallback) through
+ * persistent descriptors. Counter wraparound is undone with max_energy_range_uj.
+ *
+ * The daemon reports its state with setState(); every call first samples the
+ * counters, so the energy since the previous sample is charged to the state
+ * that was in effect. This gives the average power per state of each account
+ * (CoreContainment Open/CC, GFX_MODE off/on) and, per containment episode, the
+ * average package power and the watts saved against the Open phase just before
+ * it (an EMA of the Open package power with time constant kOpenBaselineTau), not
+ * the all-time Open average that older, different workloads dominate.
+ *
+ * The counters are read at those transitions and when a consumer asks for
+ * power (samplePowerW()). The only periodic read is a wrap guard: its period
+ * is half the time the smallest max_energy_range_uj takes to wrap at
+ * kMaxPackageW, so no interval can see two wraps (tens of minutes on
+ * current parts).
+ *
+ * Never raises alerts.
+ */
+class RaplMonitor : public PeriodicMonitor {
+public:
+    enum Domain : int { kPackage = 0, kCore = 1, kUncore = 2, kDomainCount };
+    enum Account : int { kCcAccount = 0, kGfxAccount = 1, kAccountCount };
+    static constexpr int kStatesPerAccount = 2;
+
+    struct Episode {
+        double durationS = 0.0;
+        double packageW = 0.0;
+        double savedW = 0.0; // Open baseline minus episode average; 0 while no Open phase was measured
+    };
+
+    /**
+     * @param name Monitor name used for alerts.
+     * @param baseTick SamplingClock base tick the wrap guard period is expressed in.
+     */
+    explicit RaplMonitor(const std::string& name, std::chrono::milliseconds baseTick = kDefaultSamplingTick);
+    ~RaplMonitor() override;
+
+    // Opens energy_uj of every domain found and sizes the wrap guard. Returns -1 without a package domain.
+    int init() override;
+
+    // SamplingClock interface; the wrap guard runs whatever pause() says.
+    bool isSampling() const override { return true; }
+    void sampleOnce() override;
+
+    // Charges the energy so far to the current state of @p account, then switches to @p state.
+    void setState(Account account, int state);
+
+    // Average power (W) of @p domain while @p account was in @p state; -1 when not measured.
+    double averagePowerW(Account account, int state, Domain domain = kPackage) const;
+    // Package power over the last sample interval (the last transition, read or wrap guard).
+    double currentPowerW() const;
+    // Samples now (charging the interval to the current states) and returns the package power since
+    // the previous sample; lets a faster consumer (Pl1Controller) read current power.
+    double samplePowerW();
+    // Net energy saved by containment so far (J), summed over completed episodes; negative when
+    // containment cost more than it saved.
+    double savedJoules() const;
+
+    // "<account>.<state> <domain>_w=... seconds=..." lines and the last episodes.
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const;
+
+private:
+    struct DomainNode {
+        int fd = -1;
+        uint64_t maxRangeUj = 0;
+        uint64_t lastUj = 0;
+        bool present = false;
+    };
+
+    struct AccountState {
+        int state = -1;
+        double energyJ[kStatesPerAccount][kDomainCount] = {};
+        double seconds[kStatesPerAccount] = {};
+    };
+
+    void openDomain(Domain domain, const std::string& zone);
+    static bool readCounter(int fd, uint64_t& value_out);
+    // Reads all counters and charges the delta to the current states. Caller holds mutex_.
+    void sampleLocked();
+
+    std::chrono::milliseconds baseTick_;
+    DomainNode domains_[kDomainCount];
+
+    mutable std::mutex mutex_;
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    bool haveLast_ = false;
+    double currentPackageW_ = 0.0;
+    AccountState accounts_[kAccountCount];
+
+    // Containment episode in progress
+    double episodeEnergyJ_ = 0.0;
+    double episodeSeconds_ = 0.0;
+    std::deque<Episode> episodes_;
+    double savedJoules_ = 0.0;
+    double openBaselineW_ = -1.0; // EMA of the Open package power; -1 before the first Open interval
+    static constexpr size_t kMaxEpisodes = 16;
+    static constexpr double kOpenBaselineTau = 60.0; // s
+    static constexpr double kMaxPackageW = 300.0; // wrap guard sizing; above any client part's PL2
+};
+#endif // RAPLMONITOR_H
@@ -0,0 +1,113 @@
+// -----------------------------------------------------------------------------
+// ResidencyTracker.cpp
+//
+// Time-in-state accounting. See ResidencyTracker.h.
+// -----------------------------------------------------------------------------
+
+#include "ResidencyTracker.h"
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+// Dwell-time buckets (ms): from sub-second flapping up to half-hour residencies.
+const std::vector<uint64_t> kDwellBoundsMs = {100, 500, 1000, 2000, 5000, 10000, 30000, 60000, 300000, 1800000};
+} // namespace
+
+ResidencyTracker::ResidencyTracker(const std::string& name, std::vector<std::string> stateNames)
+    : name_(name), stateNames_(std::move(stateNames)), stats_(stateNames_.size()), resetMs_(nowMs()) {
+    for (auto& stats : stats_) {
+        stats.dwellMs = std::make_unique<Histogram>(kDwellBoundsMs);
+    }
+}
+
+int64_t ResidencyTracker::nowMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void ResidencyTracker::transition(int state) {
+    if (state < 0 || state >= static_cast<int>(stats_.size())) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state == current_) return;
+
+    int64_t now = nowMs();
+    if (current_ >= 0) {
+        int64_t dwell = now - enteredMs_;
+        stats_[current_].totalMs += dwell;
+        stats_[current_].dwellMs->record(static_cast<uint64_t>(dwell));
+    }
+    current_ = state;
+    enteredMs_ = now;
+    ++stats_[state].entries;
+}
+
+void ResidencyTracker::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+    for (auto& stats : stats_) {
+        stats.totalMs = 0;
+        stats.entries = 0;
+        stats.dwellMs->reset();
+    }
+    if (current_ >= 0) enteredMs_ = now;
+    resetMs_ = now;
+}
+
+int64_t ResidencyTracker::totalMsLocked(size_t state, int64_t now) const {
+    int64_t total = stats_[state].totalMs;
+    if (static_cast<int>(state) == current_) total += now - enteredMs_;
+    return total;
+}
+
+void ResidencyTracker::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+    int64_t window = now - resetMs_;
+    char buf[256];
+    for (size_t i = 0; i < stats_.size(); ++i) {
+        int64_t total = totalMsLocked(i, now);
+        snprintf(buf, sizeof(buf), "%s.%s time_ms=%lld entries=%" PRIu64 " fraction=%.4f%s\n", name_.c_str(),
+                 stateNames_[i].c_str(), static_cast<long long>(total), stats_[i].entries,
+                 window > 0 ? static_cast<double>(total) / window : 0.0,
+                 static_cast<int>(i) == current_ ? " current" : "");
+        out += buf;
+        stats_[i].dwellMs->appendText(out, name_ + "." + stateNames_[i] + ".dwell_ms");
+    }
+}
+
+void ResidencyTracker::appendOpenMetrics(std::string& out, const std::vector<const ResidencyTracker*>& trackers) {
+    char buf[256];
+
+    out += "# TYPE socdaemon_state_residency_seconds counter\n";
+    for (const auto* tracker : trackers) {
+        std::lock_guard<std::mutex> lock(tracker->mutex_);
+        int64_t now = nowMs();
+        for (size_t i = 0; i < tracker->stats_.size(); ++i) {
+            snprintf(buf, sizeof(buf), "socdaemon_state_residency_seconds_total{var=\"%s\",state=\"%s\"} %.3f\n",
+                     tracker->name_.c_str(), tracker->stateNames_[i].c_str(),
+                     tracker->totalMsLocked(i, now) / 1000.0);
+            out += buf;
+        }
+    }
+
+    out += "# TYPE socdaemon_state_entries counter\n";
+    for (const auto* tracker : trackers) {
+        std::lock_guard<std::mutex> lock(tracker->mutex_);
+        for (size_t i = 0; i < tracker->stats_.size(); ++i) {
+            snprintf(buf, sizeof(buf), "socdaemon_state_entries_total{var=\"%s\",state=\"%s\"} %" PRIu64 "\n",
+                     tracker->name_.c_str(), tracker->stateNames_[i].c_str(), tracker->stats_[i].entries);
+            out += buf;
+        }
+    }
+
+    out += "# TYPE socdaemon_state_dwell_seconds histogram\n";
+    for (const auto* tracker : trackers) {
+        for (size_t i = 0; i < tracker->stats_.size(); ++i) {
+            std::string labels = "var=\"" + tracker->name_ + "\",state=\"" + tracker->stateNames_[i] + "\"";
+            tracker->stats_[i].dwellMs->appendOpenMetrics(out, "socdaemon_state_dwell_seconds", labels, 1e-3);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// ResidencyTracker.h
+// -----------------------------------------------------------------------------
+// Time-in-state accounting for one discrete state variable (CC state, WLT,
+// GFX_MODE, ...). Each transition is O(1): the time spent in the state being
+// left is added to its total and recorded in its dwell-time histogram, and the
+// entry count of the new state is incremented. Time is measured on
+// CLOCK_BOOTTIME so residency fractions include suspend.
+// -----------------------------------------------------------------------------
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Histogram.h"
+
+class ResidencyTracker {
+public:
+    // States are dense indices into `stateNames`. The tracker starts in an
+    // unknown state (-1) that is not accounted until the first transition.
+    ResidencyTracker(const std::string& name, std::vector<std::string> stateNames);
+
+    ResidencyTracker(const ResidencyTracker&) = delete;
+    ResidencyTracker& operator=(const ResidencyTracker&) = delete;
+
+    // Enter `state`; no-op if already in it. Out-of-range states are ignored.
+    void transition(int state);
+
+    // Clear totals, entries and histograms; the current state keeps running from now.
+    void reset();
+
+    const std::string& name() const { return name_; }
+
+    // "<name>.<state> time_ms=.. entries=.. fraction=.." plus one dwell histogram line per state.
+    void appendText(std::string& out) const;
+
+    // OpenMetrics families covering all trackers (residency, entries, dwell histogram).
+    static void appendOpenMetrics(std::string& out, const std::vector<const ResidencyTracker*>& trackers);
+
+private:
+    struct StateStats {
+        int64_t totalMs = 0;
+        uint64_t entries = 0;
+        std::unique_ptr<Histogram> dwellMs;
+    };
+
+    static int64_t nowMs();
+    // Total including the ongoing dwell of the current state. Caller holds mutex_.
+    int64_t totalMsLocked(size_t state, int64_t now) const;
+
+    std::string name_;
+    std::vector<std::string> stateNames_;
+    std::vector<StateStats> stats_;
+    int current_ = -1;
+    int64_t enteredMs_ = 0;
+    int64_t resetMs_ = 0;
+    mutable std::mutex mutex_;
+};
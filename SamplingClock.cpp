@@ -0,0 +1,118 @@
+// -----------------------------------------------------------------------------
+// SamplingClock.cpp
+//
+// Shared tick for periodic monitors. See SamplingClock.h.
+// -----------------------------------------------------------------------------
+
+#include "SamplingClock.h"
+#include <sys/prctl.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+SamplingClock::SamplingClock(std::chrono::milliseconds baseTick, std::chrono::microseconds timerSlack)
+    : baseTick_(baseTick.count() > 0 ? baseTick : kDefaultSamplingTick), timerSlack_(timerSlack) {}
+
+SamplingClock::~SamplingClock() {
+    stop();
+}
+
+void SamplingClock::addSource(const std::string& name, unsigned periodTicks,
+                              std::function<bool()> isActive, std::function<void()> sample) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (periodTicks == 0) periodTicks = 1;
+    sources_.push_back({name, periodTicks, std::move(isActive), std::move(sample)});
+    CLOCKLOGI("SamplingClock: Added source '%s' every %u tick(s) (%lldms)", name.c_str(), periodTicks,
+              static_cast<long long>(periodTicks * baseTick_.count()));
+}
+
+void SamplingClock::start(std::function<void()> onThreadStart) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread([this, onThreadStart] {
+        if (onThreadStart) onThreadStart();
+        run();
+    });
+}
+
+void SamplingClock::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void SamplingClock::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeRequested_ = true;
+    }
+    cv_.notify_all();
+}
+
+long long SamplingClock::nextDueTick(std::chrono::steady_clock::time_point now) const {
+    // Absolute tick grid: every source aligns to multiples of its period.
+    long long current = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) / baseTick_;
+    long long next = -1;
+    for (const auto& source : sources_) {
+        if (source.isActive && !source.isActive()) continue;
+        long long due = (current / source.periodTicks + 1) * source.periodTicks;
+        if (next < 0 || due < next) next = due;
+    }
+    return next;
+}
+
+void SamplingClock::run() {
+    using clock = std::chrono::steady_clock;
+
+    // Timer slack lets the kernel batch our wakeup with other timers.
+    if (prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(timerSlack_).count())) != 0) {
+        CLOCKLOGE("SamplingClock: PR_SET_TIMERSLACK failed: %s", std::strerror(errno));
+    }
+    CLOCKLOGI("SamplingClock: Started with tick %lldms slack %lldus",
+              static_cast<long long>(baseTick_.count()), static_cast<long long>(timerSlack_.count()));
+
+    std::vector<const Source*> due;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        // Nothing to sample: block until a source is resumed.
+        long long tickIndex = nextDueTick(clock::now());
+        if (tickIndex < 0) {
+            CLOCKLOGD("SamplingClock: All sources idle, sleeping");
+            cv_.wait(lock, [this] { return !running_ || wakeRequested_; });
+            wakeRequested_ = false;
+            continue;
+        }
+
+        // Sleep through the ticks at which no active source is due.
+        clock::time_point deadline(std::chrono::milliseconds(tickIndex * baseTick_.count()));
+
+        cv_.wait_until(lock, deadline, [this] { return !running_ || wakeRequested_; });
+        if (!running_) break;
+        if (wakeRequested_) {
+            wakeRequested_ = false;
+            // Early: re-evaluate activity without sampling off-grid. Once the
+            // deadline has passed, the tick is due and is sampled as usual.
+            if (clock::now() < deadline) continue;
+        }
+
+        due.clear();
+        for (const auto& source : sources_) {
+            if (tickIndex % source.periodTicks != 0) continue;
+            if (source.isActive && !source.isActive()) continue;
+            due.push_back(&source);
+        }
+
+        lock.unlock();
+        for (const Source* source : due) {
+            source->sample();
+        }
+        lock.lock();
+    }
+    CLOCKLOGI("SamplingClock: Thread exiting");
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// SamplingClock.h
+// -----------------------------------------------------------------------------
+// A single wakeup train shared by every periodic monitor. Sources declare their
+// period as a multiple of the base tick; ticks are aligned to absolute
+// multiples of the base tick so that one wakeup services every source that is
+// due at that time. The clock thread sleeps until the next tick at which an
+// active source is due, runs with a configurable timer slack, and blocks
+// indefinitely while no source is active.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define CLOCK_LOG_TAG "SocDaemon_SamplingClock"
+#define CLOCKLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, CLOCK_LOG_TAG, __VA_ARGS__)
+#define CLOCKLOGI(...) __android_log_print(ANDROID_LOG_INFO, CLOCK_LOG_TAG, __VA_ARGS__)
+#define CLOCKLOGE(...) __android_log_print(ANDROID_LOG_ERROR, CLOCK_LOG_TAG, __VA_ARGS__)
+
+inline constexpr std::chrono::milliseconds kDefaultSamplingTick{1000};
+inline constexpr std::chrono::microseconds kDefaultTimerSlack{50000};
+
+class SamplingClock {
+public:
+    SamplingClock(std::chrono::milliseconds baseTick = kDefaultSamplingTick,
+                  std::chrono::microseconds timerSlack = kDefaultTimerSlack);
+    ~SamplingClock();
+
+    SamplingClock(const SamplingClock&) = delete;
+    SamplingClock& operator=(const SamplingClock&) = delete;
+
+    /**
+     * @brief Register a periodic source.
+     * @param name Name used in logs.
+     * @param periodTicks Period as a multiple of the base tick (>= 1).
+     * @param isActive Returns false while the source is paused; may be empty.
+     * @param sample Work to perform when the source is due.
+     */
+    void addSource(const std::string& name, unsigned periodTicks,
+                   std::function<bool()> isActive, std::function<void()> sample);
+
+    // Spawns the clock thread. The onThreadStart hook runs on that thread first.
+    void start(std::function<void()> onThreadStart = nullptr);
+    void stop();
+
+    // Re-evaluate source activity; call after resuming a paused source.
+    void wake();
+
+    std::chrono::milliseconds baseTick() const { return baseTick_; }
+
+private:
+    struct Source {
+        std::string name;
+        unsigned periodTicks;
+        std::function<bool()> isActive;
+        std::function<void()> sample;
+    };
+
+    void run();
+    // Index of the next tick at which an active source is due, or -1 if none is active.
+    long long nextDueTick(std::chrono::steady_clock::time_point now) const;
+
+    const std::chrono::milliseconds baseTick_;
+    const std::chrono::microseconds timerSlack_;
+
+    std::deque<Source> sources_; // deque: references stay valid while sampling unlocked
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool running_ = false;
+    bool wakeRequested_ = false;
+};
@@ -0,0 +1,282 @@
+// -----------------------------------------------------------------------------
+// SchedDelayMonitor.cpp
+//
+// Per-window run-queue wait of the top-app and foreground threads (per-task
+// schedstat) and of the contained CPUs (/proc/schedstat).
+// -----------------------------------------------------------------------------
+
+#include "SchedDelayMonitor.h"
+#include "HotThreadMonitor.h"
+#include "ThreadPlacement.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+const char* const kTaskLists[] = {"/dev/cpuset/top-app/tasks", "/dev/cpuset/foreground/tasks"};
+constexpr char kCpuSchedstat[] = "/proc/schedstat";
+constexpr size_t kMinCpuSchedstatSize = 4096;
+constexpr size_t kMaxCpuSchedstatSize = 1 << 20;
+} // namespace
+
+SchedDelayMonitor::SchedDelayMonitor(const std::string& name, const std::string& containedCpus,
+                                     unsigned periodTicks)
+    : PeriodicMonitor(name, periodTicks) {
+    cpu_set_t set;
+    if (!ThreadPlacement::parseCpuList(containedCpus, &set)) {
+        SCHEDLOGE("SchedDelayMonitor: Invalid contained CPU list '%s', using all CPUs", containedCpus.c_str());
+        CPU_ZERO(&set);
+        for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF) && cpu < CPU_SETSIZE; ++cpu) CPU_SET(cpu, &set);
+    }
+    contained_.assign(CPU_SETSIZE, false);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) contained_[cpu] = CPU_ISSET(cpu, &set);
+    SCHEDLOGD("SchedDelayMonitor: Initializing '%s' with a %u tick window", name.c_str(), periodTicks);
+}
+
+SchedDelayMonitor::~SchedDelayMonitor() {
+    untrackAll();
+    if (cpuSchedstatFd_ >= 0) close(cpuSchedstatFd_);
+}
+
+std::string SchedDelayMonitor::schedstatPath(pid_t tid) {
+    return "/proc/" + std::to_string(tid) + "/task/" + std::to_string(tid) + "/schedstat";
+}
+
+bool SchedDelayMonitor::parseSchedstat(const char* buffer, unsigned long long& waitNs, unsigned long long& slices) {
+    // "<time on cpu ns> <time waiting on a runqueue ns> <timeslices run>"
+    char* endptr = nullptr;
+    std::strtoull(buffer, &endptr, 10);
+    if (endptr == buffer) return false;
+    const char* p = endptr;
+    waitNs = std::strtoull(p, &endptr, 10);
+    if (endptr == p) return false;
+    p = endptr;
+    slices = std::strtoull(p, &endptr, 10);
+    return endptr != p;
+}
+
+bool SchedDelayMonitor::readTask(Task& task, pid_t tid, unsigned long long& waitNs, unsigned long long& slices) {
+    char buffer[96];
+    ssize_t bytes_read;
+    if (task.fd >= 0) {
+        bytes_read = pread(task.fd, buffer, sizeof(buffer) - 1, 0);
+    } else {
+        int fd = open(schedstatPath(tid).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        bytes_read = pread(fd, buffer, sizeof(buffer) - 1, 0);
+        close(fd);
+    }
+    if (bytes_read <= 0) return false;
+    buffer[bytes_read] = '\0';
+    return parseSchedstat(buffer, waitNs, slices);
+}
+
+bool SchedDelayMonitor::readCpuSchedstat(unsigned long long& delayNs, unsigned long long& slices) {
+    if (cpuSchedstatFd_ < 0) return false;
+    // One line per CPU plus one per sched domain level, so the size depends on
+    // the topology. A read that fills the buffer may be truncated: grow and retry.
+    ssize_t bytes_read;
+    while ((bytes_read = pread(cpuSchedstatFd_, cpuSchedstatBuffer_.data(), cpuSchedstatBuffer_.size() - 1, 0)) ==
+               static_cast<ssize_t>(cpuSchedstatBuffer_.size()) - 1 &&
+           cpuSchedstatBuffer_.size() < kMaxCpuSchedstatSize) {
+        cpuSchedstatBuffer_.resize(cpuSchedstatBuffer_.size() * 2);
+    }
+    if (bytes_read <= 0) return false;
+    cpuSchedstatBuffer_[bytes_read] = '\0';
+    return parseCpuSchedstat(cpuSchedstatBuffer_.data(), contained_, delayNs, slices);
+}
+
+bool SchedDelayMonitor::parseCpuSchedstat(const char* buffer, const std::vector<bool>& cpus,
+                                          unsigned long long& delayNs, unsigned long long& slices) {
+    delayNs = 0;
+    slices = 0;
+    bool found = false;
+    for (const char* line = buffer; line && *line;) {
+        // cpu<N> yld_count legacy sched_count sched_goidle ttwu_count ttwu_local rq_cpu_time run_delay pcount
+        if (!strncmp(line, "cpu", 3) && line[3] >= '0' && line[3] <= '9') {
+            char* endptr = nullptr;
+            long cpu = std::strtol(line + 3, &endptr, 10);
+            unsigned long long fields[9] = {};
+            int n = 0;
+            for (const char* p = endptr; n < 9; ++n) {
+                fields[n] = std::strtoull(p, &endptr, 10);
+                if (endptr == p) break;
+                p = endptr;
+            }
+            if (n == 9 && cpu >= 0 && cpu < static_cast<long>(cpus.size()) && cpus[cpu]) {
+                delayNs += fields[7];
+                slices += fields[8];
+                found = true;
+            }
+        }
+        line = strchr(line, '\n');
+        if (line) ++line;
+    }
+    return found;
+}
+
+int SchedDelayMonitor::init() {
+    std::vector<pid_t> tids;
+    if (!HotThreadMonitor::readTaskList(kTaskLists[0], tids)) {
+        SCHEDLOGE("SchedDelayMonitor: Cannot read %s: %s", kTaskLists[0], std::strerror(errno));
+        return -1;
+    }
+    int fd = open(schedstatPath(getpid()).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        SCHEDLOGE("SchedDelayMonitor: Per-task schedstat not available: %s", std::strerror(errno));
+        return -1;
+    }
+    close(fd);
+    cpuSchedstatFd_ = open(kCpuSchedstat, O_RDONLY | O_CLOEXEC);
+    if (cpuSchedstatFd_ < 0) {
+        SCHEDLOGI("SchedDelayMonitor: %s not available (CONFIG_SCHEDSTATS), per-task only", kCpuSchedstat);
+        return 0;
+    }
+    // Size the buffer once from a first read; it only grows again if the file does.
+    cpuSchedstatBuffer_.resize(kMinCpuSchedstatSize);
+    unsigned long long delayNs = 0, slices = 0;
+    readCpuSchedstat(delayNs, slices);
+    SCHEDLOGD("SchedDelayMonitor: %s buffer %zu bytes", kCpuSchedstat, cpuSchedstatBuffer_.size());
+    return 0;
+}
+
+void SchedDelayMonitor::untrackAll() {
+    for (auto& entry : tasks_) {
+        if (entry.second.fd >= 0) close(entry.second.fd);
+    }
+    tasks_.clear();
+    openFds_ = 0;
+}
+
+void SchedDelayMonitor::rescan(std::chrono::steady_clock::time_point now) {
+    nextScanTs_ = now + kRescanPeriod;
+    std::vector<pid_t> listed;
+    std::vector<pid_t> tids;
+    for (const char* list : kTaskLists) {
+        if (!HotThreadMonitor::readTaskList(list, tids)) continue;
+        listed.insert(listed.end(), tids.begin(), tids.end());
+    }
+    // A thread migrating between the groups can be listed twice.
+    std::sort(listed.begin(), listed.end());
+    listed.erase(std::unique(listed.begin(), listed.end()), listed.end());
+
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+        if (std::binary_search(listed.begin(), listed.end(), it->first)) {
+            ++it;
+            continue;
+        }
+        if (it->second.fd >= 0) {
+            close(it->second.fd);
+            openFds_--;
+        }
+        it = tasks_.erase(it);
+    }
+    for (pid_t tid : listed) {
+        auto inserted = tasks_.try_emplace(tid);
+        if (!inserted.second || openFds_ >= kMaxOpenFds) continue;
+        Task& task = inserted.first->second;
+        task.fd = open(schedstatPath(tid).c_str(), O_RDONLY | O_CLOEXEC);
+        if (task.fd >= 0) openFds_++;
+    }
+    SCHEDLOGD("SchedDelayMonitor: Rescanned, tracking %zu thread(s)", tasks_.size());
+}
+
+void SchedDelayMonitor::sampleOnce() {
+    if (consumeReset()) {
+        // Paused while open: baselines and the high streak are stale.
+        untrackAll();
+        nextScanTs_ = {};
+        haveCpuLast_ = false;
+        highWindows_ = 0;
+        high_ = 0;
+    }
+    auto now = std::chrono::steady_clock::now();
+    double windowNs = std::chrono::duration<double, std::nano>(now - lastSampleTs_).count();
+    lastSampleTs_ = now;
+    if (now >= nextScanTs_) rescan(now);
+
+    std::vector<double> delaysUs;
+    unsigned long long totalWaitNs = 0;
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+        Task& task = it->second;
+        unsigned long long waitNs = 0, slices = 0;
+        if (!readTask(task, it->first, waitNs, slices)) {
+            // Exited
+            if (task.fd >= 0) {
+                close(task.fd);
+                openFds_--;
+            }
+            it = tasks_.erase(it);
+            continue;
+        }
+        if (task.haveLast && slices > task.slices && waitNs >= task.waitNs) {
+            delaysUs.push_back(static_cast<double>(waitNs - task.waitNs) / 1000.0 / (slices - task.slices));
+            totalWaitNs += waitNs - task.waitNs;
+        }
+        task.waitNs = waitNs;
+        task.slices = slices;
+        task.haveLast = true;
+        ++it;
+    }
+
+    WindowStats stats;
+    stats.tracked = tasks_.size();
+    stats.tasks = delaysUs.size();
+    if (!delaysUs.empty()) {
+        size_t index = (delaysUs.size() * 95 + 99) / 100 - 1;
+        std::nth_element(delaysUs.begin(), delaysUs.begin() + index, delaysUs.end());
+        stats.p95DelayUs = delaysUs[index];
+        stats.maxDelayUs = *std::max_element(delaysUs.begin(), delaysUs.end());
+    }
+    if (windowNs > 0.0) stats.waitingTasks = static_cast<double>(totalWaitNs) / windowNs;
+
+    unsigned long long cpuDelayNs = 0, cpuSlices = 0;
+    if (readCpuSchedstat(cpuDelayNs, cpuSlices)) {
+        if (haveCpuLast_ && cpuSlices > lastCpuSlices_ && cpuDelayNs >= lastCpuDelayNs_) {
+            stats.cpuDelayUs = static_cast<double>(cpuDelayNs - lastCpuDelayNs_) / 1000.0 / (cpuSlices - lastCpuSlices_);
+        }
+        lastCpuDelayNs_ = cpuDelayNs;
+        lastCpuSlices_ = cpuSlices;
+        haveCpuLast_ = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_ = stats;
+    }
+    if (stats.tasks == 0) return; // first window after (re)start, or nothing ran
+    p95Us_.record(static_cast<uint64_t>(stats.p95DelayUs));
+    SCHEDLOGD("SchedDelayMonitor: p95 %.0fus max %.0fus over %zu task(s), contained CPUs %.0fus, waiting %.2f",
+              stats.p95DelayUs, stats.maxDelayUs, stats.tasks, stats.cpuDelayUs, stats.waitingTasks);
+
+    if (stats.p95DelayUs >= kHighDelayUs) {
+        highWindows_++;
+    } else {
+        highWindows_ = 0;
+    }
+    int high = high_;
+    if (!high_ && highWindows_ >= kHighWindows) high = 1;
+    if (high_ && stats.p95DelayUs < kHighDelayUs / 2) high = 0;
+    if (high != high_) {
+        SCHEDLOGI("SchedDelayMonitor: run delay high %d -> %d (p95 %.0fus over %zu task(s))", high_, high,
+                  stats.p95DelayUs, stats.tasks);
+        high_ = high;
+        onValueChanged(static_cast<int>(std::min(stats.p95DelayUs, 1e9)), high);
+    }
+}
+
+SchedDelayMonitor::WindowStats SchedDelayMonitor::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void SchedDelayMonitor::appendHistogram(std::string& out) const {
+    p95Us_.appendText(out, "sched_delay_window_p95_us");
+}
+
+void SchedDelayMonitor::appendOpenMetrics(std::string& out) const {
+    p95Us_.appendOpenMetrics(out, "socdaemon_sched_delay_window_p95_seconds", "", 1e-6);
+}
@@ -0,0 +1,119 @@
+#ifndef SCHEDDELAYMONITOR_H
+#define SCHEDDELAYMONITOR_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include <android/log.h>
+
+#include "Histogram.h"
+#include "PeriodicMonitor.h"
+
+// Default sampler period (one delay window) is 2 base ticks.
+static constexpr unsigned g_schedDelaySamplerPeriodTicksDefault = 2;
+
+// Logging macros for SchedDelayMonitor
+#define SCHED_DELAY_LOG_TAG "SocDaemon_SchedDelayMonitor"
+#define SCHEDLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, SCHED_DELAY_LOG_TAG, __VA_ARGS__)
+#define SCHEDLOGI(...) __android_log_print(ANDROID_LOG_INFO, SCHED_DELAY_LOG_TAG, __VA_ARGS__)
+#define SCHEDLOGE(...) __android_log_print(ANDROID_LOG_ERROR, SCHED_DELAY_LOG_TAG, __VA_ARGS__)
+
+/**
+ * @brief Run-queue wait of the foreground tasks, from schedstat.
+ *
+ * Every kRescanPeriod the monitor reads the thread lists of the top-app and
+ * foreground cpusets to refresh the tracked set; every window it reads only
+ * /proc/<tid>/task/<tid>/schedstat ("<run ns> <wait ns> <timeslices>") of the
+ * tracked threads. A thread that ran in the window contributes its mean wait
+ * per timeslice; the window's signal is the p95 over those threads. Up to
+ * kMaxOpenFds threads keep a persistent descriptor, the rest are read
+ * one-shot. Threads that exit are dropped when their read fails; new ones are
+ * picked up at the next rescan. /proc/schedstat adds the same ratio summed
+ * over the contained CPUs (field 8 run_delay / field 9 timeslices of each cpuN
+ * line).
+ *
+ * The alert is raised only on edges of "foreground tasks are waiting to run":
+ * set after kHighWindows consecutive windows with p95 >= kHighDelayUs, cleared
+ * when p95 falls below half of it. It carries (p95 delay in us, high).
+ */
+class SchedDelayMonitor : public PeriodicMonitor {
+public:
+    /**
+     * @param name Monitor name used for alerts.
+     * @param containedCpus CPU list the foreground groups are confined to in containment, e.g. "4-7".
+     * @param periodTicks Window length in SamplingClock base ticks.
+     */
+    SchedDelayMonitor(const std::string& name, const std::string& containedCpus,
+                      unsigned periodTicks = g_schedDelaySamplerPeriodTicksDefault);
+
+    ~SchedDelayMonitor() override;
+
+    // Returns -1 if the top-app task list or per-task schedstat is not available.
+    int init() override;
+
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
+
+    struct WindowStats {
+        double p95DelayUs = 0.0;        // per-thread mean wait per timeslice, p95 over threads
+        double maxDelayUs = 0.0;
+        double cpuDelayUs = -1.0;       // contained CPUs from /proc/schedstat, -1 when not available
+        double waitingTasks = 0.0;      // total wait / window: average number of runnable-but-waiting tasks
+        size_t tasks = 0;               // threads that ran in the window
+        size_t tracked = 0;             // threads tracked since the last rescan
+    };
+
+    WindowStats getStats() const;
+    // p95 of every window (us): one observation per window, not per-thread delays.
+    void appendHistogram(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const; // histogram samples only; the caller writes # HELP/# TYPE
+
+    // Per-task schedstat: "<run ns> <wait ns> <timeslices>".
+    static bool parseSchedstat(const char* buffer, unsigned long long& waitNs, unsigned long long& slices);
+    // /proc/schedstat: run_delay and timeslices summed over the cpuN lines set in `cpus`.
+    static bool parseCpuSchedstat(const char* buffer, const std::vector<bool>& cpus,
+                                  unsigned long long& delayNs, unsigned long long& slices);
+
+private:
+    struct Task {
+        int fd = -1; // -1: read one-shot
+        unsigned long long waitNs = 0;
+        unsigned long long slices = 0;
+        bool haveLast = false;
+    };
+
+    static std::string schedstatPath(pid_t tid);
+    bool readTask(Task& task, pid_t tid, unsigned long long& waitNs, unsigned long long& slices);
+    // Sum of run_delay / timeslices over the contained CPUs.
+    bool readCpuSchedstat(unsigned long long& delayNs, unsigned long long& slices);
+    // Re-reads the task lists: tracks new threads and drops unlisted ones.
+    void rescan(std::chrono::steady_clock::time_point now);
+    void untrackAll();
+
+    std::vector<bool> contained_; // indexed by CPU number
+    int cpuSchedstatFd_ = -1;
+    std::vector<char> cpuSchedstatBuffer_; // sized to the file by init(), grown if it no longer fits
+    unsigned long long lastCpuDelayNs_ = 0;
+    unsigned long long lastCpuSlices_ = 0;
+    bool haveCpuLast_ = false;
+
+    std::map<pid_t, Task> tasks_; // clock thread only
+    size_t openFds_ = 0;
+    std::chrono::steady_clock::time_point nextScanTs_{};
+    std::chrono::steady_clock::time_point lastSampleTs_{};
+    int highWindows_ = 0;
+    int high_ = 0;
+
+    mutable std::mutex statsMutex_;
+    WindowStats stats_;
+    Histogram p95Us_{{250, 500, 1000, 2000, 4000, 8000, 16000, 32000}};
+
+    static constexpr double kHighDelayUs = 4000.0;
+    static constexpr int kHighWindows = 2;
+    static constexpr size_t kMaxOpenFds = 256;
+    static constexpr std::chrono::seconds kRescanPeriod{10};
+};
+#endif // SCHEDDELAYMONITOR_H
@@ -0,0 +1,120 @@
+// -----------------------------------------------------------------------------
+// ShadowPolicy.cpp
+//
+// Record-only containment policy compared against the active one. See
+// ShadowPolicy.h.
+// -----------------------------------------------------------------------------
+
+#include "ShadowPolicy.h"
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+const char* stateName(bool contained) {
+    return contained ? "CoreContainment" : "Open";
+}
+} // namespace
+
+ShadowPolicy::ShadowPolicy(const FusionConfig& config) : engine_("shadow", config) {}
+
+int64_t ShadowPolicy::nowMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void ShadowPolicy::update(FusionSignal signal, double value, double confidence) {
+    engine_.update(signal, value, confidence);
+}
+
+void ShadowPolicy::accountTime(int64_t now) {
+    if (!started_) return;
+    uint64_t elapsed = static_cast<uint64_t>(now - lastEvalMs_);
+    (shadowContained_ == activeContained_ ? agreeMs_ : divergeMs_) += elapsed;
+}
+
+void ShadowPolicy::evaluate(bool activeContained, const char* reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FusionEngine::Decision decision = engine_.decide(shadowContained_);
+    int64_t now = nowMs();
+    accountTime(now);
+    lastEvalMs_ = now;
+
+    bool wasDiverging = started_ && shadowContained_ != activeContained_;
+    if (started_ && activeContained != activeContained_) activeTransitions_++;
+    activeContained_ = activeContained;
+    if (decision == FusionEngine::Decision::Enter && !shadowContained_) {
+        shadowContained_ = true;
+        shadowTransitions_++;
+    } else if (decision == FusionEngine::Decision::Exit && shadowContained_) {
+        shadowContained_ = false;
+        shadowTransitions_++;
+    }
+    started_ = true;
+
+    bool diverging = shadowContained_ != activeContained_;
+    if (diverging == wasDiverging) return;
+
+    std::string inputs;
+    engine_.appendInputs(inputs);
+    if (diverging) {
+        Divergence episode;
+        episode.startMs = now;
+        episode.activeContained = activeContained_;
+        episode.shadowContained = shadowContained_;
+        episode.reason = reason;
+        episode.inputs = inputs;
+        episodes_.push_back(std::move(episode));
+        if (episodes_.size() > kMaxEpisodes) episodes_.pop_front();
+        divergences_++;
+        SHADOWLOGI("ShadowPolicy: Divergence start (%s): active=%s shadow=%s %s", reason, stateName(activeContained_),
+                   stateName(shadowContained_), inputs.c_str());
+    } else {
+        if (!episodes_.empty() && episodes_.back().durationMs < 0) {
+            episodes_.back().durationMs = now - episodes_.back().startMs;
+        }
+        SHADOWLOGI("ShadowPolicy: Divergence end (%s) after %" PRId64 " ms: both %s %s", reason,
+                   episodes_.empty() ? int64_t{0} : episodes_.back().durationMs, stateName(activeContained_),
+                   inputs.c_str());
+    }
+}
+
+void ShadowPolicy::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowMs();
+    uint64_t agree = agreeMs_, diverge = divergeMs_;
+    if (started_) (shadowContained_ == activeContained_ ? agree : diverge) += static_cast<uint64_t>(now - lastEvalMs_);
+
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "active=%s shadow=%s agree_ms=%" PRIu64 " diverge_ms=%" PRIu64 " divergences=%" PRIu64
+             " active_transitions=%" PRIu64 " shadow_transitions=%" PRIu64 "\n",
+             stateName(activeContained_), stateName(shadowContained_), agree, diverge, divergences_,
+             activeTransitions_, shadowTransitions_);
+    out += buf;
+    engine_.appendText(out);
+    for (const auto& episode : episodes_) {
+        snprintf(buf, sizeof(buf), "divergence age_ms=%" PRId64 " duration_ms=%" PRId64 " active=%s shadow=%s reason=%s ",
+                 now - episode.startMs, episode.durationMs, stateName(episode.activeContained),
+                 stateName(episode.shadowContained), episode.reason.c_str());
+        out += buf;
+        out += episode.inputs;
+        out += '\n';
+    }
+}
+
+void ShadowPolicy::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "# TYPE socdaemon_shadow_agreement_seconds counter\n"
+             "socdaemon_shadow_agreement_seconds_total{result=\"agree\"} %.3f\n"
+             "socdaemon_shadow_agreement_seconds_total{result=\"diverge\"} %.3f\n"
+             "# TYPE socdaemon_shadow_divergences counter\nsocdaemon_shadow_divergences_total %" PRIu64 "\n"
+             "# TYPE socdaemon_policy_transitions counter\n"
+             "socdaemon_policy_transitions_total{policy=\"active\"} %" PRIu64 "\n"
+             "socdaemon_policy_transitions_total{policy=\"shadow\"} %" PRIu64 "\n",
+             agreeMs_ / 1000.0, divergeMs_ / 1000.0, divergences_, activeTransitions_, shadowTransitions_);
+    out += buf;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// ShadowPolicy.h
+// -----------------------------------------------------------------------------
+// A second containment policy that sees the same inputs as the active one but
+// never acts. It runs a FusionEngine with its own weights/bands, keeps the
+// containment state it would have had, and compares it with the state the
+// daemon actually applied on every evaluation.
+//
+// A divergence episode starts when the two states differ and ends when they
+// agree again; start and end are logged with both decisions and the inputs at
+// that time, and the last episodes are kept for the control socket. Time spent
+// agreeing/diverging and the transitions of each policy are counted, so a new
+// threshold set can be judged on live workloads before it is made active.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "FusionEngine.h"
+
+#define SHADOW_LOG_TAG "SocDaemon_Shadow"
+#define SHADOWLOGI(...) __android_log_print(ANDROID_LOG_INFO, SHADOW_LOG_TAG, __VA_ARGS__)
+
+class ShadowPolicy {
+public:
+    explicit ShadowPolicy(const FusionConfig& config);
+
+    // Same inputs as the active fusion engine.
+    void update(FusionSignal signal, double value, double confidence = 1.0);
+
+    // Re-evaluate the shadow decision and compare it with the applied state.
+    void evaluate(bool activeContained, const char* reason);
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const;
+
+private:
+    struct Divergence {
+        int64_t startMs = 0;
+        int64_t durationMs = -1; // -1 while open
+        bool activeContained = false;
+        bool shadowContained = false;
+        std::string reason;
+        std::string inputs;
+    };
+
+    static int64_t nowMs();
+    void accountTime(int64_t now); // caller holds mutex_
+
+    FusionEngine engine_;
+
+    mutable std::mutex mutex_;
+    bool started_ = false;
+    bool shadowContained_ = false;
+    bool activeContained_ = false;
+    int64_t lastEvalMs_ = 0;
+    uint64_t agreeMs_ = 0;
+    uint64_t divergeMs_ = 0;
+    uint64_t divergences_ = 0;
+    uint64_t shadowTransitions_ = 0;
+    uint64_t activeTransitions_ = 0;
+    std::deque<Divergence> episodes_;
+    static constexpr size_t kMaxEpisodes = 16;
+};
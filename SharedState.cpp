@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// SharedState.cpp
+//
+// Seqlock writer of the memory-mapped state block. See SharedState.h.
+// -----------------------------------------------------------------------------
+
+#include "SharedState.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+SharedStateWriter::SharedStateWriter(const std::string& path) : path_(path) {}
+
+SharedStateWriter::~SharedStateWriter() {
+    if (block_) munmap(block_, sizeof(SharedStateBlock));
+}
+
+uint64_t SharedStateWriter::monotonicNs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+int SharedStateWriter::init() {
+    if (path_.empty()) return -1;
+    // Not truncated: readers of a previous instance keep a valid mapping.
+    int fd = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        SHMLOGE("SharedState: Failed to open %s: %s", path_.c_str(), std::strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(SharedStateBlock)) != 0) {
+        SHMLOGE("SharedState: Failed to size %s: %s", path_.c_str(), std::strerror(errno));
+        close(fd);
+        return -1;
+    }
+    void* addr = mmap(nullptr, sizeof(SharedStateBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        SHMLOGE("SharedState: Failed to map %s: %s", path_.c_str(), std::strerror(errno));
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    block_ = static_cast<SharedStateBlock*>(addr);
+    // Continue the previous sequence so a reader racing the restart retries
+    // instead of accepting a torn copy; an odd value left by a crash is closed.
+    uint32_t seq = block_->magic == kSharedStateMagic ? block_->seq.load(std::memory_order_relaxed) : 0;
+    seq |= 1;
+    block_->seq.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    block_->magic = kSharedStateMagic;
+    block_->version = kSharedStateVersion;
+    block_->payloadSize = sizeof(SharedStatePayload);
+    block_->reserved = 0;
+    block_->payload = SharedStatePayload();
+    block_->payload.updatedNs = monotonicNs();
+    block_->seq.store(seq + 1, std::memory_order_release);
+    SHMLOGI("SharedState: Publishing %zu bytes at %s", sizeof(SharedStateBlock), path_.c_str());
+    return 0;
+}
+
+void SharedStateWriter::publish(const SharedStatePayload& state, const char* decisionReason) {
+    if (!block_) return;
+    uint64_t now = monotonicNs();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decisionReason) {
+        decisionNs_ = now;
+        decisions_++;
+        snprintf(decisionReason_, sizeof(decisionReason_), "%s", decisionReason);
+    }
+    SharedStatePayload payload = state;
+    payload.updatedNs = now;
+    payload.decisionNs = decisionNs_;
+    payload.decisions = decisions_;
+    std::memcpy(payload.decisionReason, decisionReason_, sizeof(payload.decisionReason));
+
+    uint32_t seq = block_->seq.load(std::memory_order_relaxed);
+    block_->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&block_->payload, &payload, sizeof(payload));
+    block_->seq.store(seq + 2, std::memory_order_release);
+    updates_++;
+}
+
+uint64_t SharedStateWriter::updates() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return updates_;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+// SharedState.h
+// -----------------------------------------------------------------------------
+// Fused daemon state published in a small memory-mapped file so that other
+// processes (Power HAL, perf HUD, benchmark agents) can sample it at any rate
+// without IPC: map the file read-only once, then call readSharedState().
+//
+// The block is a fixed, versioned layout guarded by a seqlock: the writer makes
+// seq odd, updates the payload and makes it even again; a reader retries while
+// seq is odd or changed during its copy. The daemon keeps the same file (and
+// seq) across restarts, so existing mappings stay valid. The default path is
+// on tmpfs: updates never reach flash.
+//
+// Readers only need the layout and readSharedState() below; the writer class
+// at the end is the daemon side.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#define SHARED_STATE_LOG_TAG "SocDaemon_SharedState"
+#define SHMLOGI(...) __android_log_print(ANDROID_LOG_INFO, SHARED_STATE_LOG_TAG, __VA_ARGS__)
+#define SHMLOGE(...) __android_log_print(ANDROID_LOG_ERROR, SHARED_STATE_LOG_TAG, __VA_ARGS__)
+
+inline constexpr char kDefaultSharedStateFile[] = "/dev/socdaemon/state";
+inline constexpr uint32_t kSharedStateMagic = 0x44434f53; // "SOCD"
+inline constexpr uint16_t kSharedStateVersion = 1;
+
+// Version 1 payload. New fields are only ever appended (bump the version).
+struct SharedStatePayload {
+    int32_t ccState = 0;         // 0 Open, 1 CoreContainment
+    int32_t efficientMode = 0;   // last EFFICIENT_POWER value sent
+    int32_t gfxMode = 0;         // last GFX_MODE value sent
+    int32_t wlt = -1;            // last raw workload_type_index, -1 when unknown
+    int32_t thermalPressure = 0; // 0 normal, 1 near a trip, 2 trip crossed
+    int32_t reserved0 = 0;
+    float sysCpuLoad = -1.0f;    // filtered system load (%)
+    float gpuBusyPercent = -1.0f;
+    float gpuWeightedLoad = -1.0f;
+    float fusionScore = -1.0f;   // -1 outside --sochint fusion
+    uint64_t updatedNs = 0;      // CLOCK_MONOTONIC of this update
+    uint64_t decisionNs = 0;     // CLOCK_MONOTONIC of the last EFFICIENT_POWER/GFX_MODE decision
+    uint64_t decisions = 0;      // number of decisions since the daemon started
+    char decisionReason[32] = {}; // reason of the last decision, NUL-terminated (truncated)
+};
+static_assert(sizeof(SharedStatePayload) == 96, "SharedStatePayload layout changed");
+
+struct SharedStateBlock {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t payloadSize;
+    std::atomic<uint32_t> seq; // odd while the payload is being written
+    uint32_t reserved;
+    SharedStatePayload payload;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seq must be usable across processes");
+static_assert(sizeof(SharedStateBlock) == 112, "SharedStateBlock layout changed");
+
+// Consistent copy of the payload. Returns false if the block is not a
+// compatible socdaemon state block, or the writer kept it busy for maxRetries.
+inline bool readSharedState(const SharedStateBlock* block, SharedStatePayload& out, int maxRetries = 1000) {
+    if (block->magic != kSharedStateMagic || block->version != kSharedStateVersion ||
+        block->payloadSize < sizeof(SharedStatePayload)) {
+        return false;
+    }
+    const std::atomic<uint32_t>& seq = block->seq;
+    for (int i = 0; i < maxRetries; ++i) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        std::memcpy(&out, &block->payload, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
+
+class SharedStateWriter {
+public:
+    explicit SharedStateWriter(const std::string& path);
+    ~SharedStateWriter();
+
+    SharedStateWriter(const SharedStateWriter&) = delete;
+    SharedStateWriter& operator=(const SharedStateWriter&) = delete;
+
+    // Creates/maps the file. Returns -1 on failure (the writer stays disabled).
+    int init();
+    bool enabled() const { return block_ != nullptr; }
+
+    // Publishes a new state. updatedNs and the decision fields are filled in
+    // here; decisionReason is non-null when this update is a policy decision.
+    void publish(const SharedStatePayload& state, const char* decisionReason);
+
+    uint64_t updates() const;
+
+    static uint64_t monotonicNs();
+
+private:
+    std::string path_;
+    SharedStateBlock* block_ = nullptr;
+
+    mutable std::mutex mutex_; // one writer at a time; readers use the seqlock
+    uint64_t decisionNs_ = 0;
+    uint64_t decisions_ = 0;
+    char decisionReason_[sizeof(SharedStatePayload::decisionReason)] = {};
+    uint64_t updates_ = 0;
+};
@@ -1,8 +1,26 @@
 #include "SocDaemon.h"
 #include "GpuRc6Monitor.h"
+#include <cinttypes>
+#include <cstring>
 
-SocDaemon::SocDaemon(bool sendHint, bool sendGfxHint, const std::string& socHint, int notificationDelay) noexcept
-    : sendHint_(sendHint), sendGfxHint_(sendGfxHint), socHint_(socHint), notificationDelay_(notificationDelay) {
+SocDaemon::SocDaemon(bool sendHint, bool sendGfxHint, const std::string& socHint, int notificationDelay,
+                     const SocDaemonOptions& options) noexcept
+    : samplingClock_(options.sampleTick, options.timerSlack),
+      placement_(options.placement),
+      socHint_(socHint), notificationDelay_(notificationDelay),
+      options_(options),
+      policy_([&] {
+          PolicyParams defaults;
+          defaults.sendHint = sendHint;
+          defaults.sendGfxHint = sendGfxHint;
+          return defaults;
+      }(), options.policyFile),
+      checkpoint_(options.stateFile, options.stateMaxAge),
+      sharedState_(options.sharedStateFile),
+      efficientGovernor_("EFFICIENT_POWER", options.hintGovernor, 0),
+      gfxGovernor_("GFX_MODE", options.hintGovernor, 1),
+      fusionEngine_("fusion", options.fusion),
+      shadowPolicy_(options.shadowPolicy ? std::make_unique<ShadowPolicy>(options.shadowFusion) : nullptr) {
     startDebounceThreadOnce();
 }
 
@@ -13,77 +31,449 @@ void SocDaemon::start() {
         ALOGI("SocDaemon: socHint is set to %s", socHint_.c_str());
     }
 
-    // Only add WltMonitor if socHint_ is "wlt" or "swlt"
-    if (socHint_ == "wlt" || socHint_ == "swlt") {
-        auto wltMonitorPtr = std::make_unique<WltMonitor>(
+    // Keep the daemon itself off the cores it parks. The main thread is placed
+    // first: the HAL connection and probe threads it spawns inherit its
+    // affinity and nice value.
+    placement_.joinCgroup();
+    placement_.applyPolicy();
+
+    watchdog_.setAlertCallback([this](const Watchdog::Alert& alert) { handleWatchdogAlert(alert); });
+    halEfficientCall_ = watchdog_.addDeadline("hal.EFFICIENT_POWER", options_.halDeadline);
+    halGfxCall_ = watchdog_.addDeadline("hal.GFX_MODE", options_.halDeadline);
+    if (options_.tuning.backend == TuneBackend::Hint) {
+        halTuneCall_ = watchdog_.addDeadline("hal.TUNE", options_.halDeadline);
+    }
+
+    // The HAL connection is off the startup path: hints decided before it is
+    // reachable are buffered as desired state and flushed on connection.
+    int halReady = readiness_.add("PowerHAL");
+    hintManager.connectAsync([this, halReady](bool connected, size_t delivered,
+                                              const std::map<std::string, bool>& undelivered) {
+        readiness_.set(halReady, connected);
+        if (connected) readiness_.mark(StartupReadiness::kHalReady);
+        ALOGI("SocDaemon: Power HAL %s, %zu buffered hint(s) delivered, %zu not", connected ? "connected" : "unreachable",
+              delivered, undelivered.size());
+        handleUndeliveredHints(connected, undelivered);
+    });
+
+    // The slow probes (workload_hint enable, genetlink family resolution, GPU
+    // sysfs discovery) run concurrently, each on its own thread. A monitor is
+    // started as soon as its own probe has finished and the policy core below
+    // is up, so one slow probe never holds back the others. Their watchdog
+    // channels are registered here, before the watchdog runs, and only timed
+    // once the monitor has started.
+    std::promise<void> coreUp;
+    std::shared_future<void> coreStarted = coreUp.get_future().share();
+    std::vector<std::future<void>> probes;
+    monitorsStarting_ = 1; // the policy core itself
+
+    // Only add WltMonitor if socHint_ is "wlt", "swlt" or "fusion", or as a shadow policy or tuning ladder input
+    if (socHint_ == "wlt" || socHint_ == "swlt" || fusionMode() || shadowPolicy_ ||
+        options_.tuning.backend != TuneBackend::None) {
+        auto wltMonitor = std::make_unique<WltMonitor>(
             "WltMonitor",
             "/sys/devices/pci0000:00/0000:00:04.0/workload_hint/workload_type_index",
-            -1,
+            kWltPollTimeoutMs,
             notificationDelay_);
+        WltMonitor* raw = wltMonitor.get();
+        int watch = watchMonitor(raw, [this, raw] { return wltMonitorPtr_.load() == raw; });
+        int id = readiness_.add(raw->name());
+        monitorsStarting_++;
+        probes.push_back(std::async(std::launch::async, [this, coreStarted, watch, id,
+                                                         monitor = std::move(wltMonitor)]() mutable {
+            if (monitor->init() < 0) {
+                ALOGE("SocDaemon: WltMonitor initialization failed, not adding to monitors_.");
+                readiness_.set(id, false);
+            } else {
+                coreStarted.wait();
+                wltMonitorPtr_ = monitor.get();
+                startMonitor(std::move(monitor), watch);
+                readiness_.set(id, true);
+            }
+            monitorStartDone();
+        }));
+    }
 
-        if (wltMonitorPtr->init() < 0) {
-            ALOGE("SocDaemon: WltMonitor initialization failed, not adding to monitors_.");
-        } else {
-            monitors_.push_back(std::move(wltMonitorPtr));
-        }
+    // Fusion (and the shadow policy) combines WLT and HFI, so both may run side by side.
+    // The thermal netlink socket is always opened: its trip/temperature events are a
+    // containment input in every mode, the HFI hint only acts in hfi/fusion/shadow.
+    {
+        auto hfiMonitor = std::make_unique<HfiMonitor>("HfiMonitor");
+        HfiMonitor* raw = hfiMonitor.get();
+        int watch = watchMonitor(raw, [this, raw] { return hfiMonitorPtr_.load() == raw; });
+        int id = readiness_.add(raw->name());
+        monitorsStarting_++;
+        probes.push_back(std::async(std::launch::async, [this, coreStarted, watch, id,
+                                                         monitor = std::move(hfiMonitor)]() mutable {
+            if (monitor->init() < 0) {
+                ALOGE("SocDaemon: HfiMonitor initialization failed, not adding to monitors_.");
+                readiness_.set(id, false);
+            } else {
+                coreStarted.wait();
+                hfiMonitorPtr_ = monitor.get(); // non-owning pointer
+                startMonitor(std::move(monitor), watch);
+                readiness_.set(id, true);
+            }
+            monitorStartDone();
+        }));
+    }
+
+    // Prefer the frequency/throttle aware GpuLoadMonitor; fall back to plain RC6 residency.
+    // Both start paused for WLT Idle/Btl.
+    {
+        auto gpuLoadMonitor = std::make_unique<GpuLoadMonitor>(
+            "GpuLoadMonitor",
+            "/sys/class/drm/card0/device/tile0/gt0");
+        gpuLoadMonitor->pause();
+        auto gpuRc6Monitor = std::make_unique<GpuRc6Monitor>(
+            "GpuRc6Monitor",
+            "/sys/class/drm/card0/device/tile0/gt0/gtidle/idle_residency_ms"
+        );
+        gpuRc6Monitor->pause();
+        GpuLoadMonitor* rawLoad = gpuLoadMonitor.get();
+        GpuRc6Monitor* rawRc6 = gpuRc6Monitor.get();
+        int loadWatch = watchMonitor(rawLoad, [this, rawLoad] { return gpuLoadMonitorPtr_.load() == rawLoad; });
+        int rc6Watch = watchMonitor(rawRc6, [this, rawRc6] { return gpuRc6MonitorPtr_.load() == rawRc6; });
+        int id = readiness_.add("GpuMonitor");
+        monitorsStarting_++;
+        probes.push_back(std::async(std::launch::async, [this, coreStarted, loadWatch, rc6Watch, id,
+                                                         load = std::move(gpuLoadMonitor),
+                                                         rc6 = std::move(gpuRc6Monitor)]() mutable {
+            bool useLoad = load->init() >= 0;
+            if (!useLoad) {
+                ALOGE("SocDaemon: GpuLoadMonitor initialization failed, falling back to GpuRc6Monitor.");
+                if (rc6->init() < 0) {
+                    ALOGE("SocDaemon: GpuRc6Monitor initialization failed, not adding to monitors_.");
+                    readiness_.set(id, false);
+                    monitorStartDone();
+                    return;
+                }
+            }
+            coreStarted.wait();
+            if (useLoad) {
+                startGpuMonitor(std::move(load), loadWatch);
+            } else {
+                startGpuMonitor(std::move(rc6), rc6Watch);
+            }
+            readiness_.set(id, true);
+            monitorStartDone();
+        }));
+    }
+
+    // The cheap sysfs/procfs probes run on this thread meanwhile; they start with the core.
+    std::vector<std::unique_ptr<HintMonitor>> probed;
+    auto localSysLoad = std::make_unique<SysLoadMonitor>("SysLoadMonitor");
+    localSysLoad->pause(); // sampled only while contained, or continuously in fusion mode
+    if (!initMonitor(localSysLoad.get())) {
+        ALOGE("SocDaemon: SysLoadMonitor initialization failed, not adding to monitors_.");
+    } else {
+        sysLoadMonitorPtr_ = localSysLoad.get(); // non-owning pointer for fast access without RTTI
+        probed.push_back(std::move(localSysLoad));
+        ALOGI("SocDaemon: SysLoadMonitor initialized and added to monitors_.");
+    }
+
+    // Per-cgroup accounting of the foreground groups; only sampled while contained.
+    auto cgroupCpuMonitor = std::make_unique<CgroupCpuMonitor>("CgroupCpuMonitor", options_.containedCpus);
+    cgroupCpuMonitor->pause();
+    if (!initMonitor(cgroupCpuMonitor.get())) {
+        ALOGE("SocDaemon: CgroupCpuMonitor initialization failed, not adding to monitors_.");
+    } else {
+        cgroupCpuMonitorPtr_ = cgroupCpuMonitor.get(); // non-owning pointer
+        probed.push_back(std::move(cgroupCpuMonitor));
+    }
+
+    // A single top-app thread saturating one contained core; only sampled while contained.
+    auto hotThreadMonitor = std::make_unique<HotThreadMonitor>("HotThreadMonitor");
+    hotThreadMonitor->pause();
+    if (!initMonitor(hotThreadMonitor.get())) {
+        ALOGE("SocDaemon: HotThreadMonitor initialization failed, not adding to monitors_.");
+    } else {
+        hotThreadMonitorPtr_ = hotThreadMonitor.get(); // non-owning pointer
+        probed.push_back(std::move(hotThreadMonitor));
+    }
+
+    // Run-queue wait of the foreground tasks; only sampled while contained.
+    auto schedDelayMonitor = std::make_unique<SchedDelayMonitor>("SchedDelayMonitor", options_.containedCpus);
+    schedDelayMonitor->pause();
+    if (!initMonitor(schedDelayMonitor.get())) {
+        ALOGE("SocDaemon: SchedDelayMonitor initialization failed, not adding to monitors_.");
+    } else {
+        schedDelayMonitorPtr_ = schedDelayMonitor.get(); // non-owning pointer
+        probed.push_back(std::move(schedDelayMonitor));
+    }
+
+    // Short-horizon load forecast to leave containment before saturation; only sampled while contained.
+    auto loadForecaster = std::make_unique<LoadForecaster>("LoadForecaster", options_.containedCpus);
+    loadForecaster->pause();
+    if (!initMonitor(loadForecaster.get())) {
+        ALOGE("SocDaemon: LoadForecaster initialization failed, not adding to monitors_.");
+    } else {
+        loadForecasterPtr_ = loadForecaster.get(); // non-owning pointer
+        probed.push_back(std::move(loadForecaster));
+    }
+
+    // Deep idle residency per cluster; sampled in both states for the before/after comparison.
+    auto cpuIdleMonitor = std::make_unique<CpuIdleMonitor>("CpuIdleMonitor", options_.containedCpus);
+    if (!initMonitor(cpuIdleMonitor.get())) {
+        ALOGE("SocDaemon: CpuIdleMonitor initialization failed, not adding to monitors_.");
+    } else {
+        cpuIdleMonitorPtr_ = cpuIdleMonitor.get(); // non-owning pointer
+        probed.push_back(std::move(cpuIdleMonitor));
+    }
 
-    } else if (socHint_ == "hfi") {
-        auto hfiMonitorPtr = std::make_unique<HfiMonitor>("HfiMonitor");
+    // Package/core/uncore energy, charged to the policy states by exchangeCCState() and the GFX_MODE path.
+    auto raplMonitor = std::make_unique<RaplMonitor>("RaplMonitor", options_.sampleTick);
+    if (!initMonitor(raplMonitor.get())) {
+        ALOGE("SocDaemon: RaplMonitor initialization failed, not adding to monitors_.");
+    } else {
+        raplMonitorPtr_ = raplMonitor.get(); // non-owning pointer
+        probed.push_back(std::move(raplMonitor));
+    }
 
-        if (hfiMonitorPtr->init() < 0) {
-            ALOGE("SocDaemon: HfiMonitor initialization failed, not adding to monitors_.");
+    // Workload-class settings bundles, as Power HAL modes or direct node writes.
+    if (options_.tuning.backend != TuneBackend::None) {
+        auto ladder = std::make_unique<TuningLadder>(
+            options_.tuning, [this](const std::string& mode, bool enable) {
+                auto begin = std::chrono::steady_clock::now();
+                bool ok;
+                {
+                    Watchdog::Call call(watchdog_, halTuneCall_);
+                    ok = hintManager.sendHint(mode, enable);
+                }
+                halLatencyUs_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - begin).count());
+                return ok;
+            });
+        if (ladder->init() < 0) {
+            ALOGE("SocDaemon: TuningLadder initialization failed, tuning ladder disabled.");
         } else {
-            monitors_.push_back(std::move(hfiMonitorPtr));
+            tuningLadder_ = std::move(ladder);
         }
     }
 
-    auto gpuMonitorPtr = std::make_unique<GpuRc6Monitor>(
-        "GpuRc6Monitor",
-        "/sys/class/drm/card0/device/tile0/gt0/gtidle/idle_residency_ms",
-        1000 // poll timeout in ms
-    );
-    
-    gpuMonitorPtr->pause(); // Start in paused state for WLT Idle/Btl
-    if (gpuMonitorPtr->init() < 0) {
-            ALOGE("SocDaemon: GpuRc6Monitor initialization failed, not adding to monitors_.");
+    // Control/metrics socket; created before the warm start so its transitions are published.
+    if (!options_.controlSocket.empty()) {
+        auto server = std::make_unique<ControlServer>(
+            options_.controlSocket,
+            [this](const std::string& command, const std::string& args) {
+                return handleControlRequest(command, args);
+            });
+        if (server->init() < 0) {
+            ALOGE("SocDaemon: ControlServer initialization failed, control socket disabled.");
         } else {
-            monitors_.push_back(std::move(gpuMonitorPtr));
-            gpuRc6MonitorPtr_ = static_cast<GpuRc6Monitor*>(monitors_.back().get()); // non-owning pointer
+            controlServer_ = std::move(server);
         }
+    }
 
+    // Thresholds pushed into monitors follow every published parameter set. A GPU
+    // monitor started later picks up the current set in startGpuMonitor().
+    policy_.setListener([this](const PolicyParams& params) {
+        if (sysLoadMonitorPtr_) {
+            sysLoadMonitorPtr_->setHighThreshold(params.sysloadHighThreshold);
+            sysLoadMonitorPtr_->setFallThreshold(params.sysloadFallThreshold);
+            sysLoadMonitorPtr_->setMinTimeAbove(params.sysloadHighMinAbove);
+        }
+        if (GpuLoadMonitor* gpu = gpuLoadMonitor()) gpu->setHighLoadPercent(params.gpuHighLoadPercent);
+        if (GpuRc6Monitor* gpu = gpuRc6Monitor()) gpu->setHighLoadPercent(params.gpuHighLoadPercent);
+        notifyStateChange("policy_version", static_cast<int>(params.version), "PolicyReload");
+    });
+    if (!options_.policyFile.empty()) {
+        std::string error;
+        policy_.reload(error);
+        if (policy_.init() == 0) {
+            threads_.emplace_back([this] {
+                placement_.applyPolicy();
+                policy_.watchLoop();
+            });
+        }
+    }
 
-    // Add SysLoadMonitor
-    auto localSysLoad = std::make_unique<SysLoadMonitor>("SysLoadMonitor");
-    if (localSysLoad->init() < 0) {
-        ALOGE("SocDaemon: SysLoadMonitor initialization failed, not adding to monitors_.");
-    } else {
-        SysLoadMonitor* rawPtr = localSysLoad.get();
-        monitors_.push_back(std::move(localSysLoad)); // monitors_ now owns the SysLoadMonitor
-        sysLoadMonitorPtr_ = rawPtr; // non-owning pointer for fast access without RTTI
-        ALOGI("SocDaemon: SysLoadMonitor initialized and added to monitors_.");
+    if (!options_.sharedStateFile.empty() && sharedState_.init() < 0) {
+        ALOGE("SocDaemon: SharedState initialization failed, state is not published.");
     }
 
-    // Register callback for each monitor
-    for (auto& monitor : monitors_) {
-        monitor->setChangeAlertCallback([this](const std::string& name, int oldValue, int newValue) {
-            this->handleChangeAlert(name, oldValue, newValue);
-        });
+    // Resume from the previous instance before any monitor can raise an alert.
+    restoreCheckpoint();
+    updateTuning("StartupReconcile");
+    if (fusionMode()) {
+        // Every fusion input is sampled continuously, whatever the containment state.
+        if (sysLoadMonitorPtr_) sysLoadMonitorPtr_->resume();
+    }
+    if (fusionMode() || shadowPolicy_) {
+        // Runs while one of its sampled inputs is; WLT and HFI evaluate on their own alerts.
+        // A shadow policy alone never starts a monitor: it sees what the active policy samples.
+        samplingClock_.addSource("Fusion", g_samplerPeriodTicksDefault,
+                                 [this] {
+                                     HintMonitor* gpu = gpuMonitor();
+                                     return (sysLoadMonitorPtr_ && sysLoadMonitorPtr_->isSampling()) ||
+                                            (gpu && gpu->isSampling());
+                                 },
+                                 [this] {
+                                     policyQueue_.post([this] {
+                                         updateFusionSamples();
+                                         if (fusionMode()) evaluateFusion();
+                                         evaluateShadow("Sample");
+                                     }, "Fusion");
+                                 });
+    }
+    if (checkpoint_.enabled() && sysLoadMonitorPtr_) {
+        // Offer the filtered load while it is being sampled (coalesced with SysLoadMonitor ticks);
+        // it is written only on a large, rate-limited drift.
+        samplingClock_.addSource("Checkpoint", kCheckpointPeriodTicks,
+                                 [this] { return sysLoadMonitorPtr_->isSampling(); },
+                                 [this] { saveCheckpoint(); });
+    }
+    if (sharedState_.enabled()) {
+        // Refreshes the loads at the system load period (coalesced with SysLoadMonitor and
+        // fusion) rather than every tick; decisions and state changes are published as they happen.
+        samplingClock_.addSource("SharedState", g_samplerPeriodTicksDefault,
+                                 [this] {
+                                     GpuLoadMonitor* gpu = gpuLoadMonitor();
+                                     return (sysLoadMonitorPtr_ && sysLoadMonitorPtr_->isSampling()) ||
+                                            (gpu && gpu->isSampling());
+                                 },
+                                 [this] { publishSharedState(nullptr); });
     }
 
-    // Create and launch each monitoring thread
-    threads_.resize(monitors_.size());
-    for (size_t i = 0; i < monitors_.size(); ++i) {
-        if (pthread_create(&threads_[i], NULL, SocDaemon::monitorSysfsWrapper, monitors_[i].get()) != 0) {
-            ALOGE("SocDaemon: Failed to create thread %zu: %s", i, std::strerror(errno));
-        }
+    std::vector<int> probedWatches;
+    for (auto& monitor : probed) probedWatches.push_back(watchMonitor(monitor.get()));
+    threads_.emplace_back([this] {
+        placement_.applyPolicy();
+        watchdog_.run();
+    });
+    threads_.emplace_back([this] {
+        placement_.applyPolicy();
+        policyQueue_.run();
+    });
+    // Deferred toggles are re-evaluated on the shared tick while any is pending. The clock only
+    // times these; the HAL calls and node writes run on the policy thread.
+    samplingClock_.addSource("HintGovernor", 1,
+                             [this] { return efficientGovernor_.hasPending() || gfxGovernor_.hasPending(); },
+                             [this] { policyQueue_.post([this] { retryDeferredHints(); }, "HintGovernor"); });
+    if (tuningLadder_) {
+        samplingClock_.addSource("TuningLadder", 1, [this] { return tuningLadder_->hasPending(); },
+                                 [this] { policyQueue_.post([this] { tuningLadder_->applyDue(); }, "TuningLadder"); });
     }
 
-    // Keep the main daemon process alive indefinitely.
+    if (controlServer_) {
+        samplingClock_.addSource("Metrics", kMetricsPeriodTicks,
+                                 [this] { return controlServer_->hasSubscribers("metrics"); },
+                                 [this] { controlServer_->publish("metrics", formatMetrics()); });
+        threads_.emplace_back([this] {
+            placement_.applyPolicy();
+            controlServer_->run();
+        });
+    }
+    samplingClock_.start([this] { placement_.applySampler(); });
+
+    for (size_t i = 0; i < probed.size(); ++i) startMonitor(std::move(probed[i]), probedWatches[i]);
+    coreUp.set_value();
+    monitorStartDone();
+
+    // Keep the main daemon process alive indefinitely (and the probe futures with it).
     while (true) {
         std::this_thread::sleep_for(std::chrono::seconds(60));
     }
 }
 
+bool SocDaemon::initMonitor(HintMonitor* monitor) {
+    int id = readiness_.add(monitor->name());
+    bool ok = monitor->init() >= 0;
+    readiness_.set(id, ok);
+    return ok;
+}
+
+int SocDaemon::watchMonitor(HintMonitor* monitor, std::function<bool()> started) {
+    // A heartbeat per sample, or for an event loop that blocks on its descriptor,
+    // the exit of its thread and the loss of its source.
+    if (monitor->periodTicks() > 0) {
+        return watchdog_.addHeartbeat(monitor->name(), monitor->periodTicks() * samplingClock_.baseTick(),
+                                      [monitor, started] { return (!started || started()) && monitor->isSampling(); });
+    }
+    return watchdog_.addHeartbeat(monitor->name(), monitor->heartbeatPeriod(), started);
+}
+
+void SocDaemon::startMonitor(std::unique_ptr<HintMonitor> owned, int watch) {
+    HintMonitor* monitor = owned.get();
+    std::lock_guard<std::mutex> lock(monitorsMutex_);
+    monitors_.push_back(std::move(owned));
+
+    // Periodic monitors share one coalesced wakeup; event-driven monitors get their own thread.
+    // Clock-driven monitors sample at SCHED_IDLE: their alerts are handled on the policy thread
+    // so that acting on them never waits for idle time.
+    if (monitor->periodTicks() > 0) {
+        monitor->setChangeAlertCallback([this](const std::string& name, int oldValue, int newValue) {
+            policyQueue_.post([this, name, oldValue, newValue] { handleChangeAlert(name, oldValue, newValue); });
+        });
+        samplingClock_.addSource(monitor->name(), monitor->periodTicks(),
+                                 [monitor] { return monitor->isSampling(); },
+                                 [this, monitor, watch] {
+                                     monitor->sampleOnce();
+                                     watchdog_.beat(watch);
+                                 });
+        samplingClock_.wake();
+        return;
+    }
+    monitor->setChangeAlertCallback([this](const std::string& name, int oldValue, int newValue) {
+        this->handleChangeAlert(name, oldValue, newValue);
+    });
+    if (monitor->heartbeatPeriod().count() > 0) {
+        monitor->setHeartbeatCallback([this, watch] { watchdog_.beat(watch); });
+    }
+    // A loop re-opening a missing node never exits: its loss is reported on its own.
+    monitor->setSourceCallback([this, watch](bool lost) {
+        if (lost) {
+            watchdog_.lost(watch);
+        } else {
+            watchdog_.beat(watch);
+        }
+    });
+    threads_.emplace_back([this, monitor, watch] {
+        placement_.applyPolicy();
+        monitor->monitorLoop();
+        ALOGE("SocDaemon: %s monitor loop exited", monitor->name().c_str());
+        watchdog_.exited(watch);
+    });
+}
+
+template <typename GpuMonitor>
+void SocDaemon::startGpuMonitor(std::unique_ptr<GpuMonitor> monitor, int watch) {
+    GpuMonitor* raw = monitor.get();
+    raw->setHighLoadPercent(params()->gpuHighLoadPercent);
+    if constexpr (std::is_same_v<GpuMonitor, GpuLoadMonitor>) {
+        // Closed-loop PL1 needs the GPU busy and throttle inputs; RC6 residency alone is not
+        // enough. Published before the first GPU alert can reach sendGfxHintIfAllowed().
+        if (options_.pl1Control) {
+            auto controller = std::make_unique<Pl1Controller>(options_.pl1);
+            if (controller->init() < 0) {
+                ALOGE("SocDaemon: Pl1Controller initialization failed, keeping the GFX_MODE hint.");
+            } else {
+                pl1Controller_ = std::move(controller);
+                pl1ControllerPtr_ = pl1Controller_.get();
+                // Stepped every tick while the GPU is sampled, then until PL1 is back at its floor.
+                samplingClock_.addSource("Pl1Controller", 1,
+                                         [this, raw] { return raw->isSampling() || pl1Controller()->isAboveFloor(); },
+                                         [this] { policyQueue_.post([this] { updatePl1(); }, "Pl1Controller"); });
+            }
+        }
+        gpuLoadMonitorPtr_ = raw;
+    } else {
+        if (options_.pl1Control) ALOGE("SocDaemon: Pl1Controller needs GpuLoadMonitor, keeping the GFX_MODE hint.");
+        gpuRc6MonitorPtr_ = raw;
+    }
+    startMonitor(std::move(monitor), watch);
+
+    // Catch up with what the WLT alerts so far would have done to a running GPU monitor.
+    int wlt = lastWlt_.load();
+    bool busyWlt = wlt >= 0 && (static_cast<WltType>(wlt & 0x3) == WltType::Sustain ||
+                                static_cast<WltType>(wlt & 0x3) == WltType::Bursty);
+    if (fusionMode() || (socHint_ == "wlt" && busyWlt)) resumeGpuMonitor();
+}
+
+void SocDaemon::monitorStartDone() {
+    if (--monitorsStarting_ == 0) readiness_.mark(StartupReadiness::kMonitorsReady);
+}
+
 void SocDaemon::startDebounceThreadOnce() {
     static bool started = false;
     if (!started) {
@@ -95,6 +485,7 @@ void SocDaemon::startDebounceThreadOnce() {
 
 void SocDaemon::debounceThreadFunc() {
     using clock = std::chrono::steady_clock;
+    placement_.applyPolicy();
     std::unique_lock<std::mutex> lock(debounceMutex_);
     while (true) {
         // Wait until any timer is requested or thread is marked started
@@ -109,7 +500,7 @@ void SocDaemon::debounceThreadFunc() {
         while (ccEntryDebounceActive_.load() || ccExitDebounceActive_.load()) {
             if (ccEntryDebounceActive_.load()) {
                 // Start waiting for the entry debounce period from now.
-                auto deadline = clock::now() + kCCEntryDebounceMs;
+                auto deadline = clock::now() + ccEntryDebounceMs_;
 
                 // Wait until deadline or until notified (cancel/restart)
                 while (ccEntryDebounceActive_.load()) {
@@ -125,19 +516,31 @@ void SocDaemon::debounceThreadFunc() {
                     // perform long work without holding mutex
                     lock.unlock();
                     // add to private members
-                    double currentSysCpuLoad = getSysCpuLoad();
+                    double currentSysCpuLoad = entrySysCpuLoad();
                     ALOGI("SocDaemon: Open : EntryDebounceTimer Expired. SysCpuLoad=%f", currentSysCpuLoad);
                     //AR: Erin to make 0.5 value as configuration.
-                    if (currentSysCpuLoad < 25.0) {
-                        CCGlobalState prev = CCGlobalState_.exchange(CCGlobalState::CoreContainment);
-                        if (prev != CCGlobalState::CoreContainment) {
-                            sendHintIfAllowed(1, "EntryDebounceTimerExpired");
+                    if (isCCEntryHeldOff()) {
+                        ALOGI("SocDaemon: Parked cores did not sleep in the last containment. Remain in MONITOR state");
+                    } else if (currentSysCpuLoad < 0.0) {
+                        // Unknown load is not a low load. The baseline was taken at resume,
+                        // so one sampler period is enough for a value.
+                        if (sysLoadMonitorPtr_) {
+                            std::chrono::milliseconds recheck =
+                                    samplingClock_.baseTick() * sysLoadMonitorPtr_->periodTicks();
+                            ALOGI("SocDaemon: No SysCpuLoad sample yet. Remain in MONITOR state, recheck in %lldms",
+                                  static_cast<long long>(recheck.count()));
+                            startCCEntryDebounceTimer(recheck);
                         } else {
+                            ALOGI("SocDaemon: No SysLoadMonitor. Remain in MONITOR state");
+                        }
+                    } else if (currentSysCpuLoad < params()->sysloadEntryThreshold) {
+                        if (!requestCCState(CCGlobalState::CoreContainment, "EntryDebounceTimerExpired")) {
                             ALOGI("SocDaemon: Already in CoreContainment state, no transition needed");
                         }
                     } else {
                         ALOGI("SocDaemon: System load is high. Remain in MONITOR state");
                     }
+                    releaseSysLoadSampling();
 
                     lock.lock();
                 } else {
@@ -163,21 +566,23 @@ void SocDaemon::debounceThreadFunc() {
                 if (!ccExitDebounceCancelled_.load()) {
                     lock.unlock();
                     if (CCGlobalState_.load() == CCGlobalState::CoreContainment) {
-                        double currentSysCpuLoad = getSysCpuLoad();
-                        double slope = currentSysCpuLoad - latestSysCpuLoadCC_;
+                        std::shared_ptr<const PolicyParams> policy = params();
+                        double currentSysCpuLoad = getLatestSysCpuLoad();
+                        double loadCC = latestSysCpuLoadCC_.load();
+                        double slope = currentSysCpuLoad - loadCC;
                         ALOGI("SocDaemon: CC : ExitDebounceTimer Expired with SysCpuLoad=%f latestSysCpuLoadCC_=%f slope=%f",
-                                currentSysCpuLoad, latestSysCpuLoadCC_, slope);
+                                currentSysCpuLoad, loadCC, slope);
 
-                        if (slope > kSysloadSlopeThreshold) {
-                            CCGlobalState prev = CCGlobalState_.exchange(CCGlobalState::Open);
-                            if (prev != CCGlobalState::Open) {
-                                sendHintIfAllowed(0, "ExitDebounceTimerExpired");
-                            } else {
+                        if (holdExitForThermal()) {
+                            ALOGI("SocDaemon: Near a thermal limit. Remain in CoreContainment, restart ExitDebounceTimer");
+                            startCCExitDebounceTimer(policy->ccExitRecheck);
+                        } else if (slope > policy->sysloadSlopeThreshold) {
+                            if (!requestCCState(CCGlobalState::Open, "ExitDebounceTimerExpired")) {
                                 ALOGI("SocDaemon: Already in Open after exit debounce (no action)");
                             }
                         } else {
                             ALOGI("SocDaemon: SysLoad has not increased. Restart ExitDebounceTimer");
-                            startCCExitDebounceTimer(std::chrono::milliseconds(5000));
+                            startCCExitDebounceTimer(policy->ccExitRecheck);
                         }
 
                     } else {
@@ -193,15 +598,26 @@ void SocDaemon::debounceThreadFunc() {
 }
 
 // Debounce control helpers
-void SocDaemon::startCCEntryDebounceTimer() noexcept {
+void SocDaemon::startCCEntryDebounceTimer(std::chrono::milliseconds timeout) noexcept {
     {
         std::lock_guard<std::mutex> lock(debounceMutex_);
         ccEntryDebounceStartTime_ = std::chrono::steady_clock::now();
+        ccEntryDebounceMs_ = timeout;
         ccEntryDebounceActive_ = true;
         ccEntryDebounceCancelled_ = false;
        debounceThreadStarted_ = true;
     }
     debounceCv_.notify_one();
+    if (cpuIdleMonitorPtr_) {
+        // Open residency baseline for the containment this debounce may lead to.
+        cpuIdleMonitorPtr_->sampleFor(timeout);
+    }
+    if (sysLoadMonitorPtr_) {
+        // The expiry (and a thermal early entry) decide on a load sampled from here on.
+        sysLoadMonitorPtr_->resume();
+        ccEntryLoadSampleCount_ = sysLoadMonitorPtr_->sampleCount();
+    }
+    samplingClock_.wake();
 }
 
 void SocDaemon::stopCCEntryDebounceTimer() noexcept {
@@ -212,12 +628,27 @@ ALOGI("SocDaemon: EntryDebounceTimer Stopped");
         ccEntryDebounceCancelled_ = true;
     }
     debounceCv_.notify_one();
+    releaseSysLoadSampling();
+}
+
+void SocDaemon::releaseSysLoadSampling() noexcept {
+    // Containment and fusion keep sampling the load; otherwise only an entry debounce needs it.
+    if (sysLoadMonitorPtr_ && !efficientMode_.load() && !fusionMode() && !isCCEntryDebounceTimerRunning()) {
+        sysLoadMonitorPtr_->pause();
+    }
 }
 
 bool SocDaemon::isCCEntryDebounceTimerRunning() const noexcept {
     return ccEntryDebounceActive_.load();
 }
 
+double SocDaemon::entrySysCpuLoad() const noexcept {
+    if (!sysLoadMonitorPtr_ || sysLoadMonitorPtr_->sampleCount() == ccEntryLoadSampleCount_.load()) {
+        return -1.0;
+    }
+    return sysLoadMonitorPtr_->getLatestSysCpuLoad();
+}
+
 void SocDaemon::startCCExitDebounceTimer(std::chrono::milliseconds timeout) noexcept {
     {
         std::lock_guard<std::mutex> lock(debounceMutex_);
@@ -245,9 +676,19 @@ bool SocDaemon::isCCExitDebounceTimerRunning() const noexcept {
 
 // Monitor callbacks
 void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int newValue) {
+    readiness_.mark(StartupReadiness::kFirstInput);
 
     if (name == "WltMonitor") {
         ALOGI("SocDaemon: New WLT=%d", newValue);
+        counters_.wltAlerts++;
+        lastWlt_ = newValue;
+        wltResidency_.transition(newValue & 0x3);
+        updateTuning("WltMonitor");
+        wltPredictor_.observe(newValue & 0x3);
+        notifyStateChange("wlt", newValue, "WltMonitor");
+        static constexpr double kWltContainScore[] = {1.0, 0.8, 0.2, 0.0}; // Idle, Btl, Sustain, Bursty
+        updateFusionSignal(FusionSignal::Wlt, kWltContainScore[newValue & 0x3]);
+        updateFusionSignal(FusionSignal::SwltPower, (newValue & (1 << 4)) ? 1.0 : 0.0);
         // ERIN TO DO -- WHAT ARE WE GOING TO DO with sysload here
 
             if (socHint_ == "wlt") {
@@ -260,35 +701,18 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                         (newWLT == WltType::Sustain || newWLT == WltType::Bursty)) {
                         ALOGI("SocDaemon: CC : WLT changed from IDLE/BTL to SUSTAIN/BURSTY. Resetting latestSysCpuLoadCC_");
                         latestSysCpuLoadCC_ = getLatestSysCpuLoad();
-                        if (!gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
-                        // Start thread if not running
-                            if (pthread_create(&gpuMonitorThread_, NULL, SocDaemon::monitorSysfsWrapper, gpuRc6MonitorPtr_) == 0) {
-                                gpuMonitorThreadRunning_ = true;
-                                ALOGI("DEEPIKA SocDaemon: Started GpuRc6Monitor thread for WLT Sustain/Bursty");
-                                // Always resume after thread start in case monitor was paused
-                                gpuRc6MonitorPtr_->resume();
-                                ALOGI("DEEPIKA SocDaemon: Resumed GpuRc6Monitor polling for WLT Sustain/Bursty (after thread start)");
-                            } else {
-                                ALOGE("DEEPIKA SocDaemon: Failed to start GpuRc6Monitor thread: %s", std::strerror(errno));
-                            }
-                        } else if (gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
-                        // Resume polling if thread is already running
-                        gpuRc6MonitorPtr_->resume();
-                        ALOGI("DEEPIKA SocDaemon: Resumed GpuRc6Monitor polling for WLT Sustain/Bursty");
+                        if (gpuMonitor()) {
+                            resumeGpuMonitor();
                         }
                     }
 
-                    // Update the sysLoad value.
-                    getSysCpuLoad();
-
                     switch (newWLT) {
                         case WltType::Idle:
                         case WltType::Btl:
                             // Idle/BTL -> ensure exit debounce is stopped
-                            if (gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
+                            if (gpuMonitor()) {
                                 sendGfxHintIfAllowed(0, "WLT Idle/Btl - Low GPU load expected");
-                                gpuRc6MonitorPtr_->pause();
-                                ALOGI("SocDaemon: Paused GpuRc6Monitor polling for WLT Idle/Btl");
+                                pauseGpuMonitor();
                                 }
                             if (isCCExitDebounceTimerRunning()) {
                                 ALOGI("SocDaemon: CC_ExitDT : WLT_IDLE/BTL. Cancel ExitDebounceTimer");
@@ -301,15 +725,16 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                         case WltType::Bursty:
                             if (!isCCExitDebounceTimerRunning()) {
                                 ALOGI("SocDaemon: CC : WLT_SUSTAIN/BURSTY. Start ExitDebounceTimer");
-                                startCCExitDebounceTimer();
+                                std::chrono::milliseconds debounce = params()->ccExitDebounce;
+                                startCCExitDebounceTimer(options_.wltPredictor ? wltPredictor_.exitDebounce(debounce)
+                                                                               : debounce);
                             }
-                            if (gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
-                                gpuRc6MonitorPtr_->resume();
-                                ALOGI("SocDaemon: Resumed GpuRc6Monitor polling for WLT Sustain/Bursty");
+                            if (gpuMonitor()) {
+                                resumeGpuMonitor();
                             }
                             break;
                         default:
-                            ALOGD("SocDaemon: CC : Unknown WLT state %d", newWLT);
+                            ALOGD("SocDaemon: CC : Unknown WLT state %d", static_cast<int>(newWLT));
                             break;
                     }
 
@@ -321,14 +746,15 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                         case WltType::Btl:
                             if ((CCGlobalState_.load() == CCGlobalState::Open) && !isCCEntryDebounceTimerRunning()) {
                                 ALOGI("SocDaemon: Open : WLT_IDLE/BTL : EntryDebounceTimer Started");
-                                startCCEntryDebounceTimer();
+                                std::chrono::milliseconds debounce = params()->ccEntryDebounce;
+                                startCCEntryDebounceTimer(options_.wltPredictor ? wltPredictor_.entryDebounce(debounce)
+                                                                                : debounce);
                             } else {
                                 ALOGI("SocDaemon: Open : WLT_IDLE/BTL : EntryDebounceTimer already running or not in Open");
                             }
-                            if (gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
+                            if (gpuMonitor()) {
                                 sendGfxHintIfAllowed(0, "WLT Idle/Btl - Low GPU load expected");
-                                gpuRc6MonitorPtr_->pause();
-                                ALOGI("SocDaemon: Paused GpuRc6Monitor polling for WLT Idle/Btl");
+                                pauseGpuMonitor();
                             }
                             break;
                         case WltType::Sustain:
@@ -338,16 +764,15 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                             } else {
                                 ALOGI("SocDaemon: Open : WLT_SUSTAIN : No EntryDebounceTimer running");
                             }
-                            if (gpuMonitorThreadRunning_ && gpuRc6MonitorPtr_) {
-                                gpuRc6MonitorPtr_->resume();
-                                ALOGI("SocDaemon: Resumed GpuRc6Monitor polling for WLT Sustain/Bursty");
+                            if (gpuMonitor()) {
+                                resumeGpuMonitor();
                             }
                             break;
                         case WltType::Bursty:
                             ALOGI("SocDaemon: Open : WLT_BURSTY (no action)");
                             break;
                         default:
-                            ALOGD("SocDaemon: Open : Unknown WLT state %d", newWLT);
+                            ALOGD("SocDaemon: Open : Unknown WLT state %d", static_cast<int>(newWLT));
                             break;
                     }
                 }
@@ -357,29 +782,97 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                 } else {
                     sendHintIfAllowed(1, "SWLT is Power");
                 }
+            } else if (fusionMode()) {
+                evaluateFusion();
             }
+            evaluateShadow("WltAlert");
         }
 
         if (name == "HfiMonitor") {
-            if (newValue == 255) {
+            counters_.hfiAlerts++;
+            updateFusionSignal(FusionSignal::Hfi, newValue / 255.0);
+            evaluateShadow("HfiAlert");
+            if (fusionMode()) {
+                evaluateFusion();
+            } else if (socHint_ != "hfi") {
+                // Not driving the policy in this mode (shadow input or thermal events only).
+            } else if (newValue == 255) {
                 sendHintIfAllowed(1, "HFI Efficient Power Mode is 255");
             } else {
                 sendHintIfAllowed(0, "HFI Efficient Power Mode is not 255");
             }
         }
 
+        if (name == kThermalPressureAlert) {
+            // Thermal pressure alert from HfiMonitor: newValue is the ThermalPressure level.
+            counters_.thermalAlerts++;
+            ALOGI("SocDaemon: Thermal pressure changed %d -> %d", oldValue, newValue);
+            handleThermalPressure(newValue);
+        }
+
         if (name == "SysLoadMonitor") {
-            // SysLoadMonitor change alert: newValue is the smoothed CPU load percentage
-            double cpuLoad = static_cast<double>(newValue);
-            ALOGI("SocDaemon: SysLoadMonitor ALERT: CPU load changed to %f", cpuLoad);
-            // If in CoreContainment and CPU load rises above high threshold, start exit debounce
-            CCGlobalState prev = CCGlobalState_.exchange(CCGlobalState::Open);
-            if (prev != CCGlobalState::CoreContainment) {
-                sendHintIfAllowed(0, "HighSysLoadInCC");
+            // SysLoadMonitor change alert: oldValue is the smoothed CPU load (fixed point), newValue high.
+            double cpuLoad = SysLoadMonitor::fromFixedPoint(oldValue);
+            counters_.sysLoadAlerts++;
+            ALOGI("SocDaemon: SysLoadMonitor ALERT: CPU load %.2f%%, high=%d", cpuLoad, newValue);
+            if (fusionMode()) {
+                return; // load is one of the fused signals, see updateFusionSamples()
+            }
+            // Only the rising edge acts: in CoreContainment a sustained high load exits at once.
+            if (newValue == 1) {
+                requestCCState(CCGlobalState::Open, "HighSysLoadInCC");
+            }
+        }
+
+        if (name == "CgroupCpuMonitor") {
+            // CgroupCpuMonitor change alert: oldValue is top-app utilization of the contained CPUs, newValue saturation.
+            counters_.cgroupAlerts++;
+            ALOGI("SocDaemon: CgroupCpuMonitor ALERT: top-app at %d%% of contained CPUs, saturated=%d", oldValue, newValue);
+            if (newValue == 1) {
+                requestCCState(CCGlobalState::Open, "TopAppSaturatesContainedCores");
+            }
+        }
+
+        if (name == "HotThreadMonitor") {
+            // HotThreadMonitor change alert: oldValue is the hottest thread's % of one core, newValue hot.
+            counters_.hotThreadAlerts++;
+            ALOGI("SocDaemon: HotThreadMonitor ALERT: top-app thread at %d%% of one core, hot=%d", oldValue, newValue);
+            if (newValue == 1) {
+                requestCCState(CCGlobalState::Open, "TopAppThreadSaturated");
+            }
+        }
+
+        if (name == "SchedDelayMonitor") {
+            // SchedDelayMonitor change alert: oldValue is the p95 run delay in us, newValue high.
+            counters_.schedDelayAlerts++;
+            ALOGI("SocDaemon: SchedDelayMonitor ALERT: foreground p95 run delay %dus, high=%d", oldValue, newValue);
+            if (newValue == 1) {
+                requestCCState(CCGlobalState::Open, "ForegroundRunDelay");
+            }
+        }
+
+        if (name == "LoadForecaster") {
+            // LoadForecaster change alert: oldValue is the predicted load in 1/100 %, newValue predicted saturation.
+            counters_.forecastAlerts++;
+            ALOGI("SocDaemon: LoadForecaster ALERT: load predicted at %d.%02d%%, saturation=%d", oldValue / 100,
+                  oldValue % 100, newValue);
+            if (newValue == 1) {
+                requestCCState(CCGlobalState::Open, "PredictedSaturation");
+            }
+        }
+
+        if (name == "CpuIdleMonitor") {
+            // CpuIdleMonitor change alert: oldValue is the parked cluster deep idle residency, newValue notSleeping.
+            counters_.cpuIdleAlerts++;
+            ALOGI("SocDaemon: CpuIdleMonitor ALERT: parked cores %d%% in deep idle, notSleeping=%d", oldValue, newValue);
+            if (newValue == 1) {
+                armCCEntryHoldOff();
+                requestCCState(CCGlobalState::Open, "ParkedCoresNotSleeping");
             }
         }
 
         if (name == "GpuRc6Monitor") {
+            counters_.gpuAlerts++;
             // GpuRc6Monitor change alert: newValue is the gfxMode (0=normal, 1=high load)
             //ALOGI("SocDaemon: GpuRc6Monitor ALERT: GfxMode changed to %d", newValue);
             if (newValue == 1) {
@@ -390,15 +883,25 @@ void SocDaemon::handleChangeAlert(const std::string& name, int oldValue, int new
                 sendGfxHintIfAllowed(0, "Low GPU load detected");
             }
         }
-    }
 
-double SocDaemon::getSysCpuLoad() const noexcept {
-    // Use the non-owning pointer to the SysLoadMonitor (set during construction) to avoid RTTI/dynamic_cast.
-    if (sysLoadMonitorPtr_) {
-        return sysLoadMonitorPtr_->getSysCpuLoad();
+        if (name == "GpuLoadMonitor") {
+            counters_.gpuAlerts++;
+            // GpuLoadMonitor change alert: oldValue is the frequency-weighted load, newValue the gfxMode.
+            // gfxMode is only 1 when the GPU is busy and power-limited (not thermally limited).
+            bool thermal = gpuLoadMonitor() && gpuLoadMonitor()->isThermalLimited();
+            if (newValue == 1) {
+                ALOGI("SocDaemon: GpuLoadMonitor ALERT: GfxMode=1, GPU busy and power-limited (weighted load %d%%)", oldValue);
+                sendGfxHintIfAllowed(1, "GPU busy and power-limited");
+            } else {
+                ALOGI("SocDaemon: GpuLoadMonitor ALERT: GfxMode=0 (weighted load %d%%, thermal=%d)", oldValue, thermal);
+                sendGfxHintIfAllowed(0, thermal ? "GPU thermally limited" : "GPU not busy or not power-limited");
+            }
+        }
+
+        // Fusion decides on its own tick (evaluateFusion()); otherwise the alert was acted on
+        // above, and keeping the current state (staying Open) is a decision as well.
+        if (!fusionMode()) readiness_.mark(StartupReadiness::kFirstDecision);
     }
-    return -1.0;
-}
 
 double SocDaemon::getLatestSysCpuLoad() const noexcept {
     // Use the non-owning pointer to the SysLoadMonitor (set during construction) to avoid RTTI/dynamic_cast.
@@ -408,43 +911,854 @@ double SocDaemon::getLatestSysCpuLoad() const noexcept {
     return -1.0;
 }
 
-void SocDaemon::sendHintIfAllowed(int value, const char* reason) {
-    if (value != efficientMode_) {
-        if (sendHint_) {
-            hintManager.sendHint("EFFICIENT_POWER", value);
-                ALOGI("SocDaemon: Send EFFICIENT_POWER: %d due to %s", value, reason);
-            } else {
-                ALOGI("SocDaemon: %s but not sending due to sendHint=false", reason);
-            }
-            efficientMode_ = value;
+void SocDaemon::sendHintIfAllowed(int value, const char* reason, bool moveCC) {
+    // The governor's state, efficientMode_ and CCGlobalState_ move together.
+    std::lock_guard<std::mutex> lock(decisionMutex_);
+    if (value && moveCC && !efficientMode_ && isCCEntryHeldOff()) {
+        // Checked here so that every entry path, a deferred one included, honours it.
+        ALOGI("SocDaemon: EFFICIENT_POWER: 1 due to %s held off, parked cores did not sleep in the last containment",
+              reason);
+        efficientGovernor_.request(0); // drops a deferred entry
+        return;
+    }
+    if (value == efficientMode_) {
+        efficientGovernor_.request(value); // drops a deferred opposite toggle
+        if (moveCC) exchangeCCState(value ? CCGlobalState::CoreContainment : CCGlobalState::Open);
+        ALOGD("SocDaemon: Hint value unchanged (%d), not sending: %s", value, reason);
+        return;
+    }
+    if (efficientGovernor_.request(value) == HintGovernor::Decision::Defer) {
+        // Nothing changes until the hint is actually sent (retryDeferredHints()).
+        ALOGI("SocDaemon: EFFICIENT_POWER: %d due to %s deferred by governor", value, reason);
+        deferredMovesCC_ = moveCC;
+        samplingClock_.wake();
+        return;
+    }
+    if (moveCC) exchangeCCState(value ? CCGlobalState::CoreContainment : CCGlobalState::Open);
+    if (params()->sendHint) {
+        sendHalHint("EFFICIENT_POWER", value);
+        ALOGI("SocDaemon: Send EFFICIENT_POWER: %d due to %s", value, reason);
+    } else {
+        ALOGI("SocDaemon: %s but not sending due to sendHint=false", reason);
+    }
+    efficientMode_ = value;
+    efficientResidency_.transition(value);
+    saveCheckpoint();
+    notifyStateChange("efficient_mode", value, reason);
+    if (cpuIdleMonitorPtr_) {
+        // Whatever ended this containment, the next one would not let the parked cores sleep either.
+        if (!value && cpuIdleMonitorPtr_->parkedNotSleeping()) armCCEntryHoldOff();
+        cpuIdleMonitorPtr_->setContained(value);
+    }
 
-            if (efficientMode_) {
-                if (sysLoadMonitorPtr_) sysLoadMonitorPtr_->restart();
-            } else {
-                if (sysLoadMonitorPtr_) sysLoadMonitorPtr_->pause();
-            }
-        } else {
-            ALOGD("SocDaemon: Hint value unchanged (%d), not sending: %s", value, reason);
+    if (efficientMode_) {
+        if (sysLoadMonitorPtr_) sysLoadMonitorPtr_->resume();
+        if (cgroupCpuMonitorPtr_) cgroupCpuMonitorPtr_->resume();
+        if (hotThreadMonitorPtr_) hotThreadMonitorPtr_->resume();
+        if (schedDelayMonitorPtr_) schedDelayMonitorPtr_->resume();
+        if (loadForecasterPtr_) loadForecasterPtr_->resume();
+        samplingClock_.wake();
+    } else {
+        if (sysLoadMonitorPtr_ && !fusionMode()) sysLoadMonitorPtr_->pause();
+        if (cgroupCpuMonitorPtr_) cgroupCpuMonitorPtr_->pause();
+        if (hotThreadMonitorPtr_) hotThreadMonitorPtr_->pause();
+        if (schedDelayMonitorPtr_) schedDelayMonitorPtr_->pause();
+        if (loadForecasterPtr_) loadForecasterPtr_->pause();
     }
 }
 
 void SocDaemon::sendGfxHintIfAllowed(int value, const char* reason) {
-    if (value != gfxMode_) {
-        if (sendGfxHint_) {
-            hintManager.sendHint("GFX_MODE", value);
-            ALOGI("SocDaemon: Send GFX_MODE: %d due to %s", value, reason);
-            } else {
-                ALOGI("SocDaemon: %s but not sending due to sendGfxHint=false", reason);
-            }
-            gfxMode_ = value;
+    std::lock_guard<std::mutex> lock(decisionMutex_);
+    if (value == gfxMode_) {
+        gfxGovernor_.request(value); // drops a deferred opposite toggle
+        ALOGD("SocDaemon: GFX Hint value unchanged (%d), not sending: %s", value, reason);
+        return;
+    }
+    if (gfxGovernor_.request(value) == HintGovernor::Decision::Defer) {
+        ALOGI("SocDaemon: GFX_MODE: %d due to %s deferred by governor", value, reason);
+        samplingClock_.wake();
+        return;
+    }
+    if (pl1Controller()) {
+        ALOGI("SocDaemon: GFX_MODE: %d due to %s, PL1 is set by Pl1Controller", value, reason);
+    } else if (params()->sendGfxHint) {
+        sendHalHint("GFX_MODE", value);
+        ALOGI("SocDaemon: Send GFX_MODE: %d due to %s", value, reason);
+    } else {
+        ALOGI("SocDaemon: %s but not sending due to sendGfxHint=false", reason);
+    }
+    gfxMode_ = value;
+    gfxResidency_.transition(value);
+    if (raplMonitorPtr_) raplMonitorPtr_->setState(RaplMonitor::kGfxAccount, value);
+    saveCheckpoint();
+    notifyStateChange("gfx_mode", value, reason);
+}
+
+void SocDaemon::restoreCheckpoint() {
+    PolicyCheckpoint ckpt;
+    bool restored = checkpoint_.load(ckpt);
+
+    if (restored) {
+        if (sysLoadMonitorPtr_ && ckpt.cpuEma >= 0.0) {
+            sysLoadMonitorPtr_->seedSysCpuLoad(ckpt.cpuEma);
+        }
+        lastWlt_ = ckpt.wlt;
+    }
+
+    // The HAL keeps whatever the previous instance set and cannot be queried, so
+    // re-assert the restored (or, on a cold start, default) state explicitly.
+    bool contained = restored && ckpt.ccState == static_cast<int>(CCGlobalState::CoreContainment) &&
+                     ckpt.efficientMode;
+    efficientMode_ = !contained; // forces the send; the governor allows its first request
+    requestCCState(contained ? CCGlobalState::CoreContainment : CCGlobalState::Open,
+                   restored ? "RestoredCheckpoint" : "ColdStartReconcile");
+
+    // GPU monitors start paused, so never carry a stale PL1 bump over.
+    if (!restored || ckpt.gfxMode) {
+        gfxMode_ = true;
+        sendGfxHintIfAllowed(0, "StartupReconcile");
+    } else {
+        gfxGovernor_.sync(gfxMode_);
+    }
+
+    // Start residency accounting from the reconciled state.
+    if (lastWlt_.load() >= 0) wltResidency_.transition(lastWlt_.load() & 0x3);
+    efficientResidency_.transition(efficientMode_.load());
+    gfxResidency_.transition(gfxMode_.load());
+    if (raplMonitorPtr_) raplMonitorPtr_->setState(RaplMonitor::kGfxAccount, gfxMode_.load());
+
+    ALOGI("SocDaemon: %s start in %s", restored ? "Warm" : "Cold", contained ? "CoreContainment" : "Open");
+}
+
+void SocDaemon::saveCheckpoint() {
+    if (!checkpoint_.enabled()) return;
+    // Never on the clock or a decision thread: requests queued meanwhile collapse into one
+    // write of the state current when it runs.
+    policyQueue_.post([this] { writeCheckpoint(); }, "Checkpoint");
+}
+
+void SocDaemon::writeCheckpoint() {
+    PolicyCheckpoint ckpt;
+    ckpt.cpuEma = getLatestSysCpuLoad();
+    ckpt.ccState = static_cast<int>(CCGlobalState_.load());
+    ckpt.efficientMode = efficientMode_;
+    ckpt.gfxMode = gfxMode_;
+    ckpt.wlt = lastWlt_.load();
+    checkpoint_.save(ckpt);
+}
+
+void SocDaemon::publishSharedState(const char* decisionReason) {
+    if (!sharedState_.enabled()) return;
+    SharedStatePayload state;
+    state.ccState = static_cast<int32_t>(CCGlobalState_.load());
+    state.efficientMode = efficientMode_;
+    state.gfxMode = gfxMode_;
+    state.wlt = lastWlt_.load();
+    state.thermalPressure = thermalPressure_.load();
+    state.sysCpuLoad = static_cast<float>(getLatestSysCpuLoad());
+    if (GpuLoadMonitor* gpu = gpuLoadMonitor()) {
+        state.gpuBusyPercent = static_cast<float>(gpu->getBusyPercent());
+        state.gpuWeightedLoad = static_cast<float>(gpu->getWeightedLoad());
+    }
+    if (fusionMode()) state.fusionScore = static_cast<float>(fusionEngine_.score());
+    sharedState_.publish(state, decisionReason);
+}
+
+HintMonitor* SocDaemon::gpuMonitor() const noexcept {
+    if (GpuLoadMonitor* gpu = gpuLoadMonitor()) {
+        return gpu;
+    }
+    return gpuRc6Monitor();
+}
+
+double SocDaemon::getGpuBusyPercent() const noexcept {
+    HintMonitor* monitor = gpuMonitor();
+    if (!monitor || !monitor->isSampling()) return -1.0;
+    GpuLoadMonitor* gpu = gpuLoadMonitor();
+    return gpu ? gpu->getBusyPercent() : gpuRc6Monitor()->getBusyPercent();
+}
+
+void SocDaemon::pauseGpuMonitor() {
+    if (GpuLoadMonitor* gpu = gpuLoadMonitor()) {
+        gpu->pause();
+    } else if (GpuRc6Monitor* rc6 = gpuRc6Monitor()) {
+        rc6->pause();
+    }
+    ALOGI("SocDaemon: Paused GPU monitor for WLT Idle/Btl");
+}
+
+void SocDaemon::resumeGpuMonitor() {
+    if (GpuLoadMonitor* gpu = gpuLoadMonitor()) {
+        gpu->resume();
+    } else if (GpuRc6Monitor* rc6 = gpuRc6Monitor()) {
+        rc6->resume();
+    }
+    samplingClock_.wake();
+    ALOGI("SocDaemon: Resumed GPU monitor for WLT Sustain/Bursty");
+}
+
+bool SocDaemon::requestCCState(CCGlobalState state, const char* reason) {
+    bool change = CCGlobalState_.load() != state;
+    sendHintIfAllowed(state == CCGlobalState::CoreContainment ? 1 : 0, reason, true);
+    return change;
+}
+
+SocDaemon::CCGlobalState SocDaemon::exchangeCCState(CCGlobalState state) {
+    CCGlobalState prev = CCGlobalState_.exchange(state);
+    ccResidency_.transition(static_cast<int>(state));
+    if (state != prev) {
+        if (state == CCGlobalState::CoreContainment) latestSysCpuLoadCC_ = getLatestSysCpuLoad();
+        thermalHoldSince_ = 0; // each containment gets its own bounded hold
+        publishSharedState(nullptr);
+        evaluateShadow("ActiveTransition");
+        updateTuning(state == CCGlobalState::CoreContainment ? "EnterCoreContainment" : "ExitCoreContainment");
+    }
+    if (raplMonitorPtr_) raplMonitorPtr_->setState(RaplMonitor::kCcAccount, static_cast<int>(state));
+    return prev;
+}
+
+void SocDaemon::updateFusionSignal(FusionSignal signal, double value) {
+    if (fusionMode()) fusionEngine_.update(signal, value);
+    if (shadowPolicy_) shadowPolicy_->update(signal, value);
+}
+
+void SocDaemon::evaluateShadow(const char* reason) {
+    if (shadowPolicy_) shadowPolicy_->evaluate(CCGlobalState_.load() == CCGlobalState::CoreContainment, reason);
+}
+
+void SocDaemon::updateFusionSamples() {
+    // A paused monitor still reports its last value; only inputs being sampled are fed.
+    bool loadSampled = sysLoadMonitorPtr_ && sysLoadMonitorPtr_->isSampling();
+    double load = loadSampled ? getLatestSysCpuLoad() : -1.0;
+    std::shared_ptr<const PolicyParams> policy = params();
+    if (load < 0.0) {
+        fusionPrevLoad_ = -1.0; // no slope across a gap
+    } else {
+        updateFusionSignal(FusionSignal::SysLoad, 1.0 - load / (2.0 * policy->sysloadEntryThreshold));
+        if (fusionPrevLoad_ >= 0.0) {
+            double slope = load - fusionPrevLoad_;
+            updateFusionSignal(FusionSignal::SysLoadSlope, 1.0 - slope / (2.0 * policy->sysloadSlopeThreshold));
+        }
+        fusionPrevLoad_ = load;
+    }
+    HintMonitor* gpu = gpuMonitor();
+    double gpuBusy = gpu && gpu->isSampling() ? getGpuBusyPercent() : -1.0;
+    if (gpuBusy >= 0.0) {
+        updateFusionSignal(FusionSignal::GpuBusy, 1.0 - gpuBusy / 100.0);
+    }
+}
+
+void SocDaemon::evaluateFusion() {
+    bool contained = CCGlobalState_.load() == CCGlobalState::CoreContainment;
+    FusionEngine::Decision decision = fusionEngine_.decide(contained);
+    readiness_.mark(StartupReadiness::kFirstDecision); // Hold is a decision as well
+    if (decision == FusionEngine::Decision::Hold) return;
+
+    ALOGI("SocDaemon: Fusion score=%.3f confidence=%.3f -> %s", fusionEngine_.score(), fusionEngine_.confidence(),
+          decision == FusionEngine::Decision::Enter ? "CoreContainment" : "Open");
+    if (decision == FusionEngine::Decision::Enter) {
+        if (isCCEntryHeldOff()) return;
+        requestCCState(CCGlobalState::CoreContainment, "FusionScoreAboveEnterBand");
+    } else {
+        if (holdExitForThermal()) {
+            ALOGI("SocDaemon: Fusion exit held, near a thermal limit");
+            return;
+        }
+        requestCCState(CCGlobalState::Open, "FusionScoreBelowExitBand");
+    }
+}
+
+bool SocDaemon::holdExitForThermal() noexcept {
+    if (!isThermalPressureHigh()) return false;
+    int wlt = lastWlt_.load();
+    if (wlt >= 0 && static_cast<WltType>(wlt & 0x3) == WltType::Bursty) return false; // the burst needs the P-cores now
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::chrono::steady_clock::rep since = 0;
+    if (thermalHoldSince_.compare_exchange_strong(since, now)) since = now;
+    if (now - since < std::chrono::duration_cast<std::chrono::steady_clock::duration>(kMaxThermalHold).count()) {
+        return true;
+    }
+    ALOGI("SocDaemon: Exit held for thermal pressure longer than %llds, releasing it",
+          static_cast<long long>(kMaxThermalHold.count()));
+    return false;
+}
+
+void SocDaemon::handleThermalPressure(int level) {
+    thermalPressure_ = level;
+    if (level < kThermalNear) thermalHoldSince_ = 0;
+    notifyStateChange("thermal_pressure", level, "ThermalPressure");
+    updateTuning("ThermalPressure");
+    if (level < kThermalNear || CCGlobalState_.load() != CCGlobalState::Open) return;
+
+    // Enter early instead of waiting out the entry debounce, but only when
+    // containment was already on its way (WLT Idle/Btl) and the load allows it.
+    if (!isCCEntryDebounceTimerRunning()) return;
+    double load = entrySysCpuLoad(); // negative: not sampled yet, let the debounce decide
+    if (isCCEntryHeldOff() || load < 0.0 || load >= params()->sysloadEntryThreshold) return;
+    stopCCEntryDebounceTimer();
+    requestCCState(CCGlobalState::CoreContainment, "ThermalPressureEarlyEntry");
+}
+
+bool SocDaemon::isCCEntryHeldOff() const noexcept {
+    return std::chrono::steady_clock::now().time_since_epoch().count() < ccEntryHoldOffUntil_.load();
+}
+
+void SocDaemon::armCCEntryHoldOff() noexcept {
+    ccEntryHoldOffUntil_ = (std::chrono::steady_clock::now() + kParkedWakeHoldOff).time_since_epoch().count();
+}
+
+void SocDaemon::retryDeferredHints() {
+    int value = efficientGovernor_.duePending();
+    if (value >= 0) {
+        sendHintIfAllowed(value, "DeferredByGovernor", deferredMovesCC_.load());
+    }
+    value = gfxGovernor_.duePending();
+    if (value >= 0) {
+        sendGfxHintIfAllowed(value, "DeferredByGovernor");
+    }
+}
+
+void SocDaemon::updatePl1() {
+    Pl1Controller::Inputs in;
+    in.gpuActive = gpuLoadMonitor()->isSampling();
+    in.gpuBusyPercent = gpuLoadMonitor()->getBusyPercent();
+    in.gpuPowerLimited = gpuLoadMonitor()->isPowerLimited();
+    in.gpuThermalLimited = gpuLoadMonitor()->isThermalLimited();
+    if (raplMonitorPtr_) in.packageW = raplMonitorPtr_->samplePowerW();
+    if (hfiMonitor()) {
+        HfiMonitor::ThermalStatus status = hfiMonitor()->thermalStatus();
+        in.tripCrossed = status.level >= kThermalThrottling;
+        in.headroomMC = status.headroomMC;
+    }
+    in.apply = params()->sendGfxHint;
+    pl1Controller()->update(in);
+}
+
+void SocDaemon::updateTuning(const char* reason) {
+    int wlt = lastWlt_.load();
+    if (!tuningLadder_ || wlt < 0) return;
+    int rung = wlt & 0x3;
+    if (CCGlobalState_.load() == CCGlobalState::CoreContainment) {
+        rung = std::min<int>(rung, TuningLadder::kBtl); // contained work gets no P-core boost
+    }
+    if (isThermalPressureHigh()) {
+        rung = std::min<int>(rung, TuningLadder::kSustain); // boosting near a trip only throttles
+    }
+    tuningLadder_->request(rung, reason);
+    if (tuningLadder_->hasPending()) samplingClock_.wake(); // downgrade hold runs on the clock
+}
+
+std::vector<ResidencyTracker*> SocDaemon::residencyTrackers() {
+    std::vector<ResidencyTracker*> trackers{&ccResidency_, &wltResidency_, &efficientResidency_, &gfxResidency_};
+    if (tuningLadder_) trackers.push_back(&tuningLadder_->residency());
+    return trackers;
+}
+
+bool SocDaemon::sendHalHint(const char* type, int value) {
+    bool efficient = strcmp(type, "EFFICIENT_POWER") == 0;
+    if (!hintManager.isPowerHalConnected()) {
+        // Kept as desired state until the connection is made; fails once it is known to be impossible.
+        bool buffered = hintManager.sendHint(type, value);
+        if (buffered) {
+            counters_.halHintsBuffered++;
         } else {
-            ALOGD("SocDaemon: GFX Hint value unchanged (%d), not sending: %s", value, reason);
+            (efficient ? counters_.efficientHintsFailed : counters_.gfxHintsFailed)++;
+        }
+        return buffered;
     }
+
+    auto begin = std::chrono::steady_clock::now();
+    bool ok;
+    {
+        Watchdog::Call call(watchdog_, efficient ? halEfficientCall_ : halGfxCall_);
+        ok = hintManager.sendHint(type, value);
+    }
+    halLatencyUs_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+    if (efficient) {
+        (ok ? counters_.efficientHintsSent : counters_.efficientHintsFailed)++;
+    } else {
+        (ok ? counters_.gfxHintsSent : counters_.gfxHintsFailed)++;
+    }
+    return ok;
 }
 
-// Static wrapper for pthreads_
-void* SocDaemon::monitorSysfsWrapper(void* arg) noexcept {
-    HintMonitor* monitor = static_cast<HintMonitor*>(arg);
-    monitor->monitorLoop();
-    return nullptr;
+void SocDaemon::handleUndeliveredHints(bool connected, const std::map<std::string, bool>& undelivered) {
+    for (const auto& [type, value] : undelivered) {
+        bool efficient = type == "EFFICIENT_POWER";
+        bool gfx = type == "GFX_MODE";
+        if (efficient || gfx) {
+            // Counted as buffered when decided; the decision itself stands, like any failed send.
+            (efficient ? counters_.efficientHintsFailed : counters_.gfxHintsFailed)++;
+        }
+        if (!connected) continue;
+        // The connection is up: send the current value, which may have moved on since it was buffered.
+        if (efficient || gfx) {
+            int current = efficient ? efficientMode_.load() : gfxMode_.load();
+            ALOGI("SocDaemon: Re-sending %s: %d, buffered %d was not delivered", type.c_str(), current, value);
+            sendHalHint(type.c_str(), current);
+        } else {
+            // TUNE_* modes of the tuning ladder
+            Watchdog::Call call(watchdog_, halTuneCall_);
+            hintManager.sendHint(type, value);
+        }
+    }
+}
+
+void SocDaemon::notifyStateChange(const char* key, int value, const char* reason) {
+    bool decision = !strcmp(key, "efficient_mode") || !strcmp(key, "gfx_mode");
+    publishSharedState(decision ? reason : nullptr);
+    if (!controlServer_) return;
+
+    if (controlServer_->hasSubscribers("events")) {
+        long long uptimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startTime_).count();
+        char buf[256];
+        snprintf(buf, sizeof(buf), "EVENT t_ms=%lld %s=%d cc_state=%d reason=\"%s\"\n", uptimeMs, key, value,
+                 static_cast<int>(CCGlobalState_.load()), reason);
+        controlServer_->publish("events", buf);
+        counters_.eventsPublished++;
+    }
+    if (controlServer_->hasSubscribers("metrics")) {
+        controlServer_->publish("metrics", formatMetrics());
+    }
+}
+
+void SocDaemon::handleWatchdogAlert(const Watchdog::Alert& alert) {
+    const char* state = alert.recovered ? "recovered" : alert.exited ? "exited" : alert.lost ? "lost" : "stalled";
+    if (!alert.recovered) {
+        ALOGE("SocDaemon: Watchdog: %s %s after %lldms (expected %lldms)", alert.channel.c_str(), state,
+              static_cast<long long>(alert.stalled.count()), static_cast<long long>(alert.expected.count()));
+    }
+
+    // The input driving containment is gone: do not stay stuck in whatever state it left.
+    bool driving = (alert.channel == "WltMonitor" && (socHint_ == "wlt" || socHint_ == "swlt")) ||
+                   (alert.channel == "HfiMonitor" && socHint_ == "hfi");
+    // swlt and hfi send EFFICIENT_POWER without moving CCGlobalState_, so gate on the hint itself.
+    // Released from the policy thread: the watchdog never waits on a decision (or a stalled HAL call).
+    if (driving && !alert.recovered && efficientMode_.load()) {
+        ALOGE("SocDaemon: %s is not delivering, releasing EFFICIENT_POWER", alert.channel.c_str());
+        policyQueue_.post([this] {
+            stopCCEntryDebounceTimer();
+            stopCCExitDebounceTimer();
+            requestCCState(CCGlobalState::Open, "WatchdogInputStalled");
+        }, "WatchdogInputStalled");
+    }
+
+    if (controlServer_ && controlServer_->hasSubscribers("events")) {
+        long long uptimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startTime_).count();
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "ALERT t_ms=%lld watchdog=%s channel=%s state=%s stalled_ms=%lld expected_ms=%lld cc_state=%d\n",
+                 uptimeMs, alert.kind == Watchdog::Kind::Heartbeat ? "heartbeat" : "deadline",
+                 alert.channel.c_str(), state, static_cast<long long>(alert.stalled.count()),
+                 static_cast<long long>(alert.expected.count()), static_cast<int>(CCGlobalState_.load()));
+        controlServer_->publish("events", buf);
+        counters_.eventsPublished++;
+    }
+}
+
+std::string SocDaemon::handleControlRequest(const std::string& command, const std::string& args) {
+    if (command == "PING") return "PONG\n";
+    if (command == "STATE") return formatState();
+    if (command == "COUNTERS") return formatCounters();
+    if (command == "CONFIG") return formatConfig();
+    if (command == "METRICS") return formatMetrics();
+    if (command == "HISTOGRAMS") {
+        std::string out;
+        halLatencyUs_.appendText(out, "hal_set_mode_us");
+        if (schedDelayMonitorPtr_) schedDelayMonitorPtr_->appendHistogram(out);
+        return out;
+    }
+    if (command == "CGROUPS") {
+        if (!cgroupCpuMonitorPtr_) return "ERR cgroup accounting not available\n";
+        std::string out;
+        char buf[128];
+        for (const auto& usage : cgroupCpuMonitorPtr_->getUsage()) {
+            snprintf(buf, sizeof(buf), "%s cpu_percent=%.1f throttled_percent=%.1f\n", usage.group.c_str(),
+                     usage.cpuPercent, usage.throttledPercent);
+            out += buf;
+        }
+        return out;
+    }
+    if (command == "HOTTHREADS") {
+        if (!hotThreadMonitorPtr_) return "ERR top-app task list not available\n";
+        std::string out;
+        char buf[160];
+        for (const auto& thread : hotThreadMonitorPtr_->getTracked()) {
+            snprintf(buf, sizeof(buf), "tid=%d comm=%s cpu_percent=%.1f saturated_ms=%lld\n", thread.tid,
+                     thread.comm.c_str(), thread.percent, thread.saturatedMs);
+            out += buf;
+        }
+        return out;
+    }
+    if (command == "SCHEDDELAY") {
+        if (!schedDelayMonitorPtr_) return "ERR schedstat not available\n";
+        SchedDelayMonitor::WindowStats stats = schedDelayMonitorPtr_->getStats();
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "p95_delay_us=%.0f\nmax_delay_us=%.0f\ncontained_cpu_delay_us=%.0f\nwaiting_tasks=%.2f\n"
+                 "tasks_ran=%zu\ntasks_listed=%zu\n",
+                 stats.p95DelayUs, stats.maxDelayUs, stats.cpuDelayUs, stats.waitingTasks, stats.tasks, stats.tracked);
+        return buf;
+    }
+    if (command == "FORECAST") {
+        if (!loadForecasterPtr_) return "ERR /proc/stat not available\n";
+        std::string out;
+        char buf[224];
+        snprintf(buf, sizeof(buf), "horizon_ms=%lld\n", static_cast<long long>(LoadForecaster::kHorizon.count()));
+        out += buf;
+        for (int s = 0; s < LoadForecaster::kSeriesCount; ++s) {
+            LoadForecaster::Forecast f = loadForecasterPtr_->getForecast(static_cast<LoadForecaster::Series>(s));
+            snprintf(buf, sizeof(buf),
+                     "series=%s current=%.1f trend_per_s=%.2f predicted=%.1f bound=%.1f capacity=%.1f samples=%u\n",
+                     LoadForecaster::seriesName(s), f.current, f.trendPerS, f.predicted, f.bound, f.capacity,
+                     f.samples);
+            out += buf;
+        }
+        return out;
+    }
+    if (command == "READY") {
+        std::string out;
+        char buf[96];
+        snprintf(buf, sizeof(buf), "hal_connected=%d\nhints_pending=%zu\n", hintManager.isPowerHalConnected(),
+                 hintManager.pendingHints());
+        out += buf;
+        readiness_.appendText(out);
+        return out;
+    }
+    if (command == "WATCHDOG") {
+        std::string out;
+        watchdog_.appendText(out);
+        return out;
+    }
+    if (command == "PARAMS") {
+        std::string out;
+        policy_.appendText(out);
+        return out;
+    }
+    if (command == "RELOAD") {
+        std::string error;
+        if (!policy_.reload(error)) return "ERR " + error + "\n";
+        return "OK version=" + std::to_string(params()->version) + "\n";
+    }
+    if (command == "SHADOW") {
+        if (!shadowPolicy_) return "ERR shadow policy not enabled\n";
+        std::string out;
+        shadowPolicy_->appendText(out);
+        return out;
+    }
+    if (command == "ENERGY") {
+        if (!raplMonitorPtr_) return "ERR RAPL energy not available\n";
+        std::string out;
+        raplMonitorPtr_->appendText(out);
+        return out;
+    }
+    if (command == "TUNING") {
+        if (!tuningLadder_) return "ERR tuning ladder not enabled\n";
+        std::string out;
+        tuningLadder_->appendText(out);
+        return out;
+    }
+    if (command == "PL1") {
+        if (!pl1Controller()) return "ERR PL1 controller not enabled\n";
+        std::string out;
+        pl1Controller()->appendText(out);
+        return out;
+    }
+    if (command == "THERMAL") {
+        if (!hfiMonitor()) return "ERR thermal netlink not available\n";
+        HfiMonitor::ThermalStatus status = hfiMonitor()->thermalStatus();
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "pressure=%d\nheadroom_mc=%d\nhottest_zone=%d\ntrips_crossed=%d\ncdevs_engaged=%d\n"
+                 "trip_events=%" PRIu64 "\ncdev_updates=%" PRIu64 "\n",
+                 status.level, status.headroomMC, status.hottestZone, status.trippedTrips, status.activeCdevs,
+                 status.tripEvents, status.cdevUpdates);
+        return buf;
+    }
+    if (command == "IDLE") {
+        if (!cpuIdleMonitorPtr_) return "ERR cpuidle residency not available\n";
+        std::string out;
+        char buf[192];
+        const struct { const char* name; CpuIdleMonitor::Cluster cluster; } clusters[] = {
+            {"parked", CpuIdleMonitor::kParked},
+            {"contained", CpuIdleMonitor::kContained},
+        };
+        for (const auto& c : clusters) {
+            CpuIdleMonitor::ClusterIdle idle = cpuIdleMonitorPtr_->getCluster(c.cluster);
+            snprintf(buf, sizeof(buf), "%s cpus=%d deep_percent=%.1f wakeups_per_s=%.0f deep_open_avg=%.1f deep_cc_avg=%.1f\n",
+                     c.name, idle.cpus, idle.deepPercent, idle.wakeupsPerSec, idle.deepOpenAvg, idle.deepContainedAvg);
+            out += buf;
+        }
+        snprintf(buf, sizeof(buf), "entry_held_off=%d\n", isCCEntryHeldOff() ? 1 : 0);
+        out += buf;
+        return out;
+    }
+    if (command == "FUSION") {
+        std::string out;
+        fusionEngine_.appendText(out);
+        return out;
+    }
+    if (command == "PREDICTOR") {
+        std::string out;
+        wltPredictor_.appendText(out);
+        return out;
+    }
+    if (command == "RESIDENCY") {
+        if (args == "reset") {
+            for (ResidencyTracker* tracker : residencyTrackers()) tracker->reset();
+            return "OK residency reset\n";
+        }
+        if (!args.empty()) return "ERR usage: RESIDENCY [reset]\n";
+        std::string out;
+        for (ResidencyTracker* tracker : residencyTrackers()) tracker->appendText(out);
+        return out;
+    }
+    if (command == "SUBSCRIBE") {
+        // Initial snapshot so subscribers do not have to race a separate query.
+        if (args == "metrics") {
+            samplingClock_.wake(); // the clock may be idle with no other source active
+            return formatMetrics();
+        }
+        return formatState();
+    }
+    if (command == "HELP") {
+        return "PING STATE COUNTERS HISTOGRAMS RESIDENCY [reset] PREDICTOR FUSION CGROUPS HOTTHREADS SCHEDDELAY FORECAST IDLE THERMAL PL1 TUNING ENERGY SHADOW PARAMS RELOAD READY WATCHDOG CONFIG METRICS SUBSCRIBE <events|metrics> "
+               "UNSUBSCRIBE <events|metrics>\n";
+    }
+    return "ERR unknown command " + command + "\n";
+}
+
+std::string SocDaemon::formatState() const {
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf),
+                       "cc_state=%s\nefficient_mode=%d\ngfx_mode=%d\nwlt=%d\nsys_cpu_load=%.2f\n"
+                       "entry_debounce=%d\nexit_debounce=%d\nthermal_pressure=%d\n",
+                       CCGlobalState_.load() == CCGlobalState::CoreContainment ? "CoreContainment" : "Open",
+                       efficientMode_.load(), gfxMode_.load(), lastWlt_.load(), getLatestSysCpuLoad(),
+                       isCCEntryDebounceTimerRunning(), isCCExitDebounceTimerRunning(), thermalPressure_.load());
+    std::string out(buf, len > 0 ? std::min<size_t>(len, sizeof(buf) - 1) : 0);
+    if (gpuLoadMonitor()) {
+        snprintf(buf, sizeof(buf), "gpu_busy=%.1f\ngpu_weighted_load=%.1f\ngpu_power_limited=%d\ngpu_thermal_limited=%d\n",
+                 gpuLoadMonitor()->getBusyPercent(), gpuLoadMonitor()->getWeightedLoad(),
+                 gpuLoadMonitor()->isPowerLimited(), gpuLoadMonitor()->isThermalLimited());
+        out += buf;
+    }
+    return out;
+}
+
+std::string SocDaemon::formatCounters() const {
+    char buf[1024];
+    snprintf(buf, sizeof(buf),
+             "alerts_wlt=%" PRIu64 "\nalerts_hfi=%" PRIu64 "\nalerts_sysload=%" PRIu64 "\nalerts_gpu=%" PRIu64 "\n"
+             "alerts_cgroup=%" PRIu64 "\nalerts_cpuidle=%" PRIu64 "\nalerts_thermal=%" PRIu64 "\n"
+             "alerts_hotthread=%" PRIu64 "\nalerts_sched_delay=%" PRIu64 "\nalerts_forecast=%" PRIu64 "\n"
+             "hints_efficient_sent=%" PRIu64 "\nhints_efficient_failed=%" PRIu64 "\n"
+             "hints_gfx_sent=%" PRIu64 "\nhints_gfx_failed=%" PRIu64 "\nhints_buffered=%" PRIu64 "\n"
+             "events_published=%" PRIu64 "\npolicy_queue_pending=%zu\npolicy_queue_coalesced=%" PRIu64 "\n",
+             counters_.wltAlerts.load(), counters_.hfiAlerts.load(), counters_.sysLoadAlerts.load(),
+             counters_.gpuAlerts.load(), counters_.cgroupAlerts.load(), counters_.cpuIdleAlerts.load(),
+             counters_.thermalAlerts.load(), counters_.hotThreadAlerts.load(), counters_.schedDelayAlerts.load(),
+             counters_.forecastAlerts.load(),
+             counters_.efficientHintsSent.load(),
+             counters_.efficientHintsFailed.load(),
+             counters_.gfxHintsSent.load(), counters_.gfxHintsFailed.load(), counters_.halHintsBuffered.load(),
+             counters_.eventsPublished.load(), policyQueue_.pending(), policyQueue_.coalesced());
+    std::string out(buf);
+    efficientGovernor_.appendText(out);
+    gfxGovernor_.appendText(out);
+    return out;
+}
+
+std::string SocDaemon::formatConfig() const {
+    std::chrono::milliseconds entryDebounce;
+    {
+        std::lock_guard<std::mutex> lock(debounceMutex_);
+        entryDebounce = ccEntryDebounceMs_;
+    }
+    std::shared_ptr<const PolicyParams> policy = params();
+    char buf[768];
+    snprintf(buf, sizeof(buf),
+             "send_hint=%d\nsend_gfx_hint=%d\nsoc_hint=%s\nnotification_delay=%d\nsample_tick_ms=%lld\n"
+             "timer_slack_us=%lld\nself_cpus=%s\nsampler_sched=%s\npolicy_nice=%d\ncgroup=%s\n"
+             "state_file=%s\nstate_max_age_s=%lld\ncontrol_socket=%s\nshared_state=%s\ncc_entry_debounce_ms=%lld\n"
+             "wlt_predictor=%d\nhint_budget=%u/%llds\nhint_min_hold_ms=%lld\n"
+             "fusion_bands=%.2f,%.2f,%.2f\ncontained_cpus=%s\nhal_deadline_ms=%lld\npl1_control=%d\ntune_ladder=%s\n",
+             policy->sendHint, policy->sendGfxHint, socHint_.c_str(), notificationDelay_,
+             static_cast<long long>(samplingClock_.baseTick().count()),
+             static_cast<long long>(options_.timerSlack.count()), options_.placement.cpus.c_str(),
+             options_.placement.samplerIdle ? "idle" : "nice", options_.placement.policyNice,
+             options_.placement.cgroupPath.c_str(), options_.stateFile.c_str(),
+             static_cast<long long>(options_.stateMaxAge.count()), options_.controlSocket.c_str(),
+             sharedState_.enabled() ? options_.sharedStateFile.c_str() : "",
+             static_cast<long long>(entryDebounce.count()), options_.wltPredictor,
+             options_.hintGovernor.maxToggles,
+             static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(options_.hintGovernor.window).count()),
+             static_cast<long long>(options_.hintGovernor.minHold.count()), options_.fusion.enterBand,
+             options_.fusion.exitBand, options_.fusion.minConfidence, options_.containedCpus.c_str(),
+             static_cast<long long>(options_.halDeadline.count()), pl1Controller() != nullptr,
+             tuningLadder_ ? TuneConfig::backendName(options_.tuning.backend) : "none");
+    return buf;
+}
+
+std::string SocDaemon::formatMetrics() const {
+    std::string out;
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "# TYPE socdaemon_cc_state gauge\nsocdaemon_cc_state %d\n"
+             "# TYPE socdaemon_efficient_mode gauge\nsocdaemon_efficient_mode %d\n"
+             "# TYPE socdaemon_gfx_mode gauge\nsocdaemon_gfx_mode %d\n"
+             "# TYPE socdaemon_wlt gauge\nsocdaemon_wlt %d\n",
+             static_cast<int>(CCGlobalState_.load()), efficientMode_.load(), gfxMode_.load(), lastWlt_.load());
+    out += buf;
+    snprintf(buf, sizeof(buf), "# TYPE socdaemon_sys_cpu_load_percent gauge\nsocdaemon_sys_cpu_load_percent %.2f\n",
+             getLatestSysCpuLoad());
+    out += buf;
+    if (gpuLoadMonitor()) {
+        snprintf(buf, sizeof(buf),
+                 "# TYPE socdaemon_gpu_busy_percent gauge\nsocdaemon_gpu_busy_percent %.1f\n"
+                 "# TYPE socdaemon_gpu_weighted_load_percent gauge\nsocdaemon_gpu_weighted_load_percent %.1f\n",
+                 gpuLoadMonitor()->getBusyPercent(), gpuLoadMonitor()->getWeightedLoad());
+        out += buf;
+    }
+
+    if (fusionMode()) {
+        snprintf(buf, sizeof(buf),
+                 "# TYPE socdaemon_fusion_score gauge\nsocdaemon_fusion_score %.3f\n"
+                 "# TYPE socdaemon_fusion_confidence gauge\nsocdaemon_fusion_confidence %.3f\n",
+                 fusionEngine_.score(), fusionEngine_.confidence());
+        out += buf;
+    }
+
+    if (hotThreadMonitorPtr_) {
+        snprintf(buf, sizeof(buf), "# TYPE socdaemon_top_thread_percent gauge\nsocdaemon_top_thread_percent %.1f\n",
+                 hotThreadMonitorPtr_->getHottestPercent());
+        out += buf;
+    }
+
+    if (schedDelayMonitorPtr_) {
+        SchedDelayMonitor::WindowStats stats = schedDelayMonitorPtr_->getStats();
+        snprintf(buf, sizeof(buf),
+                 "# TYPE socdaemon_sched_delay_p95_us gauge\nsocdaemon_sched_delay_p95_us %.0f\n"
+                 "# TYPE socdaemon_contained_cpu_delay_us gauge\nsocdaemon_contained_cpu_delay_us %.0f\n",
+                 stats.p95DelayUs, stats.cpuDelayUs);
+        out += buf;
+        out += "# HELP socdaemon_sched_delay_window_p95_seconds Distribution of the per-window p95 foreground "
+               "run-queue wait per timeslice, one observation per sched delay window\n";
+        out += "# TYPE socdaemon_sched_delay_window_p95_seconds histogram\n";
+        schedDelayMonitorPtr_->appendOpenMetrics(out);
+    }
+
+    if (loadForecasterPtr_) {
+        out += "# TYPE socdaemon_load_forecast_percent gauge\n";
+        for (int s = 0; s < LoadForecaster::kSeriesCount; ++s) {
+            LoadForecaster::Forecast f = loadForecasterPtr_->getForecast(static_cast<LoadForecaster::Series>(s));
+            if (f.samples == 0) continue;
+            snprintf(buf, sizeof(buf),
+                     "socdaemon_load_forecast_percent{series=\"%s\",bound=\"lower\"} %.1f\n"
+                     "socdaemon_load_forecast_percent{series=\"%s\",bound=\"upper\"} %.1f\n",
+                     LoadForecaster::seriesName(s), f.predicted - f.bound, LoadForecaster::seriesName(s),
+                     f.predicted + f.bound);
+            out += buf;
+        }
+    }
+
+    if (cgroupCpuMonitorPtr_) {
+        out += "# TYPE socdaemon_cgroup_cpu_percent gauge\n";
+        for (const auto& usage : cgroupCpuMonitorPtr_->getUsage()) {
+            snprintf(buf, sizeof(buf), "socdaemon_cgroup_cpu_percent{group=\"%s\"} %.1f\n", usage.group.c_str(),
+                     usage.cpuPercent);
+            out += buf;
+        }
+    }
+
+    if (hfiMonitor()) {
+        HfiMonitor::ThermalStatus status = hfiMonitor()->thermalStatus();
+        snprintf(buf, sizeof(buf),
+                 "# TYPE socdaemon_thermal_pressure gauge\nsocdaemon_thermal_pressure %d\n"
+                 "# TYPE socdaemon_thermal_headroom_celsius gauge\nsocdaemon_thermal_headroom_celsius %.1f\n",
+                 status.level, status.headroomMC >= 0 ? status.headroomMC / 1000.0 : -1.0);
+        out += buf;
+    }
+    if (raplMonitorPtr_) raplMonitorPtr_->appendOpenMetrics(out);
+    if (pl1Controller()) pl1Controller()->appendOpenMetrics(out);
+    if (tuningLadder_) tuningLadder_->appendOpenMetrics(out);
+    if (shadowPolicy_) shadowPolicy_->appendOpenMetrics(out);
+    watchdog_.appendOpenMetrics(out);
+
+    if (cpuIdleMonitorPtr_) {
+        out += "# TYPE socdaemon_cluster_deep_idle_percent gauge\n";
+        const struct { const char* name; CpuIdleMonitor::Cluster cluster; } clusters[] = {
+            {"parked", CpuIdleMonitor::kParked},
+            {"contained", CpuIdleMonitor::kContained},
+        };
+        for (const auto& c : clusters) {
+            CpuIdleMonitor::ClusterIdle idle = cpuIdleMonitorPtr_->getCluster(c.cluster);
+            snprintf(buf, sizeof(buf),
+                     "socdaemon_cluster_deep_idle_percent{cluster=\"%s\",phase=\"last\"} %.1f\n"
+                     "socdaemon_cluster_deep_idle_percent{cluster=\"%s\",phase=\"open_avg\"} %.1f\n"
+                     "socdaemon_cluster_deep_idle_percent{cluster=\"%s\",phase=\"cc_avg\"} %.1f\n",
+                     c.name, idle.deepPercent, c.name, idle.deepOpenAvg, c.name, idle.deepContainedAvg);
+            out += buf;
+        }
+        out += "# TYPE socdaemon_cluster_idle_wakeups_per_second gauge\n";
+        for (const auto& c : clusters) {
+            snprintf(buf, sizeof(buf), "socdaemon_cluster_idle_wakeups_per_second{cluster=\"%s\"} %.0f\n", c.name,
+                     cpuIdleMonitorPtr_->getCluster(c.cluster).wakeupsPerSec);
+            out += buf;
+        }
+    }
+
+    out += "# TYPE socdaemon_monitor_alerts counter\n";
+    const struct { const char* monitor; uint64_t value; } alerts[] = {
+        {"wlt", counters_.wltAlerts.load()},
+        {"hfi", counters_.hfiAlerts.load()},
+        {"sysload", counters_.sysLoadAlerts.load()},
+        {"gpu", counters_.gpuAlerts.load()},
+        {"cgroup", counters_.cgroupAlerts.load()},
+        {"cpuidle", counters_.cpuIdleAlerts.load()},
+        {"hotthread", counters_.hotThreadAlerts.load()},
+        {"sched_delay", counters_.schedDelayAlerts.load()},
+        {"forecast", counters_.forecastAlerts.load()},
+        {"thermal", counters_.thermalAlerts.load()},
+    };
+    for (const auto& alert : alerts) {
+        snprintf(buf, sizeof(buf), "socdaemon_monitor_alerts_total{monitor=\"%s\"} %" PRIu64 "\n", alert.monitor,
+                 alert.value);
+        out += buf;
+    }
+
+    out += "# TYPE socdaemon_hints counter\n";
+    const struct { const char* type; const char* result; uint64_t value; } hints[] = {
+        {"EFFICIENT_POWER", "sent", counters_.efficientHintsSent.load()},
+        {"EFFICIENT_POWER", "failed", counters_.efficientHintsFailed.load()},
+        {"GFX_MODE", "sent", counters_.gfxHintsSent.load()},
+        {"GFX_MODE", "failed", counters_.gfxHintsFailed.load()},
+    };
+    for (const auto& hint : hints) {
+        snprintf(buf, sizeof(buf), "socdaemon_hints_total{type=\"%s\",result=\"%s\"} %" PRIu64 "\n", hint.type,
+                 hint.result, hint.value);
+        out += buf;
+    }
+
+    out += "# TYPE socdaemon_governor_toggles counter\n";
+    efficientGovernor_.appendOpenMetrics(out);
+    gfxGovernor_.appendOpenMetrics(out);
+
+    readiness_.appendOpenMetrics(out);
+
+    out += "# TYPE socdaemon_hal_set_mode_seconds histogram\n";
+    halLatencyUs_.appendOpenMetrics(out, "socdaemon_hal_set_mode_seconds", "", 1e-6);
+
+    std::vector<const ResidencyTracker*> trackers{&ccResidency_, &wltResidency_, &efficientResidency_, &gfxResidency_};
+    if (tuningLadder_) trackers.push_back(&tuningLadder_->residency());
+    ResidencyTracker::appendOpenMetrics(out, trackers);
+
+    snprintf(buf, sizeof(buf), "# TYPE socdaemon_uptime_seconds gauge\nsocdaemon_uptime_seconds %lld\n# EOF\n",
+             static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+                     std::chrono::steady_clock::now() - startTime_).count()));
+    out += buf;
+    return out;
 }
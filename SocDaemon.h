@@ -6,6 +6,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <cerrno>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <pthread.h>
@@ -13,6 +14,8 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <future>
+#include <type_traits>
 
 #include "HintManager.h"
 #include "HintMonitor.h"
@@ -20,6 +23,30 @@
 #include "WltMonitor.h"
 #include "HfiMonitor.h"
 #include "GpuRc6Monitor.h"
+#include "GpuLoadMonitor.h"
+#include "CgroupCpuMonitor.h"
+#include "HotThreadMonitor.h"
+#include "SchedDelayMonitor.h"
+#include "LoadForecaster.h"
+#include "CpuIdleMonitor.h"
+#include "RaplMonitor.h"
+#include "SamplingClock.h"
+#include "ThreadPlacement.h"
+#include "PolicyQueue.h"
+#include "StateCheckpoint.h"
+#include "SharedState.h"
+#include "ControlServer.h"
+#include "Histogram.h"
+#include "ResidencyTracker.h"
+#include "WltPredictor.h"
+#include "HintGovernor.h"
+#include "FusionEngine.h"
+#include "ShadowPolicy.h"
+#include "PolicyParams.h"
+#include "Watchdog.h"
+#include "Pl1Controller.h"
+#include "TuningLadder.h"
+#include "StartupReadiness.h"
 
 // Logging helpers (avoid leaking macro LOG_TAG into other translation units)
 inline constexpr char kLogTag[] = "SocDaemon";
@@ -27,10 +54,60 @@ inline constexpr char kLogTag[] = "SocDaemon";
 #define ALOGI(...) __android_log_print(ANDROID_LOG_INFO, kLogTag, __VA_ARGS__)
 #define ALOGE(...) __android_log_print(ANDROID_LOG_ERROR, kLogTag, __VA_ARGS__)
 
+// Optional daemon settings beyond the original command line flags.
+struct SocDaemonOptions {
+    // Shared sampling clock for all periodic monitors
+    std::chrono::milliseconds sampleTick{kDefaultSamplingTick};
+    std::chrono::microseconds timerSlack{kDefaultTimerSlack};
+
+    // Placement of the daemon's own threads (affinity, scheduling class, cgroup)
+    PlacementConfig placement;
+
+    // Warm-start checkpoint (empty path disables persistence)
+    std::string stateFile{kDefaultStateFile};
+    std::chrono::seconds stateMaxAge{kDefaultStateMaxAge};
+
+    // Control/metrics socket (empty path disables it)
+    std::string controlSocket{kDefaultControlSocket};
+
+    // Memory-mapped seqlock state for zero-syscall readers (empty path disables it)
+    std::string sharedStateFile{kDefaultSharedStateFile};
+
+    // Adapt entry/exit debounce from the learned WLT dwell distributions
+    bool wltPredictor = false;
+
+    // Toggle budget / minimum hold / back-off applied to EFFICIENT_POWER and GFX_MODE
+    GovernorConfig hintGovernor;
+
+    // Weights and hysteresis bands of --socHint fusion
+    FusionConfig fusion;
+
+    // Record-only second policy compared against the active one (--shadow-weights/--shadow-bands)
+    bool shadowPolicy = false;
+    FusionConfig shadowFusion;
+
+    // Runtime-tunable thresholds/timers, reloaded on change (empty path disables it)
+    std::string policyFile{kDefaultPolicyFile};
+
+    // Deadline of one IPowerExt::setMode call before the watchdog reports it stalled
+    std::chrono::milliseconds halDeadline{kDefaultHalDeadline};
+
+    // CPUs the foreground cgroups are confined to while contained
+    std::string containedCpus{kDefaultContainedCpus};
+
+    // Closed-loop PL1 in place of the binary GFX_MODE bump (--pl1-range/--pl1-node)
+    bool pl1Control = false;
+    Pl1Config pl1;
+
+    // EPP/uclamp/platform profile/SoC slider bundle per workload class (--tune-ladder)
+    TuneConfig tuning;
+};
+
 class SocDaemon {
 public:
     // Constructor / main entry
-    SocDaemon(bool sendHint, bool sendGfxHint, const std::string& socHint, int notificationDelay) noexcept;
+    SocDaemon(bool sendHint, bool sendGfxHint, const std::string& socHint, int notificationDelay,
+              const SocDaemonOptions& options = SocDaemonOptions()) noexcept;
     ~SocDaemon() = default;
 
     // Start monitoring; may spawn threads.
@@ -51,9 +128,12 @@ private:
     void debounceThreadFunc();
 
     // Debounce control helpers
-    void startCCEntryDebounceTimer() noexcept;
+    void startCCEntryDebounceTimer(std::chrono::milliseconds timeout) noexcept;
     void stopCCEntryDebounceTimer() noexcept;
+    void releaseSysLoadSampling() noexcept; // pause the SysLoadMonitor unless something still reads it
     bool isCCEntryDebounceTimerRunning() const noexcept;
+    // Load sampled since the entry debounce started, or -1 if there is none yet.
+    double entrySysCpuLoad() const noexcept;
 
     void startCCExitDebounceTimer(std::chrono::milliseconds timeout =
                                       std::chrono::milliseconds(1000)) noexcept;
@@ -62,13 +142,84 @@ private:
 
     // Monitor callbacks and helpers
     void handleChangeAlert(const std::string& name, int oldValue, int newValue);
-    double getSysCpuLoad() const noexcept;
+    // Last load published by the SysLoadMonitor sample (-1 before the first one).
     double getLatestSysCpuLoad() const noexcept;
-    void sendHintIfAllowed(int value, const char* reason);
+    // moveCC: the hint moves CCGlobalState_ with it, once it is actually sent.
+    void sendHintIfAllowed(int value, const char* reason, bool moveCC = false);
     void sendGfxHintIfAllowed(int gfxMode, const char* reason);
+    HintMonitor* gpuMonitor() const noexcept;
+    // Busy % from whichever GPU monitor is in use; -1 while it is not sampling.
+    double getGpuBusyPercent() const noexcept;
+
+    // Warm start: restore the last checkpoint and reconcile the HAL with it.
+    void restoreCheckpoint();
+    void saveCheckpoint(); // posts writeCheckpoint() to the policy thread
+    void writeCheckpoint();
+    // Runs monitor->init() and records its readiness.
+    bool initMonitor(HintMonitor* monitor);
+    // Watchdog channel of a monitor, registered before the watchdog runs. `started`
+    // (may be empty) keeps it untimed until the monitor is started by a probe thread.
+    int watchMonitor(HintMonitor* monitor, std::function<bool()> started = nullptr);
+    // Routes the monitor's alerts and gives it a sampling clock source or a thread.
+    // Called from start() and from the probe threads once the policy core is up.
+    void startMonitor(std::unique_ptr<HintMonitor> monitor, int watch);
+    template <typename GpuMonitor>
+    void startGpuMonitor(std::unique_ptr<GpuMonitor> monitor, int watch);
+    void monitorStartDone(); // marks kMonitorsReady after the last one
+    void publishSharedState(const char* decisionReason); // decisionReason: nullptr unless a hint decision
+    void pauseGpuMonitor();
+    void resumeGpuMonitor();
+
+    // Containment decisions: asks the governor first, so a deferred EFFICIENT_POWER
+    // leaves CCGlobalState_ and everything derived from it untouched. Returns
+    // false when already in `state` (a deferred opposite toggle is dropped).
+    bool requestCCState(CCGlobalState state, const char* reason);
+    // All CCGlobalState_ transitions go through here so residency is accounted.
+    CCGlobalState exchangeCCState(CCGlobalState state);
+    std::vector<ResidencyTracker*> residencyTrackers();
 
-    // Static wrapper for pthreads
-    static void* monitorSysfsWrapper(void* arg) noexcept;
+    // --socHint fusion: refresh the sampled signals and act on the hysteresis decision.
+    bool fusionMode() const noexcept { return socHint_ == "fusion"; }
+    void updateFusionSignal(FusionSignal signal, double value);
+    void updateFusionSamples();
+    void evaluateFusion();
+    // Shadow mode: let the record-only policy decide on the same inputs.
+    void evaluateShadow(const char* reason);
+
+    // Entry is held off for a while after the parked cores were seen not sleeping.
+    bool isCCEntryHeldOff() const noexcept;
+    void armCCEntryHoldOff() noexcept;
+    // Near a thermal limit, containment is kept (and entered early): boosting P-cores only throttles.
+    bool isThermalPressureHigh() const noexcept { return thermalPressure_.load() >= kThermalNear; }
+    // Whether an exit should wait for the thermal pressure to drop: not for Bursty work, and
+    // for at most kMaxThermalHold from the first held exit.
+    bool holdExitForThermal() noexcept;
+    void handleThermalPressure(int level);
+
+    // Re-issue hints the governor deferred once they are due (sampling clock).
+    void retryDeferredHints();
+
+    // One Pl1Controller step from the GPU, RAPL and thermal inputs (sampling clock).
+    void updatePl1();
+
+    // Tuning ladder rung from the WLT class, capped while contained or near a thermal limit.
+    void updateTuning(const char* reason);
+
+    // HAL call with latency/failure accounting.
+    bool sendHalHint(const char* type, int value);
+    // Buffered hints that never reached the HAL: counted as failed, and re-sent if still wanted.
+    void handleUndeliveredHints(bool connected, const std::map<std::string, bool>& undelivered);
+
+    // Control socket: request dispatch, text views and push notifications.
+    std::string handleControlRequest(const std::string& command, const std::string& args);
+    std::string formatState() const;
+    std::string formatCounters() const;
+    std::string formatConfig() const;
+    std::string formatMetrics() const;
+    void notifyStateChange(const char* key, int value, const char* reason);
+
+    // Watchdog: stall/exit of a monitor thread or HAL call.
+    void handleWatchdogAlert(const Watchdog::Alert& alert);
 
     // --- Private data members ---
 
@@ -76,21 +227,107 @@ private:
     HintManager hintManager;
 
     // Monitors and their threads
-    std::vector<std::unique_ptr<HintMonitor>> monitors_;
+    std::vector<std::unique_ptr<HintMonitor>> monitors_; // guarded by monitorsMutex_, with threads_
+    std::mutex monitorsMutex_;
+    std::atomic<int> monitorsStarting_{0}; // probes (and the policy core) not done yet
+    SamplingClock samplingClock_; // services every monitor with periodTicks() > 0
+    ThreadPlacement placement_;
+    PolicyQueue policyQueue_; // alerts and decisions raised on the SCHED_IDLE clock thread
     SysLoadMonitor* sysLoadMonitorPtr_ = nullptr; // non-owning
-    GpuRc6Monitor* gpuRc6MonitorPtr_ = nullptr; // non-owning
-    pthread_t gpuMonitorThread_ = 0;
-    bool gpuMonitorThreadRunning_ = false;
-    std::vector<pthread_t> threads_;
+    CgroupCpuMonitor* cgroupCpuMonitorPtr_ = nullptr; // non-owning, sampled only in CoreContainment
+    HotThreadMonitor* hotThreadMonitorPtr_ = nullptr; // non-owning, sampled only in CoreContainment
+    SchedDelayMonitor* schedDelayMonitorPtr_ = nullptr; // non-owning, sampled only in CoreContainment
+    LoadForecaster* loadForecasterPtr_ = nullptr; // non-owning, sampled only in CoreContainment
+    CpuIdleMonitor* cpuIdleMonitorPtr_ = nullptr; // non-owning
+    RaplMonitor* raplMonitorPtr_ = nullptr; // non-owning, energy per state/episode
+    // Set once by their probe thread when the monitor starts; read through the accessors.
+    std::atomic<WltMonitor*> wltMonitorPtr_{nullptr}; // non-owning
+    std::atomic<HfiMonitor*> hfiMonitorPtr_{nullptr}; // non-owning, HFI hint and thermal pressure
+    std::atomic<GpuLoadMonitor*> gpuLoadMonitorPtr_{nullptr}; // non-owning
+    std::atomic<GpuRc6Monitor*> gpuRc6MonitorPtr_{nullptr}; // non-owning, fallback when GpuLoadMonitor is unavailable
+    HfiMonitor* hfiMonitor() const noexcept { return hfiMonitorPtr_.load(); }
+    GpuLoadMonitor* gpuLoadMonitor() const noexcept { return gpuLoadMonitorPtr_.load(); }
+    GpuRc6Monitor* gpuRc6Monitor() const noexcept { return gpuRc6MonitorPtr_.load(); }
+    // Null unless options_.pl1Control and GpuLoadMonitor started; owns PL1 instead of GFX_MODE.
+    std::unique_ptr<Pl1Controller> pl1Controller_; // set once, with pl1ControllerPtr_, by the GPU probe
+    std::atomic<Pl1Controller*> pl1ControllerPtr_{nullptr};
+    Pl1Controller* pl1Controller() const noexcept { return pl1ControllerPtr_.load(); }
+    std::unique_ptr<TuningLadder> tuningLadder_; // null unless --tune-ladder hint|direct
+    std::vector<std::thread> threads_; // event-driven monitor threads, guarded by monitorsMutex_ once probes run
 
     // Configuration/state
-    bool sendHint_;
-    bool sendGfxHint_;
     std::string socHint_;
     int notificationDelay_;
-    bool efficientMode_ = false;
-    bool gfxMode_ = false;
-    
+    SocDaemonOptions options_;
+    PolicyRegistry policy_; // sendHint/sendGfxHint from the command line are its defaults
+    // One snapshot per decision: read every field from the same copy.
+    std::shared_ptr<const PolicyParams> params() const noexcept { return policy_.current(); }
+    std::atomic<bool> efficientMode_{false};
+    std::atomic<bool> gfxMode_{false};
+    std::atomic<int> lastWlt_{-1};
+    std::atomic<int> thermalPressure_{kThermalNormal};
+    std::atomic<std::chrono::steady_clock::rep> thermalHoldSince_{0}; // steady_clock ticks, 0 when not holding
+    static constexpr std::chrono::seconds kMaxThermalHold{30};
+
+    // Policy state persisted across restarts
+    StateCheckpoint checkpoint_;
+    static constexpr unsigned kCheckpointPeriodTicks = 30; // while the EMA is being updated
+
+    // Fused state mapped read-only by other processes
+    SharedStateWriter sharedState_;
+
+    // Observability: exported over the control socket
+    std::unique_ptr<ControlServer> controlServer_;
+    std::chrono::steady_clock::time_point startTime_{std::chrono::steady_clock::now()};
+    StartupReadiness readiness_; // per-component readiness and time to first decision
+    struct Counters {
+        std::atomic<uint64_t> wltAlerts{0};
+        std::atomic<uint64_t> hfiAlerts{0};
+        std::atomic<uint64_t> sysLoadAlerts{0};
+        std::atomic<uint64_t> gpuAlerts{0};
+        std::atomic<uint64_t> cgroupAlerts{0};
+        std::atomic<uint64_t> cpuIdleAlerts{0};
+        std::atomic<uint64_t> hotThreadAlerts{0};
+        std::atomic<uint64_t> schedDelayAlerts{0};
+        std::atomic<uint64_t> forecastAlerts{0};
+        std::atomic<uint64_t> thermalAlerts{0};
+        std::atomic<uint64_t> efficientHintsSent{0};
+        std::atomic<uint64_t> efficientHintsFailed{0};
+        std::atomic<uint64_t> gfxHintsSent{0};
+        std::atomic<uint64_t> gfxHintsFailed{0};
+        std::atomic<uint64_t> halHintsBuffered{0}; // decided before the HAL connection was made
+        std::atomic<uint64_t> eventsPublished{0};
+    } counters_;
+    Histogram halLatencyUs_{{50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 250000}}; // IPowerExt::setMode
+    static constexpr unsigned kMetricsPeriodTicks = 10; // periodic push while someone subscribes
+
+    // Heartbeats of the monitor threads/sources and deadlines of the HAL calls
+    Watchdog watchdog_;
+    int halEfficientCall_ = -1;
+    int halGfxCall_ = -1;
+    int halTuneCall_ = -1;
+    static constexpr int kWltPollTimeoutMs = -1; // sysfs_notify() wakes the WLT loop; blocking there is healthy
+
+    // Time-in-state per policy variable; state indices match the enums/hint values.
+    ResidencyTracker ccResidency_{"cc_state", {"Open", "CoreContainment"}};
+    ResidencyTracker wltResidency_{"wlt", {"Idle", "Btl", "Sustain", "Bursty"}};
+    ResidencyTracker efficientResidency_{"efficient_mode", {"off", "on"}};
+    ResidencyTracker gfxResidency_{"gfx_mode", {"off", "on"}};
+
+    // Learned WLT transitions/dwell used to adapt the debounce timers
+    WltPredictor wltPredictor_;
+
+    // Anti-thrash governors on the HAL outputs. Every hint decision, whichever thread
+    // raises it, runs under decisionMutex_ so the governors track efficientMode_/gfxMode_.
+    std::mutex decisionMutex_;
+    HintGovernor efficientGovernor_;
+    std::atomic<bool> deferredMovesCC_{false}; // the pending EFFICIENT_POWER came from requestCCState()
+    HintGovernor gfxGovernor_;
+
+    // Multi-signal containment score (--socHint fusion)
+    FusionEngine fusionEngine_;
+    double fusionPrevLoad_ = -1.0; // for the load slope signal, policy thread only
+    std::unique_ptr<ShadowPolicy> shadowPolicy_; // null unless options_.shadowPolicy
 
     // Global state for the daemon: Open (normal monitoring) or CoreContainment (consolidated)
     std::atomic<CCGlobalState> CCGlobalState_{CCGlobalState::Open};
@@ -105,7 +342,12 @@ private:
     std::atomic<bool> ccEntryDebounceActive_{false};
     std::atomic<bool> ccEntryDebounceCancelled_{false};
     std::chrono::steady_clock::time_point ccEntryDebounceStartTime_{};
-    static constexpr std::chrono::milliseconds kCCEntryDebounceMs{10000};
+    std::chrono::milliseconds ccEntryDebounceMs_{PolicyParams().ccEntryDebounce}; // see WltPredictor
+    // SysLoadMonitor::sampleCount() when the entry debounce started; the load before it is stale.
+    std::atomic<uint64_t> ccEntryLoadSampleCount_{0};
+    // Containment that does not let the parked cores sleep costs performance for nothing.
+    static constexpr std::chrono::minutes kParkedWakeHoldOff{5};
+    std::atomic<std::chrono::steady_clock::rep> ccEntryHoldOffUntil_{0}; // steady_clock ticks
 
     // Exit debounce (1s) variables
     std::atomic<bool> ccExitDebounceActive_{false};
@@ -113,9 +355,8 @@ private:
     // Exit debounce duration (mutable; default 1000ms)
     std::chrono::milliseconds ccExitDebounceMs_{1000};
 
-    // System load thresholds (tunable) to get out of CC.
-    static constexpr double kSysloadSlopeThreshold = 5.0;
-    double latestSysCpuLoadCC_{0.0};
+    // Load at CC entry; a rise above params()->sysloadSlopeThreshold gets out of CC.
+    std::atomic<double> latestSysCpuLoadCC_{0.0};
 
     // Disable copy/move to avoid accidental duplication of threads and resources
     SocDaemon(const SocDaemon&) = delete;
@@ -0,0 +1,120 @@
+// -----------------------------------------------------------------------------
+// StartupReadiness.cpp
+//
+// Component readiness and startup milestones. See StartupReadiness.h.
+// -----------------------------------------------------------------------------
+
+#include "StartupReadiness.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace {
+const char* const kMilestoneNames[StartupReadiness::kMilestoneCount] = {"hal_ready", "monitors_ready", "first_input",
+                                                                         "first_decision"};
+
+const char* stateName(StartupReadiness::State state) {
+    switch (state) {
+        case StartupReadiness::State::Ready: return "ready";
+        case StartupReadiness::State::Failed: return "failed";
+        default: return "pending";
+    }
+}
+} // namespace
+
+StartupReadiness::StartupReadiness() : startMs_(processStartMs()) {
+    for (int64_t& ms : milestoneMs_) ms = -1;
+}
+
+int64_t StartupReadiness::boottimeMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+int64_t StartupReadiness::processStartMs() {
+    char buf[1024];
+    int fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    ssize_t len = fd >= 0 ? read(fd, buf, sizeof(buf) - 1) : -1;
+    if (fd >= 0) close(fd);
+    long hz = sysconf(_SC_CLK_TCK);
+    if (len > 0 && hz > 0) {
+        buf[len] = '\0';
+        // starttime is field 22; fields resume after the last ')' of comm with state (field 3).
+        const char* p = strrchr(buf, ')');
+        if (p) ++p; // the space before field 3
+        for (int field = 3; p && field < 22; ++field) p = strchr(p + 1, ' ');
+        if (p) {
+            char* endptr = nullptr;
+            unsigned long long ticks = std::strtoull(p + 1, &endptr, 10);
+            if (endptr != p + 1) return static_cast<int64_t>(ticks * 1000 / hz);
+        }
+    }
+    READYLOGE("StartupReadiness: Process start time not available, measuring from now");
+    return boottimeMs();
+}
+
+int64_t StartupReadiness::sinceStartMs() const {
+    return boottimeMs() - startMs_;
+}
+
+int StartupReadiness::add(const std::string& component) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    components_.push_back({component, State::Pending, -1});
+    return static_cast<int>(components_.size()) - 1;
+}
+
+void StartupReadiness::set(int id, bool ready) {
+    int64_t ms = sinceStartMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id < 0 || id >= static_cast<int>(components_.size())) return;
+    Component& component = components_[id];
+    component.state = ready ? State::Ready : State::Failed;
+    component.atMs = ms;
+    READYLOGI("StartupReadiness: %s %s at %lldms", component.name.c_str(), stateName(component.state),
+              static_cast<long long>(ms));
+}
+
+void StartupReadiness::mark(Milestone milestone) {
+    int64_t ms = sinceStartMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (milestoneMs_[milestone] >= 0) return;
+    milestoneMs_[milestone] = ms;
+    READYLOGI("StartupReadiness: %s at %lldms after process start", kMilestoneNames[milestone],
+              static_cast<long long>(ms));
+}
+
+void StartupReadiness::appendText(std::string& out) const {
+    char buf[160];
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int m = 0; m < kMilestoneCount; ++m) {
+        snprintf(buf, sizeof(buf), "%s_ms=%lld\n", kMilestoneNames[m], static_cast<long long>(milestoneMs_[m]));
+        out += buf;
+    }
+    for (const Component& component : components_) {
+        snprintf(buf, sizeof(buf), "component=%s state=%s at_ms=%lld\n", component.name.c_str(),
+                 stateName(component.state), static_cast<long long>(component.atMs));
+        out += buf;
+    }
+}
+
+void StartupReadiness::appendOpenMetrics(std::string& out) const {
+    char buf[160];
+    std::lock_guard<std::mutex> lock(mutex_);
+    out += "# TYPE socdaemon_startup_milestone_seconds gauge\n";
+    for (int m = 0; m < kMilestoneCount; ++m) {
+        if (milestoneMs_[m] < 0) continue;
+        snprintf(buf, sizeof(buf), "socdaemon_startup_milestone_seconds{milestone=\"%s\"} %.3f\n", kMilestoneNames[m],
+                 milestoneMs_[m] / 1000.0);
+        out += buf;
+    }
+    out += "# TYPE socdaemon_component_ready gauge\n";
+    for (const Component& component : components_) {
+        snprintf(buf, sizeof(buf), "socdaemon_component_ready{component=\"%s\"} %d\n", component.name.c_str(),
+                 static_cast<int>(component.state));
+        out += buf;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// StartupReadiness.h
+// -----------------------------------------------------------------------------
+// Readiness of the daemon's components during startup, and the time from the
+// process start (init execs the daemon on vendor.powerhal.init=1) to each
+// startup milestone:
+//
+//   hal_ready       Power HAL Extension connected (buffered hints flushed)
+//   monitors_ready  every monitor probed, and started (sampling/polling) unless it failed
+//   first_input     first alert from any monitor
+//   first_decision  first policy decision on an input, keeping the current state included
+//
+// Components are probed concurrently; each one moves from pending to ready or
+// failed on its own. Times are measured on CLOCK_BOOTTIME from the process
+// start time in /proc/self/stat, so time spent before main() is included.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define READY_LOG_TAG "SocDaemon_Startup"
+#define READYLOGI(...) __android_log_print(ANDROID_LOG_INFO, READY_LOG_TAG, __VA_ARGS__)
+#define READYLOGE(...) __android_log_print(ANDROID_LOG_ERROR, READY_LOG_TAG, __VA_ARGS__)
+
+class StartupReadiness {
+public:
+    enum class State : int { Pending = 0, Ready = 1, Failed = -1 };
+    enum Milestone : int { kHalReady = 0, kMonitorsReady, kFirstInput, kFirstDecision, kMilestoneCount };
+
+    StartupReadiness();
+
+    // Registers a component as pending. Returns its id.
+    int add(const std::string& component);
+    void set(int id, bool ready);
+
+    // Records the first time a milestone is reached; later calls are ignored.
+    void mark(Milestone milestone);
+
+    // Milliseconds since the process started.
+    int64_t sinceStartMs() const;
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const; // samples with # TYPE
+
+private:
+    struct Component {
+        std::string name;
+        State state = State::Pending;
+        int64_t atMs = -1; // when it left Pending
+    };
+
+    static int64_t boottimeMs();
+    static int64_t processStartMs();
+
+    int64_t startMs_;
+    mutable std::mutex mutex_;
+    std::vector<Component> components_;
+    int64_t milestoneMs_[kMilestoneCount];
+};
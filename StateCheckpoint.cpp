@@ -0,0 +1,134 @@
+// -----------------------------------------------------------------------------
+// StateCheckpoint.cpp
+//
+// Persistence of policy state across daemon restarts. See StateCheckpoint.h.
+// -----------------------------------------------------------------------------
+
+#include "StateCheckpoint.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+StateCheckpoint::StateCheckpoint(const std::string& path, std::chrono::seconds maxAge)
+    : path_(path), maxAge_(maxAge), bootId_(readBootId()) {}
+
+std::string StateCheckpoint::readBootId() {
+    char buf[64] = {0};
+    int fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::string();
+    }
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return std::string();
+    }
+    buf[len] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return buf;
+}
+
+int64_t StateCheckpoint::boottimeMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool StateCheckpoint::save(const PolicyCheckpoint& state) {
+    if (!enabled()) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t nowMs = boottimeMs();
+    if (haveSaved_ && state.ccState == saved_.ccState && state.efficientMode == saved_.efficientMode &&
+        state.gfxMode == saved_.gfxMode && state.wlt == saved_.wlt) {
+        // Only the filtered load moved: written on a large drift, at most once per kEmaMinInterval.
+        bool drifted = std::fabs(state.cpuEma - saved_.cpuEma) >= kEmaDrift;
+        int64_t minIntervalMs = std::chrono::duration_cast<std::chrono::milliseconds>(kEmaMinInterval).count();
+        if (!drifted || nowMs - savedMs_ < minIntervalMs) return true;
+    }
+
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf),
+                       "version=%d\nboot_id=%s\nsaved_ms=%lld\ncpu_ema=%.3f\ncc_state=%d\n"
+                       "efficient_mode=%d\ngfx_mode=%d\nwlt=%d\n",
+                       kVersion, bootId_.c_str(), static_cast<long long>(nowMs), state.cpuEma,
+                       state.ccState, state.efficientMode, state.gfxMode, state.wlt);
+    if (len <= 0 || len >= static_cast<int>(sizeof(buf))) return false;
+
+    std::string tmpPath = path_ + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        CKPTLOGE("StateCheckpoint: Failed to open %s: %s", tmpPath.c_str(), std::strerror(errno));
+        return false;
+    }
+    bool ok = write(fd, buf, len) == len;
+    close(fd);
+    if (!ok || rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        CKPTLOGE("StateCheckpoint: Failed to write %s: %s", path_.c_str(), std::strerror(errno));
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    saved_ = state;
+    savedMs_ = nowMs;
+    haveSaved_ = true;
+    return true;
+}
+
+bool StateCheckpoint::load(PolicyCheckpoint& state_out) const {
+    if (!enabled()) return false;
+
+    FILE* f = fopen(path_.c_str(), "re");
+    if (!f) {
+        CKPTLOGI("StateCheckpoint: No checkpoint at %s, cold start", path_.c_str());
+        return false;
+    }
+
+    PolicyCheckpoint state;
+    int version = -1;
+    long long savedMs = -1;
+    std::string bootId;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char* eq = strchr(line, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        const char* key = line;
+        const char* value = eq + 1;
+        if (!strcmp(key, "version")) version = atoi(value);
+        else if (!strcmp(key, "boot_id")) bootId = value;
+        else if (!strcmp(key, "saved_ms")) savedMs = atoll(value);
+        else if (!strcmp(key, "cpu_ema")) state.cpuEma = atof(value);
+        else if (!strcmp(key, "cc_state")) state.ccState = atoi(value);
+        else if (!strcmp(key, "efficient_mode")) state.efficientMode = atoi(value);
+        else if (!strcmp(key, "gfx_mode")) state.gfxMode = atoi(value);
+        else if (!strcmp(key, "wlt")) state.wlt = atoi(value);
+    }
+    fclose(f);
+
+    if (version != kVersion) {
+        CKPTLOGI("StateCheckpoint: Discarding checkpoint with version %d", version);
+        return false;
+    }
+    if (bootId.empty() || bootId != bootId_) {
+        CKPTLOGI("StateCheckpoint: Discarding checkpoint from another boot");
+        return false;
+    }
+    int64_t ageMs = boottimeMs() - savedMs;
+    if (savedMs < 0 || ageMs < 0 || ageMs > std::chrono::duration_cast<std::chrono::milliseconds>(maxAge_).count()) {
+        CKPTLOGI("StateCheckpoint: Discarding stale checkpoint (age %lldms)", static_cast<long long>(ageMs));
+        return false;
+    }
+
+    state.ageMs = ageMs;
+    state_out = state;
+    CKPTLOGI("StateCheckpoint: Loaded checkpoint age=%lldms ema=%.2f cc=%d eff=%d gfx=%d wlt=%d",
+             static_cast<long long>(ageMs), state.cpuEma, state.ccState, state.efficientMode,
+             state.gfxMode, state.wlt);
+    return true;
+}
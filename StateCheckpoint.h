@@ -0,0 +1,67 @@
+#pragma once
+
+// StateCheckpoint.h
+// -----------------------------------------------------------------------------
+// Small key=value checkpoint of the daemon's policy state so that a restart
+// (update, crash, oneshot re-trigger) resumes where the previous instance left
+// off instead of re-learning from scratch. A checkpoint is only accepted when
+// it was written during the current boot (boot_id) and is younger than the
+// configured maximum age.
+//
+// Since a checkpoint never outlives the boot, it lives on tmpfs by default and
+// is not fsync()ed: the rename keeps it atomic, and the page cache survives
+// the daemon; only a kernel crash loses it, and that starts a new boot anyway.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#define CHECKPOINT_LOG_TAG "SocDaemon_Checkpoint"
+#define CKPTLOGI(...) __android_log_print(ANDROID_LOG_INFO, CHECKPOINT_LOG_TAG, __VA_ARGS__)
+#define CKPTLOGE(...) __android_log_print(ANDROID_LOG_ERROR, CHECKPOINT_LOG_TAG, __VA_ARGS__)
+
+inline constexpr char kDefaultStateFile[] = "/dev/socdaemon/checkpoint";
+inline constexpr std::chrono::seconds kDefaultStateMaxAge{600};
+
+struct PolicyCheckpoint {
+    double cpuEma = -1.0;  // filtered system load, -1 when unknown
+    int ccState = 0;       // SocDaemon::CCGlobalState
+    int efficientMode = 0; // last EFFICIENT_POWER value sent
+    int gfxMode = 0;       // last GFX_MODE value sent
+    int wlt = -1;          // last raw workload_type_index, -1 when unknown
+    int64_t ageMs = 0;     // filled in by load()
+};
+
+class StateCheckpoint {
+public:
+    StateCheckpoint(const std::string& path, std::chrono::seconds maxAge);
+
+    bool enabled() const { return !path_.empty(); }
+
+    // Atomically replaces the checkpoint file (write temp + rename) when
+    // the state or a hint changed, or the filtered load drifted by kEmaDrift
+    // (rate-limited). Returns true when the file is current.
+    bool save(const PolicyCheckpoint& state);
+
+    // Loads and validates version, boot id and age. Returns false if unusable.
+    bool load(PolicyCheckpoint& state_out) const;
+
+private:
+    static std::string readBootId();
+    static int64_t boottimeMs();
+
+    static constexpr int kVersion = 1;
+    static constexpr double kEmaDrift = 5.0; // load percentage points
+    static constexpr std::chrono::seconds kEmaMinInterval{60};
+
+    std::string path_;
+    std::chrono::seconds maxAge_;
+    std::string bootId_;
+    std::mutex mutex_;
+    PolicyCheckpoint saved_; // last state written
+    int64_t savedMs_ = 0;
+    bool haveSaved_ = false;
+};
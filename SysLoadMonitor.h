@@ -1,10 +1,7 @@
 #ifndef SYSLOADMONITOR_H
 #define SYSLOADMONITOR_H
 
-#include <thread>
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -14,15 +11,13 @@
 #include <chrono>
 #include <android/log.h>
 
-// Exponential-moving-average helpers (handle irregular sampling intervals)
-#include <chrono>
 #include <cmath>
 #include <mutex>
 #include <sstream>
 #include <fstream>
 
-// Default sampler interval is 3 seconds. Constructor can override per-instance.
-static constexpr std::chrono::milliseconds g_samplerIntervalDefault{3000};
+// Default sampler period is 3 base ticks (3 seconds). Constructor can override per-instance.
+static constexpr unsigned g_samplerPeriodTicksDefault = 3;
 
 
 #define SYS_MON_LOG_TAG "SocDaemon"
@@ -30,85 +25,99 @@ static constexpr std::chrono::milliseconds g_samplerIntervalDefault{3000};
 #define SYSMON_ALOGE(...) __android_log_print(ANDROID_LOG_ERROR, SYS_MON_LOG_TAG, __VA_ARGS__)
 #define SYSMON_ALOGD(...) __android_log_print(ANDROID_LOG_DEBUG, SYS_MON_LOG_TAG, __VA_ARGS__)
 
-#include "HintMonitor.h"
+#include "MonitorPipeline.h"
+#include "PeriodicMonitor.h"
 
-// SysLoadMonitor: cleaned up to assume an external thread will call monitorLoop()
-// (SoCDaemon will create the pthread; do not create or manage std::thread here)
-
-class SysLoadMonitor : public HintMonitor {
+// HighLoadEdge: the edge detector of the high-load alert, fed the smoothed load
+// and its sample time. It rises once the load has stayed above the high
+// threshold for the minimum time, and falls when the load drops below the
+// fall threshold (capped at the high one). Samples in between change nothing.
+class HighLoadEdge {
 public:
-    SysLoadMonitor(const std::string& name,
-                   std::chrono::milliseconds interval = g_samplerIntervalDefault)
-        : HintMonitor(name),
-          samplerRunning_(false),
-          samplerPaused_(false),
-          samplerInterval_(interval) {}
-
-    ~SysLoadMonitor() { stop(); }
-
-    // monitorLoop() is executed by an external thread (SoCDaemon). Do NOT spawn a thread here.
-    void monitorLoop() override;
-
-    // Initialize internal flags only; do not create a thread.
-    int init() {
-        bool expected = false;
-        if (samplerRunning_.compare_exchange_strong(expected, true)) {
-            std::lock_guard<std::mutex> lk(pauseMutex_);
-            samplerPaused_.store(true); // start in paused state
-            SYSMON_ALOGI("SysLoadMonitor: initialized (external thread expected)");
-        }
-        return 0;
+    enum class Edge { None, Rise, Fall };
+
+    Edge update(double load, std::chrono::steady_clock::time_point now, double highThreshold,
+                double fallThreshold, std::chrono::milliseconds minAbove);
+    // Re-arms the rise edge and starts a new time-above window.
+    void reset() {
+        high_ = false;
+        above_ = false;
     }
+    bool high() const { return high_; }
+    // Time spent above the high threshold as of `now`; zero if below it.
+    std::chrono::milliseconds aboveFor(std::chrono::steady_clock::time_point now) const;
 
-    // Stop sampling and wake any waiters.
-    void stop() {
-        samplerRunning_.store(false);
-        {
-            std::lock_guard<std::mutex> lk(pauseMutex_);
-            samplerPaused_.store(false);
-        }
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("SysLoadMonitor: stop requested");
-    }
+private:
+    bool high_ = false;
+    bool above_ = false;
+    std::chrono::steady_clock::time_point aboveSince_{};
+};
 
-    // Pause sampling
-    void pause() {
-        samplerPaused_.store(true);
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("SysLoadMonitor: Pause periodic CPU load checks");
-    }
+// SysLoadMonitor: sampled from the shared SamplingClock via sampleOnce().
+// The daemon constructs it paused and resumes it while the load is needed.
+//
+// The high-load alert follows HighLoadEdge, re-armed on each resume. It
+// carries (load in kLoadFixedPointScale units of a percent, high).
 
-    // Resume sampling
-    void restart() {
-        samplerPaused_.store(false);
-        pauseCv_.notify_all();
-        SYSMON_ALOGI("SysLoadMonitor: Resume periodic CPU load checks");
-    }
+class SysLoadMonitor : public PeriodicMonitor {
+public:
+    SysLoadMonitor(const std::string& name,
+                   unsigned periodTicks = g_samplerPeriodTicksDefault)
+        : PeriodicMonitor(name, periodTicks) {}
+
+    // SamplingClock interface; period and pause() / resume() come from PeriodicMonitor.
+    void sampleOnce() override;
 
-    // Accessors
-    double getSysCpuLoad();
-    double getSysCpuLoadOld();
+    // Smoothed load of the last sample, or -1 before the first one. Safe from any thread.
     double getLatestSysCpuLoad() const;
-    std::vector<double> getEachCpuLoad();
-    double getSysCpuLoadDetails();
+    // Number of samples that updated the smoothed load. A caller that needs a load
+    // taken after some point compares this with the count it saw at that point.
+    uint64_t sampleCount() const { return sampleCount_.load(); }
+    // Seed the EMA with a previously filtered value (warm start from a checkpoint).
+    void seedSysCpuLoad(double emaPercent);
+    // High-load alert band (%) and minimum time above, tunable at runtime (PolicyParams).
+    void setHighThreshold(double percent) { highThreshold_ = percent; }
+    void setFallThreshold(double percent) { fallThreshold_ = percent; }
+    void setMinTimeAbove(std::chrono::milliseconds minAbove) { minAboveMs_ = minAbove.count(); }
+
+    // Alert payloads carry the load as an integer in 1/kLoadFixedPointScale of a percent.
+    static constexpr int kLoadFixedPointScale = 100;
+    static int toFixedPoint(double percent) { return static_cast<int>(std::lround(percent * kLoadFixedPointScale)); }
+    static double fromFixedPoint(int value) { return static_cast<double>(value) / kLoadFixedPointScale; }
+
+protected:
+    // Takes the /proc/stat baseline, so the first tick after a resume yields a load.
+    void onResumed() override;
 
 private:
+    // Reads /proc/stat and feeds the EMA. Returns the new smoothed load, or -1 if
+    // this read produced no interval (a failed read, or the baseline).
+    double readSysCpuLoad();
+
     struct SystemLoadSample {
         unsigned long long totalTime = 0;
         unsigned long long idleTime  = 0;
     };
 
-    // Control flags (no internal std::thread anymore)
-    std::atomic<bool> samplerRunning_;
-    std::atomic<bool> samplerPaused_;
-    mutable std::mutex pauseMutex_;
-    std::condition_variable pauseCv_;
-
-    // Recent samples
+    // Recent samples; the sampling thread and onResumed() both read /proc/stat.
+    std::mutex sampleMutex_;
     SystemLoadSample lastSample_;
     SystemLoadSample currentSample_;
-    std::chrono::milliseconds samplerInterval_;
+    bool haveSample_ = false;
+
+    // Smoothed load; read from the daemon threads, hence the lock.
+    static constexpr double kCpuEmaTimeConstantSec = 1.5; // larger => slower smoothing
+    mutable std::mutex emaMutex_;
+    pipeline::EmaFilter cpuEma_{kCpuEmaTimeConstantSec};
+    std::atomic<uint64_t> sampleCount_{0};
 
     static constexpr double kSysloadHighThreshold = 25.0;
+    static constexpr double kSysloadFallThreshold = 20.0;
+    static constexpr long long kSysloadMinAboveMs = 2000;
+    std::atomic<double> highThreshold_{kSysloadHighThreshold};
+    std::atomic<double> fallThreshold_{kSysloadFallThreshold};
+    std::atomic<long long> minAboveMs_{kSysloadMinAboveMs};
+
+    HighLoadEdge edge_; // sampling thread only
 };
 #endif // SYSLOADMONITOR_H
\ No newline at end of file
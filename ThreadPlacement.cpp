@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+// ThreadPlacement.cpp
+//
+// CPU affinity, scheduling class and cgroup placement for socdaemon threads.
+// -----------------------------------------------------------------------------
+
+#include "ThreadPlacement.h"
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool writeFile(const std::string& path, const std::string& value) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t written = write(fd, value.c_str(), value.size());
+    int savedErrno = errno;
+    close(fd);
+    errno = savedErrno;
+    return written == static_cast<ssize_t>(value.size());
+}
+
+} // namespace
+
+ThreadPlacement::ThreadPlacement(const PlacementConfig& config) : config_(config) {
+    CPU_ZERO(&cpuSet_);
+    if (!config_.cpus.empty()) {
+        haveCpuSet_ = parseCpuList(config_.cpus, &cpuSet_);
+        if (!haveCpuSet_) {
+            PLACELOGE("ThreadPlacement: Invalid CPU list '%s', affinity left unchanged", config_.cpus.c_str());
+        }
+    }
+}
+
+bool ThreadPlacement::parseCpuList(const std::string& list, cpu_set_t* set) {
+    CPU_ZERO(set);
+    const char* p = list.c_str();
+    bool any = false;
+    while (*p) {
+        char* end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) return false;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            ++p;
+            last = std::strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE) return false;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, set);
+        }
+        any = true;
+        if (*p == ',') {
+            ++p;
+        } else if (*p != '\0' && *p != '\n') {
+            return false;
+        } else {
+            break;
+        }
+    }
+    return any;
+}
+
+void ThreadPlacement::pinCurrentThread(const char* role) const {
+    if (!haveCpuSet_) return;
+    if (sched_setaffinity(0, sizeof(cpuSet_), &cpuSet_) != 0) {
+        PLACELOGE("ThreadPlacement: %s tid=%d sched_setaffinity(%s) failed: %s",
+                  role, gettid(), config_.cpus.c_str(), std::strerror(errno));
+    }
+}
+
+void ThreadPlacement::setNice(int nice, const char* role) const {
+    // On Linux PRIO_PROCESS with a tid applies to that thread only.
+    if (setpriority(PRIO_PROCESS, gettid(), nice) != 0) {
+        PLACELOGE("ThreadPlacement: %s tid=%d setpriority(%d) failed: %s",
+                  role, gettid(), nice, std::strerror(errno));
+    }
+}
+
+void ThreadPlacement::applySampler() const {
+    pinCurrentThread("sampler");
+    if (config_.samplerIdle) {
+        struct sched_param param = {};
+        param.sched_priority = 0;
+        if (sched_setscheduler(0, SCHED_IDLE, &param) == 0) {
+            PLACELOGI("ThreadPlacement: sampler tid=%d cpus=%s SCHED_IDLE", gettid(), config_.cpus.c_str());
+            return;
+        }
+        PLACELOGE("ThreadPlacement: SCHED_IDLE failed (%s), using nice %d", std::strerror(errno), config_.samplerNice);
+    }
+    setNice(config_.samplerNice, "sampler");
+    PLACELOGI("ThreadPlacement: sampler tid=%d cpus=%s nice=%d", gettid(), config_.cpus.c_str(), config_.samplerNice);
+}
+
+void ThreadPlacement::applyPolicy() const {
+    pinCurrentThread("policy");
+    setNice(config_.policyNice, "policy");
+    PLACELOGI("ThreadPlacement: policy tid=%d cpus=%s nice=%d", gettid(), config_.cpus.c_str(), config_.policyNice);
+}
+
+int ThreadPlacement::joinCgroup() const {
+    if (config_.cgroupPath.empty()) return 0;
+
+    if (mkdir(config_.cgroupPath.c_str(), 0750) != 0 && errno != EEXIST) {
+        PLACELOGE("ThreadPlacement: mkdir %s failed: %s", config_.cgroupPath.c_str(), std::strerror(errno));
+        return -1;
+    }
+
+    // Only the cgroup v2 cpu controller is supported, as for the cgroup accounting.
+    if (!config_.cpuMax.empty() && !writeFile(config_.cgroupPath + "/cpu.max", config_.cpuMax + "\n")) {
+        PLACELOGE("ThreadPlacement: Failed to write cpu.max '%s' in %s (--cpu-max needs cgroup v2): %s",
+                  config_.cpuMax.c_str(), config_.cgroupPath.c_str(), std::strerror(errno));
+    }
+
+    if (!writeFile(config_.cgroupPath + "/cgroup.procs", std::to_string(getpid()) + "\n")) {
+        PLACELOGE("ThreadPlacement: Failed to join %s: %s", config_.cgroupPath.c_str(), std::strerror(errno));
+        return -1;
+    }
+    PLACELOGI("ThreadPlacement: Joined cgroup %s (cpu.max '%s')", config_.cgroupPath.c_str(), config_.cpuMax.c_str());
+    return 0;
+}
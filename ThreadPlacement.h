@@ -0,0 +1,58 @@
+#pragma once
+
+// ThreadPlacement.h
+// -----------------------------------------------------------------------------
+// Placement of the daemon's own threads so that socdaemon is never the reason
+// a parked core wakes up:
+//   - every thread is pinned to the containment cpuset (e.g. "4-7"),
+//   - sampler threads run at SCHED_IDLE (or a low-priority nice value); what
+//     they detect is acted on by the policy thread (PolicyQueue),
+//   - event/policy threads get a latency-friendly nice value,
+//   - optionally the whole process joins a dedicated cgroup with a CPU cap.
+// Each apply*() call affects the calling thread only; threads created afterwards
+// inherit the caller's affinity and nice value. socdaemon is a binder client
+// only and never starts a binder thread pool: HAL transactions run on the
+// (already placed) calling thread.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <sched.h>
+#include <string>
+
+#define PLACEMENT_LOG_TAG "SocDaemon_Placement"
+#define PLACELOGI(...) __android_log_print(ANDROID_LOG_INFO, PLACEMENT_LOG_TAG, __VA_ARGS__)
+#define PLACELOGE(...) __android_log_print(ANDROID_LOG_ERROR, PLACEMENT_LOG_TAG, __VA_ARGS__)
+
+struct PlacementConfig {
+    std::string cpus;          // CPU list for all daemon threads, e.g. "4-7". Empty: leave affinity alone.
+    bool samplerIdle = true;   // SCHED_IDLE for samplers; otherwise samplerNice is used.
+    int samplerNice = 10;
+    int policyNice = -4;       // nice for event/policy threads (SCHED_OTHER)
+    std::string cgroupPath;    // Dedicated cgroup directory. Empty: do not move the process.
+    std::string cpuMax;        // "<quota_us> <period_us>" written to cpu.max (cgroup v2 only)
+};
+
+class ThreadPlacement {
+public:
+    explicit ThreadPlacement(const PlacementConfig& config);
+
+    // Pin + SCHED_IDLE/low nice. For the SamplingClock thread, which only samples and hands off.
+    void applySampler() const;
+    // Pin + latency-friendly nice. For event monitors and the debounce/policy thread.
+    void applyPolicy() const;
+    // Move the whole process into the configured cgroup and apply cpu.max.
+    int joinCgroup() const;
+
+    const PlacementConfig& config() const { return config_; }
+
+    // Parses a kernel CPU list ("0-3,6") into a cpu_set_t. Returns false on syntax errors.
+    static bool parseCpuList(const std::string& list, cpu_set_t* set);
+
+private:
+    void pinCurrentThread(const char* role) const;
+    void setNice(int nice, const char* role) const;
+
+    PlacementConfig config_;
+    cpu_set_t cpuSet_;
+    bool haveCpuSet_ = false;
+};
@@ -0,0 +1,242 @@
+// -----------------------------------------------------------------------------
+// TuningLadder.cpp
+//
+// Workload-class settings bundles delivered through Power HAL modes or direct
+// node writes. See TuningLadder.h.
+// -----------------------------------------------------------------------------
+
+#include "TuningLadder.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+const TuningLadder::Bundle TuningLadder::kBundles[kRungCount] = {
+    //                EPP                    uclamp   profile        slider balance/offset
+    {"TUNE_IDLE",    {"balance-power",       "0",     "low-power",   nullptr, nullptr}},
+    {"TUNE_BTL",     {"balance-power",       "0",     nullptr,       nullptr, nullptr}},
+    {"TUNE_SUSTAIN", {"balance-performance", nullptr, nullptr,       nullptr, nullptr}},
+    {"TUNE_BURSTY",  {"performance",         "65",    "performance", "1",     "0"}},
+};
+
+const char* const TuningLadder::kNodePaths[kNodeCount] = {
+    "/sys/devices/system/cpu/cpufreq",
+    "/dev/cpuctl/top-app/cpu.uclamp.min",
+    "/sys/class/platform-profile/platform-profile-0/profile",
+    "/sys/module/processor_thermal_soc_slider/parameters/slider_balance",
+    "/sys/module/processor_thermal_soc_slider/parameters/slider_offset",
+};
+
+const char* const TuningLadder::kNodeNames[kNodeCount] = {
+    "epp", "uclamp_min", "platform_profile", "slider_balance", "slider_offset",
+};
+
+bool TuneConfig::parseBackend(const std::string& text, TuneConfig& config) {
+    if (text == "hint") {
+        config.backend = TuneBackend::Hint;
+    } else if (text == "direct") {
+        config.backend = TuneBackend::Direct;
+    } else if (text == "none") {
+        config.backend = TuneBackend::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* TuneConfig::backendName(TuneBackend backend) {
+    switch (backend) {
+        case TuneBackend::Hint: return "hint";
+        case TuneBackend::Direct: return "direct";
+        default: return "none";
+    }
+}
+
+const char* TuningLadder::rungName(int rung) {
+    static const char* const kNames[kRungCount] = {"Idle", "Btl", "Sustain", "Bursty"};
+    return rung >= 0 && rung < kRungCount ? kNames[rung] : "none";
+}
+
+TuningLadder::TuningLadder(const TuneConfig& config, HintSender sender)
+    : config_(config), sender_(std::move(sender)) {}
+
+TuningLadder::~TuningLadder() {
+    for (DirectNode& node : nodes_) {
+        for (int fd : node.fds) close(fd);
+    }
+}
+
+int TuningLadder::init() {
+    if (config_.backend != TuneBackend::Direct) return 0;
+
+    auto openNode = [](const std::string& path, DirectNode& node) {
+        int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) return;
+        if (node.fds.empty()) {
+            char buf[64] = {};
+            ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+            if (len > 0) {
+                node.resting.assign(buf, len);
+                while (!node.resting.empty() && (node.resting.back() == '\n' || node.resting.back() == ' ')) {
+                    node.resting.pop_back();
+                }
+            }
+        }
+        node.fds.push_back(fd);
+    };
+
+    // EPP is per cpufreq policy; the HAL's EPP node is a property handled on its side.
+    if (DIR* dir = opendir(kNodePaths[kEpp])) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "policy", 6) != 0) continue;
+            openNode(std::string(kNodePaths[kEpp]) + "/" + entry->d_name + "/energy_performance_preference",
+                     nodes_[kEpp]);
+        }
+        closedir(dir);
+    }
+    for (int n = kUclamp; n < kNodeCount; ++n) openNode(kNodePaths[n], nodes_[n]);
+
+    int present = 0;
+    for (int n = 0; n < kNodeCount; ++n) {
+        if (nodes_[n].fds.empty()) {
+            TUNELOGE("TuningLadder: %s not available, skipped", kNodeNames[n]);
+            continue;
+        }
+        present++;
+        TUNELOGI("TuningLadder: %s resting value '%s' (%zu node(s))", kNodeNames[n], nodes_[n].resting.c_str(),
+                 nodes_[n].fds.size());
+    }
+    return present > 0 ? 0 : -1;
+}
+
+bool TuningLadder::writeNode(int fd, const std::string& value) {
+    return pwrite(fd, value.c_str(), value.size(), 0) == static_cast<ssize_t>(value.size());
+}
+
+bool TuningLadder::applyHint(int from, int rung) {
+    if (!sender_) return false;
+    bool ok = sender_(kBundles[rung].mode, true);
+    for (int r = 0; r < kRungCount; ++r) {
+        // Unknown previous rung: clear whatever the last instance left enabled.
+        if (r != rung && (from < 0 || r == from)) ok = sender_(kBundles[r].mode, false) && ok;
+    }
+    return ok;
+}
+
+bool TuningLadder::applyDirect(int rung) {
+    bool ok = true;
+    for (int n = 0; n < kNodeCount; ++n) {
+        DirectNode& node = nodes_[n];
+        if (node.fds.empty()) continue;
+        const char* value = kBundles[rung].values[n];
+        std::string target = value ? std::string(value) : node.resting;
+        if (target.empty()) continue;
+        for (int fd : node.fds) {
+            if (!writeNode(fd, target)) {
+                TUNELOGE("TuningLadder: Write of '%s' to %s failed: %s", target.c_str(), kNodeNames[n],
+                         strerror(errno));
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+void TuningLadder::apply(int rung, const char* reason) {
+    int from = current(); // stable: only holders of applyMutex_ change it
+    bool ok = config_.backend == TuneBackend::Hint ? applyHint(from, rung) : applyDirect(rung);
+    TUNELOGI("TuningLadder: %s -> %s due to %s%s", rungName(from), rungName(rung), reason,
+             ok ? "" : " (partially failed)");
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) failures_++;
+    transitions_++;
+    current_ = rung;
+    pending_ = -1;
+    residency_.transition(rung);
+}
+
+void TuningLadder::request(int rung, const char* reason) {
+    if (rung < 0 || rung >= kRungCount || config_.backend == TuneBackend::None) return;
+    std::lock_guard<std::mutex> applyLock(applyMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rung == current_) {
+            if (pending_ >= 0) suppressedDowngrades_++;
+            pending_ = -1;
+            return;
+        }
+        if (current_ >= 0 && rung < current_) {
+            // Downgrade: restart the hold only when the target changes.
+            if (rung != pending_) {
+                pending_ = rung;
+                pendingSince_ = std::chrono::steady_clock::now();
+                pendingReason_ = reason;
+            }
+            return;
+        }
+    }
+    apply(rung, reason);
+}
+
+void TuningLadder::applyDue() {
+    std::lock_guard<std::mutex> applyLock(applyMutex_);
+    int rung;
+    const char* reason;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_ < 0 || std::chrono::steady_clock::now() - pendingSince_ < config_.downgradeHold) return;
+        rung = pending_;
+        reason = pendingReason_;
+    }
+    apply(rung, reason);
+}
+
+bool TuningLadder::hasPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_ >= 0;
+}
+
+int TuningLadder::current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+}
+
+void TuningLadder::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "backend=%s\nrung=%s\npending=%s\ndowngrade_hold_ms=%lld\ntransitions=%" PRIu64 "\nfailures=%" PRIu64
+             "\nsuppressed_downgrades=%" PRIu64 "\n",
+             TuneConfig::backendName(config_.backend), rungName(current_), rungName(pending_),
+             static_cast<long long>(config_.downgradeHold.count()), transitions_, failures_, suppressedDowngrades_);
+    out += buf;
+    for (int r = 0; r < kRungCount; ++r) {
+        out += std::string(rungName(r)) + " mode=" + kBundles[r].mode;
+        for (int n = 0; n < kNodeCount; ++n) {
+            const char* value = kBundles[r].values[n];
+            out += std::string(" ") + kNodeNames[n] + "=" + (value ? value : "-");
+        }
+        out += "\n";
+    }
+    if (config_.backend == TuneBackend::Direct) {
+        for (int n = 0; n < kNodeCount; ++n) {
+            snprintf(buf, sizeof(buf), "node %s count=%zu resting=%s\n", kNodeNames[n], nodes_[n].fds.size(),
+                     nodes_[n].resting.empty() ? "-" : nodes_[n].resting.c_str());
+            out += buf;
+        }
+    }
+}
+
+void TuningLadder::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "# TYPE socdaemon_tune_rung gauge\nsocdaemon_tune_rung %d\n"
+             "# TYPE socdaemon_tune_transitions counter\nsocdaemon_tune_transitions_total %" PRIu64 "\n"
+             "# TYPE socdaemon_tune_failures counter\nsocdaemon_tune_failures_total %" PRIu64 "\n",
+             current_, transitions_, failures_);
+    out += buf;
+}
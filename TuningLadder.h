@@ -0,0 +1,124 @@
+#pragma once
+
+// TuningLadder.h
+// -----------------------------------------------------------------------------
+// Per-workload-class platform tuning. Each rung (the WLT classes Idle, Btl,
+// Sustain, Bursty, as capped by the daemon's containment and thermal state)
+// maps to one bundle of EPP, top-app uclamp.min, platform profile and SoC
+// slider settings:
+//
+//   Idle     balance-power        uclamp 0   low-power
+//   Btl      balance-power        uclamp 0
+//   Sustain  balance-performance
+//   Bursty   performance          uclamp 65  performance  slider 1/0
+//
+// (blank: the resting value). Two backends deliver a bundle:
+//   - Hint:   one Power HAL mode per rung (TUNE_IDLE ... TUNE_BURSTY, actions
+//             in powerhint_*.json); the new mode is enabled before the old one
+//             is disabled so the nodes never fall back to their defaults. The
+//             first rung disables every other mode, which a previous instance
+//             may have left enabled.
+//   - Direct: the daemon writes the sysfs/cgroup nodes itself (cpufreq EPP of
+//             every policy instead of the HAL's EPP property). Values read at
+//             init() are the resting values; missing nodes are skipped.
+//
+// Moving up the ladder is applied at once; moving down only after the lower
+// rung was requested for downgradeHold, so a short WLT dip does not drop the
+// performance settings of a bursty workload.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ResidencyTracker.h"
+
+#define TUNE_LOG_TAG "SocDaemon_TuningLadder"
+#define TUNELOGI(...) __android_log_print(ANDROID_LOG_INFO, TUNE_LOG_TAG, __VA_ARGS__)
+#define TUNELOGE(...) __android_log_print(ANDROID_LOG_ERROR, TUNE_LOG_TAG, __VA_ARGS__)
+
+enum class TuneBackend { None, Hint, Direct };
+
+struct TuneConfig {
+    TuneBackend backend = TuneBackend::None;
+    std::chrono::milliseconds downgradeHold{2000};
+
+    // "hint", "direct" or "none". Returns false on anything else.
+    static bool parseBackend(const std::string& text, TuneConfig& config);
+    static const char* backendName(TuneBackend backend);
+};
+
+class TuningLadder {
+public:
+    enum Rung : int { kIdle = 0, kBtl, kSustain, kBursty, kRungCount };
+
+    // Hint backend: IPowerExt::setMode(mode, enable).
+    using HintSender = std::function<bool(const std::string& mode, bool enable)>;
+
+    TuningLadder(const TuneConfig& config, HintSender sender);
+    ~TuningLadder();
+
+    TuningLadder(const TuningLadder&) = delete;
+    TuningLadder& operator=(const TuningLadder&) = delete;
+
+    // Direct backend: opens the nodes and records their resting values.
+    // Returns -1 if none of them exists.
+    int init();
+
+    // Target rung for the current workload. Upgrades are applied immediately,
+    // downgrades once held for downgradeHold (see applyDue()).
+    void request(int rung, const char* reason);
+    // Apply a downgrade whose hold has expired (sampling clock, while hasPending()).
+    void applyDue();
+    bool hasPending() const;
+
+    int current() const;
+    ResidencyTracker& residency() { return residency_; }
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const; // samples with # TYPE
+
+    static const char* rungName(int rung);
+
+private:
+    enum Node : int { kEpp = 0, kUclamp, kProfile, kSliderBalance, kSliderOffset, kNodeCount };
+
+    struct Bundle {
+        const char* mode;                // Power HAL mode of the hint backend
+        const char* values[kNodeCount];  // nullptr: resting value
+    };
+    static const Bundle kBundles[kRungCount];
+    static const char* const kNodePaths[kNodeCount]; // kEpp: per cpufreq policy, see init()
+    static const char* const kNodeNames[kNodeCount];
+
+    struct DirectNode {
+        std::vector<int> fds;
+        std::string resting;
+    };
+
+    // Caller holds applyMutex_ (not mutex_: the HAL call may block).
+    void apply(int rung, const char* reason);
+    bool applyHint(int from, int rung);
+    bool applyDirect(int rung);
+    static bool writeNode(int fd, const std::string& value);
+
+    TuneConfig config_;
+    HintSender sender_;
+    DirectNode nodes_[kNodeCount];
+
+    std::mutex applyMutex_; // serializes transitions; readers only take mutex_
+    mutable std::mutex mutex_;
+    int current_ = -1;
+    int pending_ = -1;
+    std::chrono::steady_clock::time_point pendingSince_{};
+    const char* pendingReason_ = ""; // reasons are string literals
+    uint64_t transitions_ = 0;
+    uint64_t failures_ = 0;
+    uint64_t suppressedDowngrades_ = 0; // reverted before the hold expired
+
+    ResidencyTracker residency_{"tune_rung", {"Idle", "Btl", "Sustain", "Bursty"}};
+};
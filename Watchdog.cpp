@@ -0,0 +1,287 @@
+// -----------------------------------------------------------------------------
+// Watchdog.cpp
+//
+// Heartbeat and deadline stall detection. See Watchdog.h.
+// -----------------------------------------------------------------------------
+
+#include "Watchdog.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+const char* kindName(Watchdog::Kind kind) {
+    return kind == Watchdog::Kind::Heartbeat ? "heartbeat" : "deadline";
+}
+} // namespace
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+int64_t Watchdog::nowNs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void Watchdog::setAlertCallback(AlertCallback cb) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    alertCallback_ = std::move(cb);
+}
+
+int Watchdog::addHeartbeat(const std::string& name, std::chrono::milliseconds period,
+                           std::function<bool()> isActive) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Channel& channel = channels_.emplace_back();
+    channel.name = name;
+    channel.kind = Kind::Heartbeat;
+    channel.expected = period;
+    channel.isActive = std::move(isActive);
+    channel.lastBeatNs = nowNs();
+    if (period.count() > 0) {
+        WDOGLOGI("Watchdog: Heartbeat '%s' every %lldms", name.c_str(), static_cast<long long>(period.count()));
+    } else {
+        WDOGLOGI("Watchdog: Thread exit of '%s'", name.c_str());
+    }
+    return static_cast<int>(channels_.size() - 1);
+}
+
+int Watchdog::addDeadline(const std::string& name, std::chrono::milliseconds deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Channel& channel = channels_.emplace_back();
+    channel.name = name;
+    channel.kind = Kind::Deadline;
+    channel.expected = deadline;
+    WDOGLOGI("Watchdog: Deadline '%s' of %lldms", name.c_str(), static_cast<long long>(deadline.count()));
+    return static_cast<int>(channels_.size() - 1);
+}
+
+void Watchdog::beat(int id) {
+    Channel& channel = channels_[id];
+    int64_t now = nowNs();
+    channel.lastBeatNs.store(now, std::memory_order_relaxed);
+    bool timed = channel.wasActive.load(std::memory_order_relaxed);
+    if (timed && !channel.stalled.load(std::memory_order_relaxed)) return;
+
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (channel.stalled && !channel.exited) leaveStall(channel, now, alerts);
+        replan_ = replan_ || !timed;
+    }
+    if (!timed) cv_.notify_one();
+    deliver(alerts);
+}
+
+void Watchdog::exited(int id) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Channel& channel = channels_[id];
+        channel.exited = true;
+        if (!channel.stalled) enterStall(channel, channel.lastBeatNs.load(), nowNs(), alerts);
+    }
+    deliver(alerts);
+}
+
+void Watchdog::lost(int id) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Channel& channel = channels_[id];
+        if (!channel.stalled && !channel.exited) {
+            channel.lost = true;
+            int64_t now = nowNs();
+            enterStall(channel, now, now, alerts);
+        }
+    }
+    deliver(alerts);
+}
+
+Watchdog::Call::Call(Watchdog& watchdog, int id) : watchdog_(watchdog), id_(id), startNs_(nowNs()) {
+    {
+        std::lock_guard<std::mutex> lock(watchdog_.mutex_);
+        Channel& channel = watchdog_.channels_[id_];
+        if (channel.inFlight++ > 0) return;
+        channel.callStartNs = startNs_;
+        watchdog_.replan_ = true;
+    }
+    watchdog_.cv_.notify_one();
+}
+
+Watchdog::Call::~Call() {
+    watchdog_.endCall(id_, startNs_);
+}
+
+void Watchdog::endCall(int id, int64_t startNs) {
+    std::vector<Alert> alerts;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Channel& channel = channels_[id];
+        int64_t now = nowNs();
+        if (--channel.inFlight > 0) {
+            // Concurrent calls: keep timing the ones still in flight from this call's end.
+            channel.callStartNs = now;
+        }
+        int64_t deadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(channel.expected).count();
+        if (!channel.stalled && now - startNs > deadlineNs) {
+            // Overran and returned between two checks.
+            enterStall(channel, startNs, now, alerts);
+        }
+        if (channel.stalled && channel.inFlight == 0) leaveStall(channel, now, alerts);
+    }
+    deliver(alerts);
+}
+
+void Watchdog::enterStall(Channel& channel, int64_t sinceNs, int64_t now, std::vector<Alert>& alerts) {
+    channel.stalled = true;
+    channel.stallStartNs = sinceNs;
+    channel.stalls++;
+    alerts.push_back({channel.name, channel.kind, false, channel.exited, channel.lost, channel.expected,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(now - sinceNs))});
+}
+
+void Watchdog::leaveStall(Channel& channel, int64_t now, std::vector<Alert>& alerts) {
+    int64_t duration = now - channel.stallStartNs;
+    channel.stalled = false;
+    channel.lost = false;
+    channel.stalledNsTotal += duration;
+    channel.longestStallNs = std::max(channel.longestStallNs, duration);
+    alerts.push_back({channel.name, channel.kind, true, false, false, channel.expected,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(duration))});
+}
+
+void Watchdog::deliver(const std::vector<Alert>& alerts) {
+    if (alerts.empty()) return;
+    AlertCallback cb;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cb = alertCallback_;
+    }
+    for (const Alert& alert : alerts) {
+        if (alert.recovered) {
+            WDOGLOGI("Watchdog: %s '%s' recovered after %lldms", kindName(alert.kind), alert.channel.c_str(),
+                     static_cast<long long>(alert.stalled.count()));
+        } else {
+            WDOGLOGE("Watchdog: %s '%s' %s: %lldms (expected %lldms)", kindName(alert.kind), alert.channel.c_str(),
+                     alert.exited ? "thread exited" : alert.lost ? "source lost" : "stalled", static_cast<long long>(alert.stalled.count()),
+                     static_cast<long long>(alert.expected.count()));
+        }
+        if (cb) cb(alert);
+    }
+}
+
+int64_t Watchdog::check() {
+    std::vector<Alert> alerts;
+    int64_t next = INT64_MAX;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replan_ = false;
+        int64_t now = nowNs();
+        for (Channel& channel : channels_) {
+            int64_t expectedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(channel.expected).count();
+            if (channel.kind == Kind::Deadline) {
+                if (!channel.stalled && channel.inFlight > 0 && now - channel.callStartNs > expectedNs) {
+                    enterStall(channel, channel.callStartNs, now, alerts);
+                }
+                if (!channel.stalled && channel.inFlight > 0) {
+                    next = std::min(next, channel.callStartNs + expectedNs + 1);
+                }
+                continue;
+            }
+
+            // Exit-only channels are reported by exited(); nothing to time.
+            if (channel.exited || expectedNs == 0) continue;
+            bool active = !channel.isActive || channel.isActive();
+            if (!active) {
+                // Paused: no beat is expected, so a pending stall is over.
+                channel.wasActive = false;
+                if (channel.stalled) leaveStall(channel, now, alerts);
+                continue;
+            }
+            if (!channel.wasActive) {
+                channel.wasActive = true;
+                channel.activeSinceNs = now;
+            }
+            int64_t last = std::max(channel.lastBeatNs.load(), channel.activeSinceNs);
+            if (!channel.stalled && now - last > kStallFactor * expectedNs) {
+                enterStall(channel, last, now, alerts);
+            }
+            // A stalled channel recovers on its next beat; look again one stall period later
+            // in case it was paused meanwhile.
+            next = std::min(next, (channel.stalled ? now : last + 1) + kStallFactor * expectedNs);
+        }
+    }
+    deliver(alerts);
+    return next;
+}
+
+void Watchdog::run() {
+    WDOGLOGI("Watchdog: Started, %zu channel(s)", channels_.size());
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!shouldExit_) {
+        lock.unlock();
+        int64_t next = check();
+        lock.lock();
+        auto wake = [this] { return shouldExit_ || replan_; };
+        if (next == INT64_MAX) {
+            cv_.wait(lock, wake);
+        } else {
+            cv_.wait_for(lock, std::chrono::nanoseconds(next - nowNs()), wake);
+        }
+    }
+    WDOGLOGI("Watchdog: Thread exiting");
+}
+
+void Watchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shouldExit_ = true;
+    }
+    cv_.notify_all();
+}
+
+void Watchdog::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowNs();
+    char buf[256];
+    for (const Channel& channel : channels_) {
+        int64_t current = channel.stalled ? now - channel.stallStartNs : 0;
+        snprintf(buf, sizeof(buf),
+                 "%s kind=%s expected_ms=%lld state=%s stalls=%" PRIu64 " stalled_ms=%lld longest_ms=%lld"
+                 " current_ms=%lld\n",
+                 channel.name.c_str(), kindName(channel.kind), static_cast<long long>(channel.expected.count()),
+                 channel.exited ? "exited" : channel.lost ? "lost" : channel.stalled ? "stalled" : "ok", channel.stalls,
+                 static_cast<long long>((channel.stalledNsTotal + current) / 1000000),
+                 static_cast<long long>(std::max(channel.longestStallNs, current) / 1000000),
+                 static_cast<long long>(current / 1000000));
+        out += buf;
+    }
+}
+
+void Watchdog::appendOpenMetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = nowNs();
+    char buf[256];
+    out += "# TYPE socdaemon_watchdog_stalls counter\n";
+    for (const Channel& channel : channels_) {
+        snprintf(buf, sizeof(buf), "socdaemon_watchdog_stalls_total{channel=\"%s\",kind=\"%s\"} %" PRIu64 "\n",
+                 channel.name.c_str(), kindName(channel.kind), channel.stalls);
+        out += buf;
+    }
+    out += "# TYPE socdaemon_watchdog_stall_seconds counter\n";
+    for (const Channel& channel : channels_) {
+        int64_t current = channel.stalled ? now - channel.stallStartNs : 0;
+        snprintf(buf, sizeof(buf), "socdaemon_watchdog_stall_seconds_total{channel=\"%s\",kind=\"%s\"} %.3f\n",
+                 channel.name.c_str(), kindName(channel.kind), (channel.stalledNsTotal + current) / 1e9);
+        out += buf;
+    }
+    out += "# TYPE socdaemon_watchdog_stalled gauge\n";
+    for (const Channel& channel : channels_) {
+        snprintf(buf, sizeof(buf), "socdaemon_watchdog_stalled{channel=\"%s\",kind=\"%s\"} %d\n",
+                 channel.name.c_str(), kindName(channel.kind), channel.stalled ? 1 : 0);
+        out += buf;
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+// Watchdog.h
+// -----------------------------------------------------------------------------
+// Stall detection for the daemon's own threads and blocking calls.
+//
+// Two kinds of channels:
+//   - Heartbeat: a source that is expected to beat() at least every `period`
+//     while active (a periodic monitor sampled by the SamplingClock). It
+//     stalls when no beat was seen for kStallFactor periods, or at once when
+//     its thread exits. A period of 0 registers an event loop that may block
+//     forever on its descriptor: only the exit of its thread is a stall.
+//     Either kind stalls at once when its source is reported lost(), and
+//     recovers on the next beat().
+//   - Deadline: a blocking call (HAL setMode) bracketed by a Call guard. It
+//     stalls when a call is still in flight past its deadline, and is counted
+//     even when the overrun is shorter than one watchdog check.
+//
+// The watchdog thread sleeps until the earliest heartbeat or call deadline;
+// with nothing active it sleeps until a call starts or a paused source beats
+// again. A stall and its recovery are each reported once through the alert
+// callback, with the channel, kind and durations; per-channel stall counts and
+// stalled time are kept for the control socket.
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define WATCHDOG_LOG_TAG "SocDaemon_Watchdog"
+#define WDOGLOGI(...) __android_log_print(ANDROID_LOG_INFO, WATCHDOG_LOG_TAG, __VA_ARGS__)
+#define WDOGLOGE(...) __android_log_print(ANDROID_LOG_ERROR, WATCHDOG_LOG_TAG, __VA_ARGS__)
+
+inline constexpr std::chrono::milliseconds kDefaultHalDeadline{500};
+
+class Watchdog {
+public:
+    enum class Kind { Heartbeat, Deadline };
+
+    struct Alert {
+        std::string channel;
+        Kind kind;
+        bool recovered;                 // false: stall detected, true: stall ended
+        bool exited;                    // the heartbeat's thread returned
+        bool lost;                      // the heartbeat's source was reported lost
+        std::chrono::milliseconds expected; // period or deadline
+        std::chrono::milliseconds stalled;  // time since the last beat / call start
+    };
+    using AlertCallback = std::function<void(const Alert& alert)>;
+
+    Watchdog() = default;
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    void setAlertCallback(AlertCallback cb);
+
+    // Registration (before run()). `isActive` may be empty (always expected to beat);
+    // `period` 0 only watches for the thread's exit.
+    int addHeartbeat(const std::string& name, std::chrono::milliseconds period,
+                     std::function<bool()> isActive = nullptr);
+    int addDeadline(const std::string& name, std::chrono::milliseconds deadline);
+
+    // Hot path: one relaxed store unless the channel is stalled or not timed yet (just resumed).
+    void beat(int id);
+    // The thread behind a heartbeat returned; reported immediately.
+    void exited(int id);
+    // The source behind a heartbeat is gone while its thread keeps retrying; reported
+    // immediately, recovered by the next beat().
+    void lost(int id);
+
+    // Brackets one blocking call on a deadline channel.
+    class Call {
+    public:
+        Call(Watchdog& watchdog, int id);
+        ~Call();
+        Call(const Call&) = delete;
+        Call& operator=(const Call&) = delete;
+
+    private:
+        Watchdog& watchdog_;
+        int id_;
+        int64_t startNs_;
+    };
+
+    // Checks at every deadline until stop(). Intended to be run in a dedicated thread.
+    void run();
+    void stop();
+
+    void appendText(std::string& out) const;
+    void appendOpenMetrics(std::string& out) const;
+
+private:
+    struct Channel {
+        std::string name;
+        Kind kind;
+        std::chrono::milliseconds expected;
+        std::function<bool()> isActive;
+
+        std::atomic<int64_t> lastBeatNs{0}; // heartbeat, written without the lock
+        std::atomic<bool> stalled{false};   // read without the lock by beat()
+        std::atomic<bool> wasActive{false}; // heartbeat timed by check(), read without the lock by beat()
+
+        // Watchdog mutex_
+        int inFlight = 0;         // deadline
+        int64_t callStartNs = 0;  // deadline: start of the oldest call in flight
+        bool exited = false;      // heartbeat
+        bool lost = false;        // heartbeat, until the next beat
+        int64_t activeSinceNs = 0;
+        int64_t stallStartNs = 0;
+        uint64_t stalls = 0;
+        int64_t stalledNsTotal = 0;
+        int64_t longestStallNs = 0;
+    };
+
+    static int64_t nowNs();
+    // Returns the time (ns) of the next deadline, INT64_MAX when nothing is timed.
+    int64_t check();
+    // Caller holds mutex_; the alert is queued and delivered without the lock.
+    void enterStall(Channel& channel, int64_t sinceNs, int64_t now, std::vector<Alert>& alerts);
+    void leaveStall(Channel& channel, int64_t now, std::vector<Alert>& alerts);
+    void deliver(const std::vector<Alert>& alerts);
+    void endCall(int id, int64_t startNs);
+
+    static constexpr int kStallFactor = 3;
+
+    std::deque<Channel> channels_; // deque: stable addresses for the atomics
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool shouldExit_ = false;
+    bool replan_ = false; // a call started or a paused heartbeat beat: recompute the next deadline
+    AlertCallback alertCallback_;
+};
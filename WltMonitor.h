@@ -4,7 +4,7 @@
 #include <functional>
 #include <android/log.h>
 
-#include "HintMonitor.h"
+#include "MonitorPipeline.h"
 
 // Logging macros for wltMonitor
 #define WLT_MONITOR_LOG_TAG "SocDaemon_wltMonitor"
@@ -12,24 +12,22 @@
 #define WLTLOGI(...) __android_log_print(ANDROID_LOG_INFO, WLT_MONITOR_LOG_TAG, __VA_ARGS__)
 #define WLTLOGE(...) __android_log_print(ANDROID_LOG_ERROR, WLT_MONITOR_LOG_TAG, __VA_ARGS__)
 
+// workload_type_index notifies with sysfs_notify(); every change is reported as (previous, current).
+using WltPipeline = pipeline::Monitor<pipeline::SysfsPollSource, pipeline::IntParser, pipeline::NoFilter,
+                                      pipeline::ChangeDetector, pipeline::AlertSink>;
+
 /**
  * @brief Monitor WLT (workload Type) hints by reading sysfs files.
  */
-class WltMonitor : public HintMonitor {
+class WltMonitor : public WltPipeline {
 public:
     WltMonitor(const std::string& name, const std::string& sysfsPath, int pollTimeoutMs, int notificationDelay = -1);
 
-    virtual ~WltMonitor() = default;
-
-    bool readValueOnce(std::string& value_out);
-    bool readValue(int fd, std::string& value_out);
+    ~WltMonitor() override = default;
 
-    void monitorLoop() override;
-    int init();
+    // Enables workload hints (and the notification delay), then opens the attribute.
+    int init() override;
 
 private:
-    std::string sysfs_path_;
-    int poll_timeout_ms_;
     int notificationDelay_ = -1;
-    static constexpr size_t kSysfsReadBufferSize = 16;
 };
@@ -0,0 +1,209 @@
+// -----------------------------------------------------------------------------
+// WltPredictor.cpp
+//
+// Online WLT transition/dwell model. See WltPredictor.h.
+// -----------------------------------------------------------------------------
+
+#include "WltPredictor.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+constexpr int64_t kDwellBoundsMs[] = {1000, 2000, 5000, 10000, 20000, 30000, 60000, 120000, 300000, 600000, INT64_MAX};
+constexpr const char* kWltNames[] = {"Idle", "Btl", "Sustain", "Bursty"};
+
+bool readSmallFile(const std::string& path, char* buf, size_t size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t len = read(fd, buf, size - 1);
+    close(fd);
+    if (len <= 0) return false;
+    buf[len] = '\0';
+    return true;
+}
+} // namespace
+
+void WltPredictor::Dwell::add(int64_t ms) {
+    for (auto& w : weight) w *= kDecay;
+    samples = samples * kDecay + 1.0;
+    size_t i = 0;
+    while (i + 1 < kBuckets && ms > kDwellBoundsMs[i]) ++i;
+    weight[i] += 1.0;
+}
+
+double WltPredictor::Dwell::survival(int64_t fromMs, int64_t extraMs) const {
+    // Conservative: a bucket only counts as surviving past x if its lower bound is >= x.
+    double alive = 0.0, beyond = 0.0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        int64_t lower = i == 0 ? 0 : kDwellBoundsMs[i - 1];
+        if (kDwellBoundsMs[i] > fromMs) alive += weight[i];
+        if (lower >= fromMs + extraMs) beyond += weight[i];
+    }
+    return alive > 0.0 ? beyond / alive : 0.0;
+}
+
+int64_t WltPredictor::Dwell::quantileMs(double q) const {
+    double total = 0.0;
+    for (double w : weight) total += w;
+    if (total <= 0.0) return INT64_MAX;
+    double cumulative = 0.0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        cumulative += weight[i];
+        if (cumulative >= q * total) return kDwellBoundsMs[i];
+    }
+    return INT64_MAX;
+}
+
+double WltPredictor::Dwell::meanMs() const {
+    double total = 0.0, sum = 0.0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        // Bucket midpoint; the open-ended bucket is counted at its lower bound.
+        double lower = i == 0 ? 0.0 : static_cast<double>(kDwellBoundsMs[i - 1]);
+        double mid = (i + 1 < kBuckets) ? (lower + kDwellBoundsMs[i]) / 2.0 : lower;
+        total += weight[i];
+        sum += weight[i] * mid;
+    }
+    return total > 0.0 ? sum / total : 0.0;
+}
+
+WltPredictor::WltPredictor() {
+    // Mains/USB supplies decide the AC context; batteries are ignored.
+    DIR* dir = opendir("/sys/class/power_supply");
+    if (dir) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') continue;
+            std::string base = std::string("/sys/class/power_supply/") + entry->d_name;
+            char type[32];
+            if (!readSmallFile(base + "/type", type, sizeof(type))) continue;
+            if (!strncmp(type, "Mains", 5) || !strncmp(type, "USB", 3)) {
+                acOnlinePaths_.push_back(base + "/online");
+            }
+        }
+        closedir(dir);
+    }
+    PREDLOGI("WltPredictor: %zu AC supply node(s) used for context", acOnlinePaths_.size());
+}
+
+int64_t WltPredictor::nowMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+int WltPredictor::currentContext() const {
+    bool ac = false;
+    char buf[8];
+    for (const auto& path : acOnlinePaths_) {
+        if (readSmallFile(path, buf, sizeof(buf)) && buf[0] == '1') {
+            ac = true;
+            break;
+        }
+    }
+    time_t now = time(nullptr);
+    struct tm local = {};
+    localtime_r(&now, &local);
+    return (ac ? 4 : 0) + local.tm_hour / 6;
+}
+
+const WltPredictor::Model& WltPredictor::modelFor(int context, int episode) const {
+    if (models_[context].episode[episode].samples >= kMinSamples) return models_[context];
+    return models_[kGlobal];
+}
+
+void WltPredictor::observe(int wlt) {
+    if (wlt < 0 || wlt >= kStates) return;
+    int context = currentContext();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (wlt == current_) return;
+    int64_t now = nowMs();
+
+    if (current_ >= 0) {
+        for (Model* model : {&models_[context_], &models_[kGlobal]}) {
+            for (auto& row : model->transitions) {
+                for (double& count : row) count *= kDecay;
+            }
+            model->transitions[current_][wlt] += 1.0;
+            model->state[current_].add(now - stateStartMs_);
+            if (isLow(current_) != isLow(wlt)) {
+                model->episode[isLow(current_) ? kLow : kHigh].add(now - episodeStartMs_);
+            }
+        }
+    }
+
+    if (current_ < 0 || isLow(current_) != isLow(wlt)) {
+        episodeStartMs_ = now;
+    }
+    current_ = wlt;
+    stateStartMs_ = now;
+    context_ = context;
+}
+
+std::chrono::milliseconds WltPredictor::entryDebounce(std::chrono::milliseconds base) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_ < 0 || !isLow(current_)) return base;
+
+    const Dwell& dwell = modelFor(context_, kLow).episode[kLow];
+    if (dwell.samples < kMinSamples) return base;
+
+    int64_t elapsed = nowMs() - episodeStartMs_;
+    double pLong = dwell.survival(elapsed, base.count());
+    if (pLong < kEntryConfidence) return base;
+
+    auto shortened = std::max(kMinEntryDebounce, base / 4);
+    PREDLOGI("WltPredictor: P(low episode > %lldms)=%.2f, entry debounce %lldms -> %lldms",
+             static_cast<long long>(base.count()), pLong, static_cast<long long>(base.count()),
+             static_cast<long long>(shortened.count()));
+    return std::min(base, shortened);
+}
+
+std::chrono::milliseconds WltPredictor::exitDebounce(std::chrono::milliseconds base) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_ < 0 || isLow(current_)) return base;
+
+    const Dwell& dwell = modelFor(context_, kHigh).episode[kHigh];
+    if (dwell.samples < kMinSamples) return base;
+
+    // Typical blip length; only hold off when most high episodes end within kMaxExitHold.
+    int64_t blipMs = dwell.quantileMs(kBlipConfidence);
+    if (blipMs > kMaxExitHold.count() || blipMs <= base.count()) return base;
+
+    PREDLOGI("WltPredictor: %.0f%% of high episodes end within %lldms, exit debounce %lldms -> %lldms",
+             kBlipConfidence * 100, static_cast<long long>(blipMs), static_cast<long long>(base.count()),
+             static_cast<long long>(blipMs));
+    return std::chrono::milliseconds(blipMs);
+}
+
+void WltPredictor::appendText(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buf[256];
+    snprintf(buf, sizeof(buf), "context=%d ac=%d tod_bucket=%d current=%s\n", context_, context_ / 4, context_ % 4,
+             current_ >= 0 ? kWltNames[current_] : "unknown");
+    out += buf;
+
+    for (int context : {context_, kGlobal}) {
+        const Model& model = models_[context];
+        const char* label = context == kGlobal ? "global" : "context";
+        for (int from = 0; from < kStates; ++from) {
+            double total = 0.0;
+            for (double count : model.transitions[from]) total += count;
+            snprintf(buf, sizeof(buf), "%s.%s p_next=", label, kWltNames[from]);
+            out += buf;
+            for (int to = 0; to < kStates; ++to) {
+                snprintf(buf, sizeof(buf), "%s%.2f", to ? "," : "", total > 0.0 ? model.transitions[from][to] / total : 0.0);
+                out += buf;
+            }
+            snprintf(buf, sizeof(buf), " mean_dwell_ms=%.0f samples=%.1f\n", model.state[from].meanMs(),
+                     model.state[from].samples);
+            out += buf;
+        }
+        snprintf(buf, sizeof(buf), "%s.low_episode mean_ms=%.0f samples=%.1f\n%s.high_episode mean_ms=%.0f samples=%.1f\n",
+                 label, model.episode[kLow].meanMs(), model.episode[kLow].samples, label,
+                 model.episode[kHigh].meanMs(), model.episode[kHigh].samples);
+        out += buf;
+    }
+}
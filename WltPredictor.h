@@ -0,0 +1,92 @@
+#pragma once
+
+// WltPredictor.h
+// -----------------------------------------------------------------------------
+// Online Markov model of workload_type_index. For every context (AC/battery x
+// quarter of the day) it learns:
+//   - the state transition matrix P(next | current) over Idle/Btl/Sustain/Bursty
+//   - the dwell-time distribution of each state and of low-load (Idle/Btl) and
+//     high-load (Sustain/Bursty) episodes.
+// Counts decay geometrically so the model follows the current session. A
+// context with too little history falls back to the context-free model.
+//
+// SocDaemon asks it for the entry debounce (shortened when the current Idle/Btl
+// episode is very likely to last longer than the default debounce) and for the
+// exit debounce (extended when a Sustain/Bursty episode in CC is likely a short
+// blip).
+// -----------------------------------------------------------------------------
+
+#include <android/log.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define PRED_LOG_TAG "SocDaemon_WltPredictor"
+#define PREDLOGI(...) __android_log_print(ANDROID_LOG_INFO, PRED_LOG_TAG, __VA_ARGS__)
+#define PREDLOGD(...) __android_log_print(ANDROID_LOG_DEBUG, PRED_LOG_TAG, __VA_ARGS__)
+
+class WltPredictor {
+public:
+    WltPredictor();
+
+    // Record a new WLT state (0..3); closes the dwell of the previous state/episode.
+    void observe(int wlt);
+
+    // Entry debounce to use for the current Idle/Btl episode.
+    std::chrono::milliseconds entryDebounce(std::chrono::milliseconds base);
+
+    // Exit debounce to use for the current Sustain/Bursty episode while in CC.
+    std::chrono::milliseconds exitDebounce(std::chrono::milliseconds base);
+
+    // Transition matrix, expected dwell and sample counts for the control socket.
+    void appendText(std::string& out) const;
+
+private:
+    static constexpr int kStates = 4;
+    static constexpr int kContexts = 8; // (ac online) x (6h time-of-day bucket)
+    static constexpr int kGlobal = kContexts; // context-free model
+    static constexpr size_t kBuckets = 11;
+    enum Episode : int { kLow = 0, kHigh = 1 };
+
+    struct Dwell {
+        std::array<double, kBuckets> weight{}; // decayed counts per dwell bucket
+        double samples = 0.0;
+        void add(int64_t ms);
+        // P(D >= from + extra | D >= from)
+        double survival(int64_t fromMs, int64_t extraMs) const;
+        // Smallest bucket bound b with P(D <= b) >= q
+        int64_t quantileMs(double q) const;
+        double meanMs() const;
+    };
+
+    struct Model {
+        double transitions[kStates][kStates] = {};
+        Dwell state[kStates];
+        Dwell episode[2];
+    };
+
+    static int64_t nowMs();
+    static bool isLow(int wlt) { return wlt == 0 || wlt == 1; }
+    int currentContext() const;
+    // Context model if it has enough history for `episode`, else the global one. Caller holds mutex_.
+    const Model& modelFor(int context, int episode) const;
+
+    static constexpr double kDecay = 0.98;          // per observation
+    static constexpr double kMinSamples = 8.0;      // before any decision is taken
+    static constexpr double kEntryConfidence = 0.9; // P(low episode outlasts the default debounce)
+    static constexpr double kBlipConfidence = 0.8;  // P(high episode ends within the hold-off)
+    static constexpr std::chrono::milliseconds kMinEntryDebounce{2000};
+    static constexpr std::chrono::milliseconds kMaxExitHold{5000};
+
+    std::vector<std::string> acOnlinePaths_;
+    Model models_[kContexts + 1];
+
+    int current_ = -1;
+    int context_ = 0;
+    int64_t stateStartMs_ = 0;
+    int64_t episodeStartMs_ = 0;
+    mutable std::mutex mutex_;
+};
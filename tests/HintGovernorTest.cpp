@@ -0,0 +1,122 @@
+// -----------------------------------------------------------------------------
+// HintGovernorTest.cpp
+//
+// Toggle budget, minimum hold, urgent values and back-off of HintGovernor.
+// -----------------------------------------------------------------------------
+
+#include "HintGovernor.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+using Decision = HintGovernor::Decision;
+
+namespace {
+
+GovernorConfig config(unsigned maxToggles, std::chrono::milliseconds minHold) {
+    GovernorConfig c;
+    c.maxToggles = maxToggles;
+    c.window = 60s;
+    c.minHold = minHold;
+    c.flapWindow = 1ms;
+    c.maxBackoff = 120s;
+    return c;
+}
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+} // namespace
+
+TEST(HintGovernorTest, DisabledAllowsEveryToggle) {
+    HintGovernor governor("test", config(0, 60s));
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(governor.request(i % 2), Decision::Allow);
+    }
+    EXPECT_FALSE(governor.hasPending());
+}
+
+TEST(HintGovernorTest, SameValueIsUnchanged) {
+    HintGovernor governor("test", config(6, 60s));
+    EXPECT_EQ(governor.request(1), Decision::Allow);
+    EXPECT_EQ(governor.request(1), Decision::Unchanged);
+}
+
+TEST(HintGovernorTest, MinHoldDefersAndExpires) {
+    HintGovernor governor("test", config(6, 50ms));
+    EXPECT_EQ(governor.request(0), Decision::Allow); // first value is never held back
+    EXPECT_EQ(governor.request(1), Decision::Defer);
+    EXPECT_TRUE(governor.hasPending());
+    EXPECT_EQ(governor.duePending(), -1);
+
+    std::this_thread::sleep_for(80ms);
+    EXPECT_EQ(governor.duePending(), 1);
+    EXPECT_EQ(governor.request(1), Decision::Allow);
+    EXPECT_FALSE(governor.hasPending());
+}
+
+TEST(HintGovernorTest, RevertedPendingIsSuppressed) {
+    HintGovernor governor("test", config(6, 60s));
+    EXPECT_EQ(governor.request(0), Decision::Allow);
+    EXPECT_EQ(governor.request(1), Decision::Defer);
+    EXPECT_EQ(governor.request(0), Decision::Unchanged);
+    EXPECT_FALSE(governor.hasPending());
+
+    std::string text;
+    governor.appendText(text);
+    EXPECT_TRUE(contains(text, "suppressed=1")) << text;
+    EXPECT_TRUE(contains(text, "deferred_hold=1")) << text;
+}
+
+TEST(HintGovernorTest, UrgentValueIsNeverDeferred) {
+    HintGovernor governor("test", config(6, 60s), 0);
+    EXPECT_EQ(governor.request(1), Decision::Allow);
+    EXPECT_EQ(governor.request(0), Decision::Allow); // urgent despite the hold
+    EXPECT_EQ(governor.request(1), Decision::Defer);
+
+    std::string text;
+    governor.appendText(text);
+    EXPECT_TRUE(contains(text, "urgent=1")) << text;
+}
+
+TEST(HintGovernorTest, BudgetDefersOnceSpent) {
+    HintGovernor governor("test", config(2, 0ms));
+    EXPECT_EQ(governor.request(0), Decision::Allow); // sets the initial value, not a toggle
+    EXPECT_EQ(governor.request(1), Decision::Allow);
+    EXPECT_EQ(governor.request(0), Decision::Allow);
+    EXPECT_EQ(governor.request(1), Decision::Defer);
+
+    std::string text;
+    governor.appendText(text);
+    EXPECT_TRUE(contains(text, "deferred_budget=1")) << text;
+    EXPECT_TRUE(contains(text, "toggles_in_window=2")) << text;
+}
+
+TEST(HintGovernorTest, FlappingRaisesTheHold) {
+    GovernorConfig c = config(100, 10ms);
+    c.flapWindow = 60s;
+    HintGovernor governor("test", c);
+    EXPECT_EQ(governor.request(0), Decision::Allow);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(governor.request(1), Decision::Allow); // a reversal within flapWindow
+
+    std::string text;
+    governor.appendText(text);
+    EXPECT_TRUE(contains(text, "backoff_level=1")) << text;
+    EXPECT_TRUE(contains(text, "required_hold_ms=20")) << text;
+
+    // 20ms later the doubled hold is not over yet.
+    std::this_thread::sleep_for(12ms);
+    EXPECT_EQ(governor.request(0), Decision::Defer);
+}
+
+TEST(HintGovernorTest, SyncCountsNoToggle) {
+    HintGovernor governor("test", config(1, 0ms));
+    governor.sync(1);
+    EXPECT_EQ(governor.request(1), Decision::Unchanged);
+    EXPECT_EQ(governor.request(0), Decision::Allow);
+    EXPECT_EQ(governor.request(1), Decision::Defer);
+}
@@ -0,0 +1,212 @@
+// -----------------------------------------------------------------------------
+// OpenMetricsTest.cpp
+//
+// OpenMetrics text produced by Histogram, ResidencyTracker, HintGovernor,
+// Pl1Controller and RaplMonitor: every sample belongs to a family declared by a preceding
+// # TYPE line, counters end in _total, and histogram buckets are cumulative
+// and end with +Inf equal to _count.
+// -----------------------------------------------------------------------------
+
+#include "Histogram.h"
+#include "HintGovernor.h"
+#include "Pl1Controller.h"
+#include "RaplMonitor.h"
+#include "ResidencyTracker.h"
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Sample {
+    std::string name;
+    std::string labels;
+    double value = 0.0;
+};
+
+// Checks the exposition rules above; returns the samples for value checks.
+std::vector<Sample> parseAndValidate(const std::string& text) {
+    std::vector<Sample> samples;
+    std::map<std::string, std::string> types;
+    std::string family;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        EXPECT_FALSE(line.empty()) << "empty line in:\n" << text;
+        if (line.rfind("# TYPE ", 0) == 0) {
+            std::istringstream fields(line.substr(7));
+            std::string type;
+            fields >> family >> type;
+            EXPECT_TRUE(type == "gauge" || type == "counter" || type == "histogram") << line;
+            EXPECT_EQ(types.count(family), 0u) << "family declared twice: " << family;
+            types[family] = type;
+            continue;
+        }
+        if (line.rfind("# HELP ", 0) == 0) continue;
+        EXPECT_NE(line[0], '#') << line;
+
+        Sample sample;
+        size_t brace = line.find('{');
+        size_t space = line.rfind(' ');
+        EXPECT_NE(space, std::string::npos) << line;
+        if (brace != std::string::npos && brace < space) {
+            sample.name = line.substr(0, brace);
+            size_t close = line.find('}', brace);
+            EXPECT_NE(close, std::string::npos) << line;
+            sample.labels = line.substr(brace + 1, close - brace - 1);
+        } else {
+            sample.name = line.substr(0, space);
+        }
+        char* end = nullptr;
+        std::string value = line.substr(space + 1);
+        sample.value = strtod(value.c_str(), &end);
+        EXPECT_EQ(*end, '\0') << "bad value: " << line;
+
+        EXPECT_FALSE(family.empty()) << "sample before any # TYPE: " << line;
+        const std::string& type = types[family];
+        if (type == "counter") {
+            EXPECT_EQ(sample.name, family + "_total") << line;
+        } else if (type == "histogram") {
+            EXPECT_TRUE(sample.name == family + "_bucket" || sample.name == family + "_count" ||
+                        sample.name == family + "_sum")
+                    << line;
+        } else {
+            EXPECT_EQ(sample.name, family) << line;
+        }
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+// Buckets of one label set are cumulative and the +Inf bucket equals _count.
+void expectCumulative(const std::vector<Sample>& samples, const std::string& family) {
+    std::map<std::string, double> last;      // labels without le -> previous bucket
+    std::map<std::string, double> infCounts;
+    for (const Sample& s : samples) {
+        if (s.name == family + "_bucket") {
+            size_t le = s.labels.find("le=\"");
+            ASSERT_NE(le, std::string::npos) << s.labels;
+            std::string key = s.labels.substr(0, le);
+            EXPECT_GE(s.value, last[key]) << s.labels;
+            last[key] = s.value;
+            if (s.labels.find("le=\"+Inf\"") != std::string::npos) infCounts[key] = s.value;
+        } else if (s.name == family + "_count") {
+            std::string key = s.labels.empty() ? "" : s.labels + ",";
+            ASSERT_EQ(infCounts.count(key), 1u) << "no +Inf bucket for {" << s.labels << "}";
+            EXPECT_EQ(infCounts[key], s.value);
+        }
+    }
+}
+
+} // namespace
+
+TEST(OpenMetricsTest, HistogramIsCumulativeAndScaled) {
+    Histogram histogram({1000, 10, 100}); // bounds are sorted on construction
+    for (uint64_t v : {5, 10, 11, 100, 5000}) histogram.record(v);
+
+    std::string out = "# TYPE test_latency_seconds histogram\n";
+    histogram.appendOpenMetrics(out, "test_latency_seconds", "", 1e-3);
+    EXPECT_EQ(out,
+              "# TYPE test_latency_seconds histogram\n"
+              "test_latency_seconds_bucket{le=\"0.01\"} 2\n"
+              "test_latency_seconds_bucket{le=\"0.1\"} 4\n"
+              "test_latency_seconds_bucket{le=\"1\"} 4\n"
+              "test_latency_seconds_bucket{le=\"+Inf\"} 5\n"
+              "test_latency_seconds_count 5\n"
+              "test_latency_seconds_sum 5.126\n");
+    expectCumulative(parseAndValidate(out), "test_latency_seconds");
+}
+
+TEST(OpenMetricsTest, HistogramLabelsAndText) {
+    Histogram histogram({10});
+    histogram.record(3);
+    histogram.record(30);
+
+    std::string out = "# TYPE h histogram\n";
+    histogram.appendOpenMetrics(out, "h", "var=\"x\"", 1.0);
+    EXPECT_NE(out.find("h_bucket{var=\"x\",le=\"10\"} 1\n"), std::string::npos) << out;
+    EXPECT_NE(out.find("h_count{var=\"x\"} 2\n"), std::string::npos) << out;
+    expectCumulative(parseAndValidate(out), "h");
+
+    std::string text;
+    histogram.appendText(text, "h");
+    EXPECT_EQ(text, "h 10:1 inf:1 count=2 sum=33\n");
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+}
+
+TEST(OpenMetricsTest, ResidencyFamilies) {
+    ResidencyTracker cc("cc_state", {"Open", "CoreContainment"});
+    ResidencyTracker gfx("gfx_mode", {"0", "1"});
+    cc.transition(0);
+    cc.transition(1);
+    cc.transition(0);
+    gfx.transition(1);
+
+    std::string out;
+    ResidencyTracker::appendOpenMetrics(out, {&cc, &gfx});
+    std::vector<Sample> samples = parseAndValidate(out);
+    expectCumulative(samples, "socdaemon_state_dwell_seconds");
+
+    std::map<std::string, double> entries;
+    for (const Sample& s : samples) {
+        if (s.name == "socdaemon_state_entries_total") entries[s.labels] = s.value;
+    }
+    EXPECT_EQ(entries["var=\"cc_state\",state=\"Open\""], 2);
+    EXPECT_EQ(entries["var=\"cc_state\",state=\"CoreContainment\""], 1);
+    EXPECT_EQ(entries["var=\"gfx_mode\",state=\"1\""], 1);
+    EXPECT_EQ(entries["var=\"gfx_mode\",state=\"0\""], 0);
+}
+
+TEST(OpenMetricsTest, GovernorCounters) {
+    GovernorConfig config;
+    config.maxToggles = 6;
+    HintGovernor governor("efficient_power", config);
+    governor.request(0);
+    governor.request(1); // deferred by the minimum hold
+
+    std::string out = "# TYPE socdaemon_governor_toggles counter\n";
+    governor.appendOpenMetrics(out);
+    std::vector<Sample> samples = parseAndValidate(out);
+    ASSERT_EQ(samples.size(), 5u);
+    std::map<std::string, double> outcomes;
+    for (const Sample& s : samples) outcomes[s.labels] = s.value;
+    EXPECT_EQ(outcomes["type=\"efficient_power\",outcome=\"allowed\""], 1);
+    EXPECT_EQ(outcomes["type=\"efficient_power\",outcome=\"deferred_hold\""], 1);
+    EXPECT_EQ(outcomes["type=\"efficient_power\",outcome=\"urgent\""], 0);
+}
+
+TEST(OpenMetricsTest, Pl1Families) {
+    Pl1Config config;
+    config.node = "/nonexistent/constraint_0_power_limit_uw";
+    Pl1Controller controller(config);
+    std::string out;
+    controller.appendOpenMetrics(out);
+    parseAndValidate(out);
+}
+
+TEST(OpenMetricsTest, RaplFamiliesEndEachLine) {
+    RaplMonitor rapl("RaplMonitor"); // no domains before init(): only the power and savings gauges
+    Pl1Config config;
+    config.node = "/nonexistent/constraint_0_power_limit_uw";
+    Pl1Controller controller(config);
+
+    // formatMetrics appends the PL1 families right after these; nothing may be cut or glued.
+    std::string out;
+    rapl.appendOpenMetrics(out);
+    ASSERT_FALSE(out.empty());
+    EXPECT_EQ(out.back(), '\n');
+    controller.appendOpenMetrics(out);
+
+    std::map<std::string, double> values;
+    for (const Sample& s : parseAndValidate(out)) values[s.name] = s.value;
+    ASSERT_EQ(values.count("socdaemon_package_power_watts"), 1u) << out;
+    ASSERT_EQ(values.count("socdaemon_containment_saved_joules"), 1u) << out;
+    EXPECT_EQ(values["socdaemon_containment_saved_joules"], 0.0);
+    EXPECT_EQ(values.count("socdaemon_pl1_limit_watts"), 1u) << out;
+}
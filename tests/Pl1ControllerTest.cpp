@@ -0,0 +1,181 @@
+// -----------------------------------------------------------------------------
+// Pl1ControllerTest.cpp
+//
+// Range parsing, PI steps, slew limit, thermal ceiling and node writes of
+// Pl1Controller, against a temporary file standing in for the powercap node.
+// -----------------------------------------------------------------------------
+
+#include "Pl1Controller.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+class Pl1ControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "pl1_limit_XXXXXX";
+        int fd = mkstemp(path_.data());
+        ASSERT_GE(fd, 0);
+        close(fd);
+        config_.node = path_;
+        config_.minW = 15.0;
+        config_.maxW = 25.0;
+        config_.targetBusyPercent = 85.0;
+        config_.kp = 0.0;
+        config_.ki = 0.1;
+        config_.maxSlewWPerS = 1.0;
+    }
+
+    void TearDown() override { unlink(path_.c_str()); }
+
+    long long nodeMicroWatts() const {
+        std::ifstream in(path_);
+        long long value = -1;
+        in >> value;
+        return value;
+    }
+
+    // A GPU pinned at 100% busy and held back by the power limit.
+    static Pl1Controller::Inputs starved() {
+        Pl1Controller::Inputs in;
+        in.gpuActive = true;
+        in.gpuBusyPercent = 100.0;
+        in.gpuPowerLimited = true;
+        return in;
+    }
+
+    std::string path_;
+    Pl1Config config_;
+};
+
+} // namespace
+
+TEST(Pl1ConfigTest, ParseRange) {
+    Pl1Config config;
+    EXPECT_TRUE(Pl1Config::parseRange("12,28", config));
+    EXPECT_DOUBLE_EQ(config.minW, 12.0);
+    EXPECT_DOUBLE_EQ(config.maxW, 28.0);
+    EXPECT_DOUBLE_EQ(config.targetBusyPercent, 85.0);
+
+    EXPECT_TRUE(Pl1Config::parseRange("10.5,20,90", config));
+    EXPECT_DOUBLE_EQ(config.minW, 10.5);
+    EXPECT_DOUBLE_EQ(config.targetBusyPercent, 90.0);
+
+    EXPECT_FALSE(Pl1Config::parseRange("20", config));
+    EXPECT_FALSE(Pl1Config::parseRange("20,10", config));      // min >= max
+    EXPECT_FALSE(Pl1Config::parseRange("0,10", config));       // min must be positive
+    EXPECT_FALSE(Pl1Config::parseRange("10,20,101", config));  // target above 100
+    EXPECT_FALSE(Pl1Config::parseRange("10,20,90,1", config)); // too many fields
+    EXPECT_FALSE(Pl1Config::parseRange("10,20x", config));
+    EXPECT_DOUBLE_EQ(config.minW, 10.5); // unchanged by rejected input
+}
+
+TEST_F(Pl1ControllerTest, InitWritesTheFloor) {
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    EXPECT_EQ(nodeMicroWatts(), 15000000);
+    EXPECT_FALSE(controller.isAboveFloor());
+}
+
+TEST_F(Pl1ControllerTest, InitFailsWithoutNode) {
+    config_.node = path_ + ".missing/limit";
+    Pl1Controller controller(config_);
+    EXPECT_EQ(controller.init(), -1);
+}
+
+TEST_F(Pl1ControllerTest, RaisesOnlyWhenPowerLimited) {
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+
+    // Busy, but neither throttled nor near the limit: more PL1 would not be used.
+    Pl1Controller::Inputs notBound = starved();
+    notBound.gpuPowerLimited = false;
+    notBound.packageW = 5.0;
+    controller.update(notBound);
+    EXPECT_DOUBLE_EQ(controller.limitW(), 15.0);
+
+    // Power limited: the first step (dt = 1s) is bounded by the slew rate.
+    controller.update(starved());
+    EXPECT_GT(controller.limitW(), 15.0);
+    EXPECT_LE(controller.limitW(), 16.0);
+    EXPECT_TRUE(controller.isAboveFloor());
+}
+
+TEST_F(Pl1ControllerTest, ThermallyLimitedGpuGetsNoMoreBudget) {
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    Pl1Controller::Inputs in = starved();
+    in.gpuThermalLimited = true;
+    controller.update(in);
+    EXPECT_DOUBLE_EQ(controller.limitW(), 15.0);
+}
+
+TEST_F(Pl1ControllerTest, ThermalCeilingCutsImmediately) {
+    config_.ki = 100.0; // saturate every step at the slew limit
+    config_.maxSlewWPerS = 100.0;
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    controller.update(starved());
+    EXPECT_DOUBLE_EQ(controller.limitW(), 25.0);
+    EXPECT_EQ(nodeMicroWatts(), 25000000);
+
+    // Half the thermal band left: the ceiling is halfway between min and max.
+    Pl1Controller::Inputs in = starved();
+    in.headroomMC = config_.thermalBandMC / 2;
+    controller.update(in);
+    EXPECT_DOUBLE_EQ(controller.limitW(), 20.0);
+    EXPECT_EQ(nodeMicroWatts(), 20000000);
+
+    in.tripCrossed = true;
+    controller.update(in);
+    EXPECT_DOUBLE_EQ(controller.limitW(), 15.0);
+}
+
+TEST_F(Pl1ControllerTest, SlewsBackToTheFloorWhenIdle) {
+    config_.ki = 100.0;
+    config_.maxSlewWPerS = 100.0;
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    controller.update(starved());
+    ASSERT_DOUBLE_EQ(controller.limitW(), 25.0);
+
+    Pl1Controller::Inputs idle;
+    std::this_thread::sleep_for(20ms);
+    controller.update(idle); // ~20ms at 100 W/s: a ~2 W step down, not a jump
+    EXPECT_LT(controller.limitW(), 25.0);
+    EXPECT_GT(controller.limitW(), 15.0);
+}
+
+TEST_F(Pl1ControllerTest, ApplyFalseHoldsTheNodeAtTheFloor) {
+    config_.ki = 100.0;
+    config_.maxSlewWPerS = 100.0;
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    Pl1Controller::Inputs in = starved();
+    in.apply = false;
+    controller.update(in);
+    EXPECT_DOUBLE_EQ(controller.limitW(), 25.0); // still computed
+    EXPECT_EQ(nodeMicroWatts(), 15000000);
+}
+
+TEST_F(Pl1ControllerTest, WritesAreQuantized) {
+    config_.ki = 0.001; // 15 % error * 0.001 * 1s = 0.015 W, below the write quantum
+    Pl1Controller controller(config_);
+    ASSERT_EQ(controller.init(), 0);
+    controller.update(starved());
+    EXPECT_GT(controller.limitW(), 15.0);
+    EXPECT_EQ(nodeMicroWatts(), 15000000);
+
+    std::string text;
+    controller.appendText(text);
+    EXPECT_NE(text.find("writes=1\n"), std::string::npos) << text; // only the init() write
+}
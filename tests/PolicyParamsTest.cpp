@@ -0,0 +1,171 @@
+// -----------------------------------------------------------------------------
+// PolicyParamsTest.cpp
+//
+// Parsing and validation of policy files, and PolicyRegistry reloads: a
+// rejected file keeps the current set, a deleted one restores the defaults.
+// -----------------------------------------------------------------------------
+
+#include "PolicyParams.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <fstream>
+#include <memory>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Every field of `a` and `b` matches (the registry-set version aside).
+void expectSameSet(const PolicyParams& a, const PolicyParams& b) {
+    std::string textA, textB;
+    a.appendText(textA);
+    b.appendText(textB);
+    EXPECT_EQ(textA, textB);
+}
+
+} // namespace
+
+TEST(PolicyParamsTest, DefaultsAreValid) {
+    std::string error;
+    EXPECT_TRUE(PolicyParams().validate(error)) << error;
+}
+
+TEST(PolicyParamsTest, ParsesOverTheCurrentSet) {
+    PolicyParams params;
+    params.sysloadEntryThreshold = 30.0; // e.g. from the command line
+    std::string error;
+    ASSERT_TRUE(params.parse("# tuned for the lab\n"
+                             "  send_hint = true  \n"
+                             "\n"
+                             "cc_entry_debounce_ms=4000 # shorter\n"
+                             "sysload_high_threshold=40.5\r\n"
+                             "gpu_high_load_percent=0\n",
+                             error))
+            << error;
+    EXPECT_TRUE(params.sendHint);
+    EXPECT_EQ(params.ccEntryDebounce, 4000ms);
+    EXPECT_DOUBLE_EQ(params.sysloadHighThreshold, 40.5);
+    EXPECT_EQ(params.gpuHighLoadPercent, 0);
+    EXPECT_DOUBLE_EQ(params.sysloadEntryThreshold, 30.0); // not in the file: kept
+}
+
+TEST(PolicyParamsTest, UnknownKeyRejectsTheWholeFile) {
+    PolicyParams params;
+    const PolicyParams before = params;
+    std::string error;
+    EXPECT_FALSE(params.parse("send_hint=true\ncc_entry_debounce_ms=4000\nsysload_treshold=10\n", error));
+    EXPECT_NE(error.find("line 3"), std::string::npos) << error;
+    EXPECT_NE(error.find("unknown key 'sysload_treshold'"), std::string::npos) << error;
+    expectSameSet(params, before); // the valid lines before it were not applied either
+}
+
+TEST(PolicyParamsTest, MalformedLinesAndValuesAreRejected) {
+    PolicyParams params;
+    const PolicyParams before = params;
+    std::string error;
+    EXPECT_FALSE(params.parse("send_hint\n", error));
+    EXPECT_NE(error.find("expected key=value"), std::string::npos) << error;
+    EXPECT_FALSE(params.parse("send_hint=yes\n", error));
+    EXPECT_NE(error.find("invalid value for send_hint"), std::string::npos) << error;
+    EXPECT_FALSE(params.parse("cc_exit_debounce_ms=10s\n", error));
+    EXPECT_FALSE(params.parse("sysload_entry_threshold=\n", error));
+    expectSameSet(params, before);
+}
+
+TEST(PolicyParamsTest, OutOfRangeValuesAreRejected) {
+    PolicyParams params;
+    const PolicyParams before = params;
+    std::string error;
+    EXPECT_FALSE(params.parse("cc_entry_debounce_ms=0\n", error));
+    EXPECT_FALSE(params.parse("cc_exit_recheck_ms=600001\n", error));
+    EXPECT_FALSE(params.parse("sysload_slope_threshold=0\n", error));
+    EXPECT_FALSE(params.parse("sysload_entry_threshold=100.5\n", error));
+    EXPECT_FALSE(params.parse("sysload_high_min_ms=-1\n", error));
+    EXPECT_FALSE(params.parse("gpu_high_load_percent=101\n", error));
+    expectSameSet(params, before);
+
+    ASSERT_TRUE(params.parse("sysload_high_min_ms=0\ncc_exit_recheck_ms=600000\n", error)) << error;
+    EXPECT_EQ(params.sysloadHighMinAbove, 0ms);
+}
+
+TEST(PolicyParamsTest, FallAboveHighIsRejected) {
+    PolicyParams params; // high 25, fall 20
+    std::string error;
+    EXPECT_FALSE(params.parse("sysload_fall_threshold=30\n", error));
+    EXPECT_NE(error.find("sysload_fall_threshold must not exceed"), std::string::npos) << error;
+    EXPECT_FALSE(params.parse("sysload_high_threshold=15\n", error)); // below the current fall
+
+    // Checked on the complete set, so both may move in one file.
+    ASSERT_TRUE(params.parse("sysload_fall_threshold=30\nsysload_high_threshold=35\n", error)) << error;
+    EXPECT_DOUBLE_EQ(params.sysloadFallThreshold, 30.0);
+    ASSERT_TRUE(params.parse("sysload_fall_threshold=35\n", error)) << error; // equal is allowed
+}
+
+namespace {
+
+class PolicyRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "socdaemon_policy_" + std::to_string(getpid()) + ".conf";
+        unlink(path_.c_str());
+        defaults_.sysloadEntryThreshold = 30.0;
+    }
+
+    void TearDown() override { unlink(path_.c_str()); }
+
+    void writeFile(const std::string& text) const { std::ofstream(path_) << text; }
+
+    std::string path_;
+    PolicyParams defaults_;
+};
+
+} // namespace
+
+TEST_F(PolicyRegistryTest, RejectedFileKeepsTheCurrentSet) {
+    PolicyRegistry registry(defaults_, path_);
+    int published = 0;
+    registry.setListener([&](const PolicyParams&) { ++published; });
+
+    writeFile("cc_entry_debounce_ms=4000\n");
+    std::string error;
+    ASSERT_TRUE(registry.reload(error)) << error;
+    std::shared_ptr<const PolicyParams> good = registry.current();
+    EXPECT_EQ(good->ccEntryDebounce, 4000ms);
+    EXPECT_DOUBLE_EQ(good->sysloadEntryThreshold, 30.0); // parsed over the defaults
+    EXPECT_EQ(published, 1);
+
+    writeFile("cc_entry_debounce_ms=2000\nsysload_fall_threshold=90\n");
+    EXPECT_FALSE(registry.reload(error));
+    EXPECT_EQ(registry.current(), good); // same snapshot, nothing published
+    EXPECT_EQ(published, 1);
+
+    std::string text;
+    registry.appendText(text);
+    EXPECT_NE(text.find("last_error=" + error + "\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("cc_entry_debounce_ms=4000\n"), std::string::npos) << text;
+}
+
+TEST_F(PolicyRegistryTest, DeletedFileRestoresTheDefaults) {
+    PolicyRegistry registry(defaults_, path_);
+    unsigned first = registry.current()->version;
+
+    writeFile("send_hint=true\n");
+    std::string error;
+    ASSERT_TRUE(registry.reload(error)) << error;
+    EXPECT_TRUE(registry.current()->sendHint);
+
+    unlink(path_.c_str());
+    ASSERT_TRUE(registry.reload(error)) << error;
+    expectSameSet(*registry.current(), defaults_);
+    EXPECT_GT(registry.current()->version, first + 1);
+}
+
+TEST(PolicyRegistryNoFileTest, DefaultsAreFixedWithoutAPath) {
+    PolicyRegistry registry(PolicyParams(), "");
+    std::string error;
+    EXPECT_FALSE(registry.reload(error));
+    EXPECT_EQ(registry.init(), -1);
+    EXPECT_EQ(registry.current()->version, 1u);
+}
@@ -0,0 +1,66 @@
+// -----------------------------------------------------------------------------
+// SchedDelayMonitorTest.cpp
+//
+// Parsing of per-task schedstat and /proc/schedstat by SchedDelayMonitor.
+// -----------------------------------------------------------------------------
+
+#include "SchedDelayMonitor.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(SchedDelayMonitorTest, ParsesTaskSchedstat) {
+    unsigned long long waitNs = 0, slices = 0;
+    ASSERT_TRUE(SchedDelayMonitor::parseSchedstat("123456789 2500000 42\n", waitNs, slices));
+    EXPECT_EQ(waitNs, 2500000u);
+    EXPECT_EQ(slices, 42u);
+
+    ASSERT_TRUE(SchedDelayMonitor::parseSchedstat("18446744073709551615 0 1", waitNs, slices));
+    EXPECT_EQ(waitNs, 0u);
+    EXPECT_EQ(slices, 1u);
+}
+
+TEST(SchedDelayMonitorTest, RejectsShortTaskSchedstat) {
+    unsigned long long waitNs = 0, slices = 0;
+    EXPECT_FALSE(SchedDelayMonitor::parseSchedstat("", waitNs, slices));
+    EXPECT_FALSE(SchedDelayMonitor::parseSchedstat("123 456", waitNs, slices));
+    EXPECT_FALSE(SchedDelayMonitor::parseSchedstat("abc 1 2", waitNs, slices));
+}
+
+TEST(SchedDelayMonitorTest, SumsContainedCpus) {
+    // Version 15 layout: cpuN lines with 9 fields, each followed by its domain lines.
+    const char* schedstat =
+            "version 15\n"
+            "timestamp 4295123456\n"
+            "cpu0 0 0 100 10 50 20 900000 1000 10\n"
+            "domain0 00000003 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30\n"
+            "cpu1 0 0 100 10 50 20 900000 2000 20\n"
+            "cpu2 0 0 100 10 50 20 900000 4000 40\n"
+            "cpu3 0 0 100 10 50 20 900000 8000 80\n";
+    std::vector<bool> cpus = {false, true, false, true};
+    unsigned long long delayNs = 0, slices = 0;
+    ASSERT_TRUE(SchedDelayMonitor::parseCpuSchedstat(schedstat, cpus, delayNs, slices));
+    EXPECT_EQ(delayNs, 10000u);
+    EXPECT_EQ(slices, 100u);
+}
+
+TEST(SchedDelayMonitorTest, IgnoresCpusOutsideTheSet) {
+    const char* schedstat =
+            "cpu0 0 0 100 10 50 20 900000 1000 10\n"
+            "cpu7 0 0 100 10 50 20 900000 2000 20\n";
+    unsigned long long delayNs = 1, slices = 1;
+    EXPECT_FALSE(SchedDelayMonitor::parseCpuSchedstat(schedstat, {false, false}, delayNs, slices));
+    EXPECT_EQ(delayNs, 0u);
+    EXPECT_EQ(slices, 0u);
+}
+
+TEST(SchedDelayMonitorTest, SkipsTruncatedCpuLines) {
+    const char* schedstat =
+            "cpu0 0 0 100 10 50 20 900000 1000 10\n"
+            "cpu1 0 0 100 10 50 20 900000\n"; // cut before run_delay
+    std::vector<bool> cpus = {true, true};
+    unsigned long long delayNs = 0, slices = 0;
+    ASSERT_TRUE(SchedDelayMonitor::parseCpuSchedstat(schedstat, cpus, delayNs, slices));
+    EXPECT_EQ(delayNs, 1000u);
+    EXPECT_EQ(slices, 10u);
+}
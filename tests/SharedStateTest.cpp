@@ -0,0 +1,158 @@
+// -----------------------------------------------------------------------------
+// SharedStateTest.cpp
+//
+// Publish/read round trip and seqlock consistency of the
+// memory-mapped shared state, read through a separate read-only mapping as
+// another process would.
+// -----------------------------------------------------------------------------
+
+#include "SharedState.h"
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace {
+
+class SharedStateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "socdaemon_state_" + std::to_string(getpid());
+        unlink(path_.c_str());
+    }
+
+    void TearDown() override {
+        if (reader_) munmap(reader_, sizeof(SharedStateBlock));
+        unlink(path_.c_str());
+    }
+
+    const SharedStateBlock* mapReadOnly() {
+        int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        void* addr = mmap(nullptr, sizeof(SharedStateBlock), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) return nullptr;
+        reader_ = addr;
+        return static_cast<const SharedStateBlock*>(addr);
+    }
+
+    std::string path_;
+    void* reader_ = nullptr;
+};
+
+} // namespace
+
+TEST_F(SharedStateTest, DisabledWithoutPath) {
+    SharedStateWriter writer("");
+    EXPECT_EQ(writer.init(), -1);
+    EXPECT_FALSE(writer.enabled());
+    writer.publish(SharedStatePayload(), "ignored"); // no-op
+    EXPECT_EQ(writer.updates(), 0u);
+}
+
+TEST_F(SharedStateTest, PublishAndRead) {
+    SharedStateWriter writer(path_);
+    ASSERT_EQ(writer.init(), 0);
+    const SharedStateBlock* block = mapReadOnly();
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block->seq.load() % 2, 0u);
+
+    SharedStatePayload state;
+    state.ccState = 1;
+    state.efficientMode = 1;
+    state.wlt = 2;
+    state.sysCpuLoad = 12.5f;
+    writer.publish(state, "EntryDebounceTimerExpired_and_a_long_suffix");
+    writer.publish(state, nullptr);
+
+    SharedStatePayload out;
+    ASSERT_TRUE(readSharedState(block, out));
+    EXPECT_EQ(out.ccState, 1);
+    EXPECT_EQ(out.efficientMode, 1);
+    EXPECT_EQ(out.wlt, 2);
+    EXPECT_FLOAT_EQ(out.sysCpuLoad, 12.5f);
+    EXPECT_EQ(out.decisions, 1u); // only the first publish was a decision
+    EXPECT_GT(out.updatedNs, 0u);
+    EXPECT_EQ(out.decisionReason[sizeof(out.decisionReason) - 1], '\0');
+    EXPECT_EQ(std::string(out.decisionReason), std::string("EntryDebounceTimerExpired_and_a_long_suffix")
+                                                       .substr(0, sizeof(out.decisionReason) - 1));
+    EXPECT_EQ(writer.updates(), 2u);
+}
+
+TEST_F(SharedStateTest, ReaderRejectsForeignOrBusyBlocks) {
+    SharedStateBlock block{};
+    SharedStatePayload out;
+    EXPECT_FALSE(readSharedState(&block, out)); // no magic
+
+    block.magic = kSharedStateMagic;
+    block.version = kSharedStateVersion;
+    block.payloadSize = sizeof(SharedStatePayload);
+    block.seq.store(2);
+    EXPECT_TRUE(readSharedState(&block, out));
+
+    block.seq.store(3); // writer never finished
+    EXPECT_FALSE(readSharedState(&block, out, 10));
+
+    block.seq.store(4);
+    block.version = kSharedStateVersion + 1;
+    EXPECT_FALSE(readSharedState(&block, out));
+}
+
+TEST_F(SharedStateTest, RestartKeepsTheSequenceGoing) {
+    uint32_t seq = 0;
+    {
+        SharedStateWriter writer(path_);
+        ASSERT_EQ(writer.init(), 0);
+        writer.publish(SharedStatePayload(), nullptr);
+        const SharedStateBlock* block = mapReadOnly();
+        ASSERT_NE(block, nullptr);
+        seq = block->seq.load();
+    }
+    SharedStateWriter writer(path_);
+    ASSERT_EQ(writer.init(), 0);
+    EXPECT_GT(reinterpret_cast<const SharedStateBlock*>(reader_)->seq.load(), seq);
+    EXPECT_EQ(reinterpret_cast<const SharedStateBlock*>(reader_)->seq.load() % 2, 0u);
+}
+
+TEST_F(SharedStateTest, ReaderNeverSeesATornPayload) {
+    SharedStateWriter writer(path_);
+    ASSERT_EQ(writer.init(), 0);
+    const SharedStateBlock* block = mapReadOnly();
+    ASSERT_NE(block, nullptr);
+
+    // Every publish sets all fields to the same value; a torn copy would mix two.
+    auto uniform = [](int i) {
+        SharedStatePayload state;
+        state.ccState = state.efficientMode = state.gfxMode = state.wlt = state.thermalPressure = i;
+        state.sysCpuLoad = state.gpuBusyPercent = state.fusionScore = static_cast<float>(i);
+        return state;
+    };
+    writer.publish(uniform(0), nullptr);
+
+    std::atomic<bool> done{false};
+    std::thread publisher([&] {
+        for (int i = 1; i <= 200000; ++i) writer.publish(uniform(i), nullptr);
+        done = true;
+    });
+
+    int reads = 0;
+    int torn = 0;
+    while (!done.load()) {
+        SharedStatePayload out;
+        if (!readSharedState(block, out)) continue;
+        ++reads;
+        int32_t v = out.ccState;
+        float f = static_cast<float>(v);
+        if (out.efficientMode != v || out.gfxMode != v || out.wlt != v || out.thermalPressure != v ||
+            out.sysCpuLoad != f || out.gpuBusyPercent != f || out.fusionScore != f) {
+            ++torn;
+        }
+    }
+    publisher.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_GT(reads, 0);
+}
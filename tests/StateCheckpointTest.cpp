@@ -0,0 +1,142 @@
+// -----------------------------------------------------------------------------
+// StateCheckpointTest.cpp
+//
+// Round trip and validation (version, boot id, age) of StateCheckpoint.
+// -----------------------------------------------------------------------------
+
+#include "StateCheckpoint.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string bootId() {
+    std::ifstream in("/proc/sys/kernel/random/boot_id");
+    std::string id;
+    std::getline(in, id);
+    return id;
+}
+
+long long boottimeMs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+class StateCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (bootId().empty()) GTEST_SKIP() << "no boot_id on this host";
+        path_ = ::testing::TempDir() + "socdaemon_checkpoint_" + std::to_string(getpid());
+        unlink(path_.c_str());
+    }
+
+    void TearDown() override { unlink(path_.c_str()); }
+
+    void writeFile(int version, const std::string& boot, long long savedMs) const {
+        std::ofstream out(path_);
+        out << "version=" << version << "\nboot_id=" << boot << "\nsaved_ms=" << savedMs
+            << "\ncpu_ema=12.5\ncc_state=1\nefficient_mode=1\ngfx_mode=0\nwlt=2\n";
+    }
+
+    std::string path_;
+};
+
+} // namespace
+
+TEST_F(StateCheckpointTest, DisabledWithoutPath) {
+    StateCheckpoint checkpoint("", 600s);
+    PolicyCheckpoint state;
+    EXPECT_FALSE(checkpoint.enabled());
+    EXPECT_FALSE(checkpoint.save(state));
+    EXPECT_FALSE(checkpoint.load(state));
+}
+
+TEST_F(StateCheckpointTest, MissingFileIsAColdStart) {
+    StateCheckpoint checkpoint(path_, 600s);
+    PolicyCheckpoint state;
+    EXPECT_FALSE(checkpoint.load(state));
+}
+
+TEST_F(StateCheckpointTest, RoundTrip) {
+    StateCheckpoint checkpoint(path_, 600s);
+    PolicyCheckpoint saved;
+    saved.cpuEma = 42.25;
+    saved.ccState = 1;
+    saved.efficientMode = 1;
+    saved.gfxMode = 1;
+    saved.wlt = 3;
+    ASSERT_TRUE(checkpoint.save(saved));
+    EXPECT_NE(access((path_ + ".tmp").c_str(), F_OK), 0); // renamed into place
+
+    PolicyCheckpoint loaded;
+    ASSERT_TRUE(StateCheckpoint(path_, 600s).load(loaded));
+    EXPECT_DOUBLE_EQ(loaded.cpuEma, 42.25);
+    EXPECT_EQ(loaded.ccState, 1);
+    EXPECT_EQ(loaded.efficientMode, 1);
+    EXPECT_EQ(loaded.gfxMode, 1);
+    EXPECT_EQ(loaded.wlt, 3);
+    EXPECT_GE(loaded.ageMs, 0);
+}
+
+TEST_F(StateCheckpointTest, SmallLoadDriftIsNotRewritten) {
+    StateCheckpoint checkpoint(path_, 600s);
+    PolicyCheckpoint state;
+    state.cpuEma = 10.0;
+    ASSERT_TRUE(checkpoint.save(state));
+    state.cpuEma = 12.0; // below kEmaDrift
+    ASSERT_TRUE(checkpoint.save(state));
+
+    PolicyCheckpoint loaded;
+    ASSERT_TRUE(checkpoint.load(loaded));
+    EXPECT_DOUBLE_EQ(loaded.cpuEma, 10.0);
+
+    state.ccState = 1; // a state change is always written
+    ASSERT_TRUE(checkpoint.save(state));
+    ASSERT_TRUE(checkpoint.load(loaded));
+    EXPECT_DOUBLE_EQ(loaded.cpuEma, 12.0);
+    EXPECT_EQ(loaded.ccState, 1);
+}
+
+TEST_F(StateCheckpointTest, AcceptsAValidFile) {
+    writeFile(1, bootId(), boottimeMs() - 1000);
+    PolicyCheckpoint loaded;
+    ASSERT_TRUE(StateCheckpoint(path_, 600s).load(loaded));
+    EXPECT_DOUBLE_EQ(loaded.cpuEma, 12.5);
+    EXPECT_EQ(loaded.wlt, 2);
+    EXPECT_GE(loaded.ageMs, 1000);
+}
+
+TEST_F(StateCheckpointTest, RejectsOtherVersion) {
+    writeFile(2, bootId(), boottimeMs());
+    PolicyCheckpoint loaded;
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+}
+
+TEST_F(StateCheckpointTest, RejectsOtherBoot) {
+    writeFile(1, "00000000-0000-0000-0000-000000000000", boottimeMs());
+    PolicyCheckpoint loaded;
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+
+    writeFile(1, "", boottimeMs());
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+}
+
+TEST_F(StateCheckpointTest, RejectsStaleAndFutureFiles) {
+    PolicyCheckpoint loaded;
+    writeFile(1, bootId(), boottimeMs() - 601 * 1000);
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+
+    writeFile(1, bootId(), boottimeMs() + 60 * 1000);
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+
+    std::ofstream(path_) << "version=1\nboot_id=" << bootId() << "\n"; // no saved_ms
+    EXPECT_FALSE(StateCheckpoint(path_, 600s).load(loaded));
+}
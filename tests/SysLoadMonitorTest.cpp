@@ -0,0 +1,124 @@
+// -----------------------------------------------------------------------------
+// SysLoadMonitorTest.cpp
+//
+// Hysteresis of the high-load alert (HighLoadEdge) on injected loads and times,
+// and the load baseline SysLoadMonitor takes when it is resumed.
+// -----------------------------------------------------------------------------
+
+#include "SysLoadMonitor.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Edge = HighLoadEdge::Edge;
+
+constexpr double kHigh = 25.0;
+constexpr double kFall = 20.0;
+constexpr std::chrono::milliseconds kMinAbove = 2000ms;
+
+class HighLoadEdgeTest : public ::testing::Test {
+protected:
+    // One sample `offset` after the start of the test.
+    Edge at(std::chrono::milliseconds offset, double load) {
+        return edge_.update(load, start_ + offset, kHigh, kFall, kMinAbove);
+    }
+
+    // Drives the edge high with samples from `offset` on; returns the time of the rise.
+    std::chrono::milliseconds raise(std::chrono::milliseconds offset) {
+        EXPECT_EQ(at(offset, 30.0), Edge::None);
+        EXPECT_EQ(at(offset + kMinAbove, 30.0), Edge::Rise);
+        return offset + kMinAbove;
+    }
+
+    HighLoadEdge edge_;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+};
+
+} // namespace
+
+TEST_F(HighLoadEdgeTest, RisesOnlyAfterTheMinimumTimeAbove) {
+    EXPECT_EQ(at(0ms, 30.0), Edge::None);
+    EXPECT_EQ(at(1000ms, 40.0), Edge::None);
+    EXPECT_EQ(at(1999ms, 30.0), Edge::None);
+    EXPECT_EQ(edge_.aboveFor(start_ + 1999ms), 1999ms);
+    EXPECT_EQ(at(2000ms, 30.0), Edge::Rise);
+    EXPECT_TRUE(edge_.high());
+    EXPECT_EQ(at(3000ms, 30.0), Edge::None); // once per episode
+}
+
+TEST_F(HighLoadEdgeTest, DroppingToTheThresholdRestartsTheWindow) {
+    EXPECT_EQ(at(0ms, 30.0), Edge::None);
+    EXPECT_EQ(at(1000ms, kHigh), Edge::None); // not above
+    EXPECT_EQ(edge_.aboveFor(start_ + 1000ms), 0ms);
+    EXPECT_EQ(at(2000ms, 30.0), Edge::None);
+    EXPECT_EQ(at(3000ms, 30.0), Edge::None);
+    EXPECT_EQ(at(4000ms, 30.0), Edge::Rise);
+}
+
+TEST_F(HighLoadEdgeTest, NoAlertInsideTheBand) {
+    // Below the high threshold nothing rises, however long it lasts.
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(at(i * 1000ms, 22.0), Edge::None);
+
+    std::chrono::milliseconds t = raise(10000ms);
+    // Between fall and high the alert stays up.
+    EXPECT_EQ(at(t + 1000ms, 24.0), Edge::None);
+    EXPECT_EQ(at(t + 2000ms, kFall), Edge::None);
+    EXPECT_TRUE(edge_.high());
+}
+
+TEST_F(HighLoadEdgeTest, ClearsBelowTheFallThreshold) {
+    std::chrono::milliseconds t = raise(0ms);
+    EXPECT_EQ(at(t + 1000ms, 19.9), Edge::Fall);
+    EXPECT_FALSE(edge_.high());
+    EXPECT_EQ(at(t + 2000ms, 10.0), Edge::None);
+
+    // The next episode needs the full time above again.
+    EXPECT_EQ(at(t + 3000ms, 30.0), Edge::None);
+    EXPECT_EQ(at(t + 4000ms, 30.0), Edge::None);
+    EXPECT_EQ(at(t + 5000ms, 30.0), Edge::Rise);
+}
+
+TEST_F(HighLoadEdgeTest, FallThresholdIsCappedAtHigh) {
+    EXPECT_EQ(edge_.update(30.0, start_, kHigh, 28.0, kMinAbove), Edge::None);
+    EXPECT_EQ(edge_.update(30.0, start_ + kMinAbove, kHigh, 28.0, kMinAbove), Edge::Rise);
+    // 26 is below the configured fall threshold but still above high: no fall.
+    EXPECT_EQ(edge_.update(26.0, start_ + 3000ms, kHigh, 28.0, kMinAbove), Edge::None);
+    EXPECT_EQ(edge_.update(24.0, start_ + 4000ms, kHigh, 28.0, kMinAbove), Edge::Fall);
+}
+
+TEST_F(HighLoadEdgeTest, ResetReArmsTheRise) {
+    std::chrono::milliseconds t = raise(0ms);
+    // What SysLoadMonitor does on the first sample after a pause/resume.
+    edge_.reset();
+    EXPECT_FALSE(edge_.high());
+    EXPECT_EQ(at(t + 1000ms, 30.0), Edge::None); // the old window does not count
+    EXPECT_EQ(at(t + 2000ms, 30.0), Edge::None);
+    EXPECT_EQ(at(t + 3000ms, 30.0), Edge::Rise);
+}
+
+TEST(SysLoadMonitorTest, FirstSampleAfterResumeHasALoad) {
+    if (access("/proc/stat", R_OK) != 0) GTEST_SKIP() << "no /proc/stat on this host";
+    SysLoadMonitor monitor("SysLoadMonitor");
+    monitor.pause();
+    monitor.resume(); // takes the baseline
+    EXPECT_EQ(monitor.sampleCount(), 0u);
+    EXPECT_LT(monitor.getLatestSysCpuLoad(), 0.0);
+
+    std::this_thread::sleep_for(50ms); // a few jiffies, so the interval is not empty
+    monitor.sampleOnce();
+    ASSERT_EQ(monitor.sampleCount(), 1u);
+    EXPECT_GE(monitor.getLatestSysCpuLoad(), 0.0);
+    EXPECT_LE(monitor.getLatestSysCpuLoad(), 100.0);
+
+    // A resume while running does not throw the baseline away.
+    monitor.resume();
+    std::this_thread::sleep_for(50ms);
+    monitor.sampleOnce();
+    EXPECT_EQ(monitor.sampleCount(), 2u);
+}
@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// WltPredictorTest.cpp
+//
+// Debounce decisions and learned transitions of WltPredictor. Episodes here
+// last microseconds, so they all fall in the shortest dwell bucket (<= 1s).
+// -----------------------------------------------------------------------------
+
+#include "WltPredictor.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kIdle = 0;
+constexpr int kBtl = 1;
+constexpr int kSustain = 2;
+
+// `count` short low/high episode pairs, ending in `last`.
+void alternate(WltPredictor& predictor, int count, int low, int high, int last) {
+    for (int i = 0; i < count; ++i) {
+        predictor.observe(low);
+        predictor.observe(high);
+    }
+    predictor.observe(last);
+}
+
+} // namespace
+
+TEST(WltPredictorTest, NoHistoryKeepsTheBase) {
+    WltPredictor predictor;
+    EXPECT_EQ(predictor.entryDebounce(10000ms), 10000ms); // no state yet
+    predictor.observe(kIdle);
+    EXPECT_EQ(predictor.entryDebounce(10000ms), 10000ms);
+    predictor.observe(kSustain);
+    EXPECT_EQ(predictor.exitDebounce(500ms), 500ms);
+}
+
+TEST(WltPredictorTest, DebounceOnlyAppliesToItsDirection) {
+    WltPredictor predictor;
+    alternate(predictor, 20, kIdle, kSustain, kIdle);
+    // exitDebounce is only for high episodes, entryDebounce only for low ones.
+    EXPECT_EQ(predictor.exitDebounce(500ms), 500ms);
+    predictor.observe(kSustain);
+    EXPECT_EQ(predictor.entryDebounce(10000ms), 10000ms);
+}
+
+TEST(WltPredictorTest, ShortHighEpisodesExtendTheExitDebounce) {
+    WltPredictor predictor;
+    alternate(predictor, 3, kIdle, kSustain, kSustain);
+    EXPECT_EQ(predictor.exitDebounce(500ms), 500ms); // below kMinSamples
+
+    alternate(predictor, 20, kIdle, kSustain, kSustain);
+    // Every high episode ended within the first bucket: hold off for that long.
+    EXPECT_EQ(predictor.exitDebounce(500ms), 1000ms);
+    // Never shortened.
+    EXPECT_EQ(predictor.exitDebounce(3000ms), 3000ms);
+}
+
+TEST(WltPredictorTest, ShortLowEpisodesKeepTheEntryDebounce) {
+    WltPredictor predictor;
+    alternate(predictor, 20, kIdle, kSustain, kIdle);
+    // Low episodes never outlasted the debounce, so entry is not shortened.
+    EXPECT_EQ(predictor.entryDebounce(10000ms), 10000ms);
+}
+
+TEST(WltPredictorTest, IgnoresInvalidAndRepeatedStates) {
+    WltPredictor predictor;
+    predictor.observe(-1);
+    predictor.observe(4);
+    std::string text;
+    predictor.appendText(text);
+    EXPECT_NE(text.find("current=unknown"), std::string::npos) << text;
+
+    predictor.observe(kBtl);
+    predictor.observe(kBtl);
+    text.clear();
+    predictor.appendText(text);
+    EXPECT_NE(text.find("current=Btl"), std::string::npos) << text;
+    EXPECT_NE(text.find("global.Btl p_next=0.00,0.00,0.00,0.00"), std::string::npos) << text;
+}
+
+TEST(WltPredictorTest, LearnsTransitions) {
+    WltPredictor predictor;
+    alternate(predictor, 5, kBtl, kSustain, kBtl);
+    std::string text;
+    predictor.appendText(text);
+    EXPECT_NE(text.find("global.Btl p_next=0.00,0.00,1.00,0.00"), std::string::npos) << text;
+    EXPECT_NE(text.find("global.Sustain p_next=0.00,1.00,0.00,0.00"), std::string::npos) << text;
+    EXPECT_NE(text.find("global.Idle p_next=0.00,0.00,0.00,0.00"), std::string::npos) << text;
+}